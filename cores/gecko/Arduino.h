@@ -72,6 +72,7 @@ extern "C" {
 #include "adc.h"
 #include "pwm.h"
 #include "silabs_additional.h"
+#include "silabs_framing.h"
 
 #include "overloads.h"
 
@@ -105,6 +106,50 @@ typedef enum _dac_channel_t dac_channel_t;
 void analogWrite(dac_channel_t dac_channel, int value);
 void analogWriteResolution(int resolution);
 
+/***************************************************************************//**
+ * Sets the write resolution bits for a single PWM pin
+ * Overrides the resolution set by 'analogWriteResolution(resolution)' for the pin.
+ * The setting is kept when the pin is stopped by 'analogWrite(pin, 0)'.
+ * The maximum is 16 bits - the effective resolution is limited by the
+ * timer clock divided by the PWM frequency.
+ *
+ * @param[in] pin The selected PWM pin
+ * @param[in] resolution The selected resolution in bits
+ *
+ * @return true if the resolution was set successfully, false otherwise
+ ******************************************************************************/
+bool analogWriteResolution(PinName pin, int resolution);
+bool analogWriteResolution(pin_size_t pin, int resolution);
+
+/***************************************************************************//**
+ * Sets the PWM frequency used by 'analogWrite()' on a pin
+ * Pins with the same frequency share a timer, each timer can run at a different
+ * frequency - pins on other frequencies and tones are not affected.
+ * The duty cycle of the pin is kept at the new frequency.
+ *
+ * @param[in] pin The selected PWM pin
+ * @param[in] frequency The requested PWM frequency in Hz
+ *
+ * @return true if the frequency was set successfully, false otherwise
+ ******************************************************************************/
+bool analogWriteFrequency(PinName pin, uint32_t frequency);
+bool analogWriteFrequency(pin_size_t pin, uint32_t frequency);
+
+/***************************************************************************//**
+ * Writes PWM duty cycles to multiple pins in the same PWM period
+ * The new duty cycles of pins sharing a timer (pins with the same frequency)
+ * take effect together at the start of the next period.
+ * A value of 0 keeps the PWM running on the pin with 0% duty cycle.
+ *
+ * @param[in] pins The selected PWM pins
+ * @param[in] values The duty cycle values for each pin
+ * @param[in] count The number of pins
+ *
+ * @return true if all the values were written successfully, false otherwise
+ ******************************************************************************/
+bool analogWriteBatch(const PinName* pins, const int* values, uint8_t count);
+bool analogWriteBatch(const pin_size_t* pins, const int* values, uint8_t count);
+
 /***************************************************************************//**
  * Sets the ADC read resolution bits
  *
@@ -136,6 +181,47 @@ void analogGain(analog_gain_t gain);
 void analogReadDMA(PinName pin, uint32_t *buffer, uint32_t size, void (*user_onsampling_finished_callback)());
 void analogReadDMA(pin_size_t pin, uint32_t *buffer, uint32_t size, void (*user_onsampling_finished_callback)());
 
+/***************************************************************************//**
+ * Starts monitoring an analog input in the background with the ADC window comparator
+ * Conversions are triggered by hardware, the device can stay in EM2 between them.
+ * The callback is only called (from interrupt context) when a sample leaves the
+ * [low, high] window - the monitor has to be re-armed with 'analogMonitorSetWindow()'
+ * after each call. Calling 'analogRead()' or 'analogReadDMA()' stops the monitoring.
+ *
+ * @param[in] pin The selected analog input pin
+ * @param[in] low The lower bound of the window in the current read resolution
+ * @param[in] high The upper bound of the window in the current read resolution
+ * @param[in] period_ms The time between two conversions in milliseconds
+ * @param[in] user_onwindow_exit_callback Callback that gets called with the sample
+ *            which left the window
+ *
+ * @return true if the monitoring was started, false otherwise
+ ******************************************************************************/
+bool analogMonitorStart(PinName pin, uint16_t low, uint16_t high, uint32_t period_ms, void (*user_onwindow_exit_callback)(uint16_t));
+bool analogMonitorStart(pin_size_t pin, uint16_t low, uint16_t high, uint32_t period_ms, void (*user_onwindow_exit_callback)(uint16_t));
+
+/***************************************************************************//**
+ * Sets a new window for the analog monitor and re-arms it
+ *
+ * @param[in] low The lower bound of the window in the current read resolution
+ * @param[in] high The upper bound of the window in the current read resolution
+ *
+ * @return true if the window was set, false otherwise
+ ******************************************************************************/
+bool analogMonitorSetWindow(uint16_t low, uint16_t high);
+
+/***************************************************************************//**
+ * Returns the latest sample of the analog monitor without waiting for a conversion
+ *
+ * @return the latest monitored sample in the current read resolution
+ ******************************************************************************/
+int analogMonitorRead();
+
+/***************************************************************************//**
+ * Stops the analog monitor
+ ******************************************************************************/
+void analogMonitorStop();
+
 bool get_system_init_finished();
 uint32_t get_system_reset_cause();
 void escape_hatch();
@@ -27,47 +27,118 @@
 #include "Serial.h"
 
 #include <cstdarg>
+#include <cstdlib>
+#include <cstddef>
+#include <type_traits>
 #include "em_usart.h"
+#include "em_eusart.h"
+#include "em_core.h"
+#include "em_cmu.h"
 #include "sl_iostream.h"
 
 using namespace arduino;
 
+static bool peripheral_is_usart(void* peripheral);
+static uint8_t get_peripheral_index(void* peripheral);
+static uint32_t get_peripheral_clock_freq(void* peripheral);
+static void eusart_write_config(EUSART_TypeDef* eusart, volatile uint32_t* reg, uint32_t mask, uint32_t value);
+static bool get_tx_dma_peripheral_config(void* peripheral, LDMA_PeripheralSignal_t* signal, volatile uint32_t** tx_data_register);
+
 UARTClass::UARTClass(sl_iostream_t* stream,
                      sl_iostream_uart_t* instance,
+                     void* peripheral,
+                     const uart_flow_control_pins_t* flow_control_pins,
                      void(*baud_rate_set_fn)(uint32_t baudrate),
                      void(*init_fn)(void),
                      void(*deinit_fn)(void),
                      void(*serial_event_fn)(void)) :
+  rx_buffer(rx_buffer_default),
+  rx_buffer_size(default_rx_buffer_size),
+  rx_buffer_allocated(false),
+  rx_dma_running(false),
+  rx_dma_channel(0),
+  rx_dma_wraps(0),
+  rx_read_count(0),
+  rx_read_index(0),
+  rx_overflow_count(0),
+  rx_overrun_count(0),
+  rx_framing_error_count(0),
+  rx_parity_error_count(0),
+  rx_event_threshold(1),
+  rx_event_terminator(-1),
+  rx_idle_timeout_ms(0),
+  rx_event_scan_count(0),
+  rx_terminator_end_count(0),
+  rx_last_receive_millis(0),
+  tx_buffer(tx_buffer_default),
+  tx_buffer_size(default_tx_buffer_size),
+  tx_buffer_allocated(false),
+  tx_data_register(nullptr),
+  tx_dma_available(false),
+  tx_dma_channel(0),
+  tx_head(0),
+  tx_tail(0),
+  tx_count(0),
+  tx_dma_length(0),
+  tx_in_progress(false),
+  tx_mutex(nullptr),
   serial_mutex(nullptr),
+  flow_control_set(false),
+  flow_control_enabled(false),
   initialized(false),
   baudrate(115200),
+  config(SERIAL_8N1),
   suspended(false)
 {
   this->serial_mutex = xSemaphoreCreateMutexStatic(&this->serial_mutex_buf);
   configASSERT(this->serial_mutex);
+  this->tx_mutex = xSemaphoreCreateMutexStatic(&this->tx_mutex_buf);
+  configASSERT(this->tx_mutex);
   this->baud_rate_set_fn = baud_rate_set_fn;
   this->init_fn = init_fn;
   this->deinit_fn = deinit_fn;
   this->stream_handle = stream;
   this->instance_handle = instance;
+  this->peripheral = peripheral;
+  this->flow_control_pins = flow_control_pins;
   this->serial_event_fn = serial_event_fn;
 }
 
 void UARTClass::begin(unsigned long baudrate)
+{
+  this->begin(baudrate, SERIAL_8N1);
+}
+
+void UARTClass::begin(unsigned long baudrate, uint16_t config)
 {
   if (this->initialized) {
     return;
   }
   this->init_fn();
-  this->baud_rate_set_fn(baudrate);
+  // An unsupported frame config leaves the port at 8N1 - 'getConfig()' returns the one in effect
+  if (!this->configure_frame(config)) {
+    config = SERIAL_8N1;
+  }
+  // Keep the flow control setting of the board unless the user has changed it
+  if (this->flow_control_set) {
+    this->configure_flow_control(this->flow_control_enabled);
+  }
+  this->configure_baudrate(baudrate);
+  // The iostream's own receive DMA is already stopped if the takeover fails - the port would never
+  // receive anything, so it's closed again and stays uninitialized
+  if (!this->rx_dma_start()) {
+    this->deinit_fn();
+    return;
+  }
+  this->tx_dma_start();
   this->initialized = true;
   this->baudrate = baudrate;
+  this->config = config;
 }
 
-void UARTClass::begin(unsigned long baudrate, uint16_t config)
+uint16_t UARTClass::getConfig()
 {
-  (void)config;
-  this->begin(baudrate);
+  return this->config;
 }
 
 void UARTClass::end()
@@ -75,30 +146,145 @@ void UARTClass::end()
   if (!this->initialized) {
     return;
   }
+  this->flush();
+  this->rx_dma_stop();
+  this->tx_dma_stop();
   this->deinit_fn();
   this->initialized = false;
 }
 
 int UARTClass::available(void)
 {
-  task();
-  return rx_buf.available();
+  if (!this->initialized) {
+    return 0;
+  }
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  int available = (int)this->rx_available();
+  xSemaphoreGive(this->serial_mutex);
+  return available;
 }
 
 int UARTClass::peek(void)
 {
-  return rx_buf.peek();
+  if (!this->initialized) {
+    return -1;
+  }
+  int data = -1;
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  if (this->rx_available() > 0) {
+    data = this->rx_buffer[this->rx_read_index];
+  }
+  xSemaphoreGive(this->serial_mutex);
+  return data;
 }
 
 int UARTClass::read(void)
 {
-  task();
-  return rx_buf.read_char();
+  if (!this->initialized) {
+    return -1;
+  }
+  int data = -1;
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  if (this->rx_available() > 0) {
+    data = this->rx_buffer[this->rx_read_index];
+    this->rx_consume(1u);
+  }
+  xSemaphoreGive(this->serial_mutex);
+  return data;
+}
+
+size_t UARTClass::read(uint8_t* buffer, size_t size)
+{
+  if (!this->initialized || buffer == nullptr) {
+    return 0u;
+  }
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  size_t read = this->rx_read_bulk(buffer, size);
+  xSemaphoreGive(this->serial_mutex);
+  return read;
+}
+
+size_t UARTClass::readBytes(char* buffer, size_t length)
+{
+  return this->readBytes((uint8_t*)buffer, length);
+}
+
+size_t UARTClass::readBytes(uint8_t* buffer, size_t length)
+{
+  if (!this->initialized || buffer == nullptr) {
+    return 0u;
+  }
+  // Copy whatever is in the buffer in one go and only wait when it runs dry
+  size_t count = 0u;
+  unsigned long start_millis = millis();
+  while (count < length) {
+    size_t read = this->read(buffer + count, length - count);
+    count += read;
+    if (count >= length) {
+      break;
+    }
+    if (read == 0u) {
+      if (millis() - start_millis >= this->getTimeout()) {
+        break;
+      }
+      yield();
+    } else {
+      start_millis = millis();
+    }
+  }
+  return count;
+}
+
+size_t UARTClass::peekSpan(const uint8_t** data)
+{
+  if (data == nullptr) {
+    return 0u;
+  }
+  *data = nullptr;
+  if (!this->initialized) {
+    return 0u;
+  }
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  size_t available = this->rx_available();
+  size_t contiguous = this->rx_buffer_size - this->rx_read_index;
+  if (available > contiguous) {
+    available = contiguous;
+  }
+  if (available > 0u) {
+    *data = this->rx_buffer + this->rx_read_index;
+  }
+  xSemaphoreGive(this->serial_mutex);
+  return available;
+}
+
+void UARTClass::consume(size_t size)
+{
+  if (!this->initialized) {
+    return;
+  }
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  size_t available = this->rx_available();
+  this->rx_consume(size < available ? size : available);
+  xSemaphoreGive(this->serial_mutex);
+}
+
+int UARTClass::availableForWrite(void)
+{
+  if (!this->initialized || !this->tx_dma_available) {
+    return 0;
+  }
+  return (int)(this->tx_buffer_size - this->tx_count);
 }
 
 void UARTClass::flush(void)
 {
-  ;
+  if (!this->initialized || !this->tx_dma_available) {
+    return;
+  }
+  // Wait until all the data is moved out of the buffer and the last frame leaves the shift register
+  while (!this->tx_is_complete()) {
+    yield();
+  }
 }
 
 size_t UARTClass::write(uint8_t data)
@@ -111,18 +297,51 @@ size_t UARTClass::write(const uint8_t* data, size_t size)
   if (!this->initialized) {
     return 0;
   }
-  sl_iostream_write(this->stream_handle, data, size);
+  if (!this->tx_dma_available) {
+    sl_iostream_write(this->stream_handle, data, size);
+    return size;
+  }
+
+  xSemaphoreTake(this->tx_mutex, portMAX_DELAY);
+  size_t written = 0u;
+  while (written < size) {
+    // Copy as much as fits - the free area of the buffer is not touched by the DMA
+    size_t free_space = this->tx_buffer_size - this->tx_count;
+    size_t chunk = size - written;
+    if (chunk > free_space) {
+      chunk = free_space;
+    }
+    if (chunk == 0u) {
+      // The buffer is full - wait for the DMA to make some room
+      yield();
+      continue;
+    }
+    size_t until_end = this->tx_buffer_size - this->tx_head;
+    if (chunk <= until_end) {
+      memcpy(this->tx_buffer + this->tx_head, data + written, chunk);
+    } else {
+      memcpy(this->tx_buffer + this->tx_head, data + written, until_end);
+      memcpy(this->tx_buffer, data + written + until_end, chunk - until_end);
+    }
+    this->tx_head = (this->tx_head + chunk) % this->tx_buffer_size;
+    written += chunk;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    this->tx_count += chunk;
+    this->tx_dma_start_next_chunk();
+    CORE_EXIT_CRITICAL();
+  }
+  xSemaphoreGive(this->tx_mutex);
   return size;
 }
 
 void UARTClass::printf(const char *fmt, ...)
 {
-  char message[this->printf_buffer_size];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(message, sizeof(message), fmt, args);
+  silabs_vprintf(*this, fmt, args);
   va_end(args);
-  this->write((uint8_t*)message, strlen(message));
 }
 
 void UARTClass::suspend()
@@ -130,8 +349,6 @@ void UARTClass::suspend()
   if (!this->initialized) {
     return;
   }
-  // The small delay is here to allow the last bytes to be transmitted
-  delay(1);
   this->end();
   this->suspended = true;
 }
@@ -141,7 +358,7 @@ void UARTClass::resume()
   if (!this->suspended) {
     return;
   }
-  this->begin(this->baudrate);
+  this->begin(this->baudrate, this->config);
   this->suspended = false;
 }
 
@@ -155,36 +372,562 @@ void UARTClass::task()
   if (!this->initialized) {
     return;
   }
+  // The data is received by DMA in the background - only the buffer state and the counters are updated here
   xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  (void)this->rx_available();
+  xSemaphoreGive(this->serial_mutex);
+  // Release the energy mode requirement of the transmitter if it has finished
+  (void)this->tx_is_complete();
+}
+
+bool UARTClass::setRxBufferSize(size_t size)
+{
+  if (this->initialized || size == 0u || size > max_rx_buffer_size) {
+    return false;
+  }
 
-  uint8_t buf[64];
-  size_t bytes_read = 0;
-  // Set the iostream read API to non-blocking mode
-  sl_iostream_uart_set_read_block(this->instance_handle, false);
-  sl_iostream_read(this->stream_handle, buf, sizeof(buf), &bytes_read);
-  if (bytes_read > 0) {
-    for (uint8_t i = 0; i < bytes_read; i++) {
-      rx_buf.store_char(buf[i]);
+  uint8_t* new_buffer = this->rx_buffer_default;
+  if (size > default_rx_buffer_size) {
+    new_buffer = (uint8_t*)malloc(size);
+    if (new_buffer == nullptr) {
+      return false;
     }
   }
 
+  if (this->rx_buffer_allocated) {
+    free(this->rx_buffer);
+  }
+  this->rx_buffer = new_buffer;
+  this->rx_buffer_size = size;
+  this->rx_buffer_allocated = (new_buffer != this->rx_buffer_default);
+  return true;
+}
+
+bool UARTClass::setTxBufferSize(size_t size)
+{
+  if (this->initialized || size == 0u || size > max_tx_buffer_size) {
+    return false;
+  }
+
+  uint8_t* new_buffer = this->tx_buffer_default;
+  if (size > default_tx_buffer_size) {
+    new_buffer = (uint8_t*)malloc(size);
+    if (new_buffer == nullptr) {
+      return false;
+    }
+  }
+
+  if (this->tx_buffer_allocated) {
+    free(this->tx_buffer);
+  }
+  this->tx_buffer = new_buffer;
+  this->tx_buffer_size = size;
+  this->tx_buffer_allocated = (new_buffer != this->tx_buffer_default);
+  return true;
+}
+
+bool UARTClass::setHardwareFlowControl(bool enable)
+{
+  if (this->flow_control_pins == nullptr) {
+    return !enable;
+  }
+  this->flow_control_set = true;
+  this->flow_control_enabled = enable;
+  if (!this->initialized) {
+    return true;
+  }
+  this->flush();
+  return this->configure_flow_control(enable);
+}
+
+void UARTClass::setRxEventThreshold(size_t threshold)
+{
+  this->rx_event_threshold = (threshold > 0u) ? threshold : 1u;
+}
+
+void UARTClass::setRxEventTerminator(int terminator)
+{
+  this->rx_event_terminator = terminator;
+  this->rx_terminator_end_count = this->rx_read_count;
+}
+
+void UARTClass::setRxIdleTimeout(uint32_t timeout_ms)
+{
+  this->rx_idle_timeout_ms = timeout_ms;
+}
+
+uint32_t UARTClass::getRxOverflowCount()
+{
+  this->task();
+  return this->rx_overflow_count;
+}
+
+uint32_t UARTClass::getOverrunErrorCount()
+{
+  this->task();
+  return this->rx_overrun_count;
+}
+
+uint32_t UARTClass::getFramingErrorCount()
+{
+  this->task();
+  return this->rx_framing_error_count;
+}
+
+uint32_t UARTClass::getParityErrorCount()
+{
+  this->task();
+  return this->rx_parity_error_count;
+}
+
+void UARTClass::clearErrorCounters()
+{
+  this->task();
+  xSemaphoreTake(this->serial_mutex, portMAX_DELAY);
+  this->rx_overflow_count = 0u;
+  this->rx_overrun_count = 0u;
+  this->rx_framing_error_count = 0u;
+  this->rx_parity_error_count = 0u;
   xSemaphoreGive(this->serial_mutex);
 }
 
+bool UARTClass::configure_frame(uint16_t config)
+{
+  // The peripherals are initialized with 8N1 by default
+  if (config == SERIAL_8N1) {
+    return true;
+  }
+  uint16_t data_bits = config & SERIAL_DATA_MASK;
+  uint16_t parity = config & SERIAL_PARITY_MASK;
+  uint16_t stop_bits = config & SERIAL_STOP_BIT_MASK;
+
+  if (peripheral_is_usart(this->peripheral)) {
+    USART_TypeDef* usart = (USART_TypeDef*)this->peripheral;
+    uint32_t frame = 0u;
+    switch (data_bits) {
+      case SERIAL_DATA_5:
+        frame |= USART_FRAME_DATABITS_FIVE;
+        break;
+      case SERIAL_DATA_6:
+        frame |= USART_FRAME_DATABITS_SIX;
+        break;
+      case SERIAL_DATA_7:
+        frame |= USART_FRAME_DATABITS_SEVEN;
+        break;
+      case SERIAL_DATA_8:
+        frame |= USART_FRAME_DATABITS_EIGHT;
+        break;
+      default:
+        return false;
+    }
+    switch (parity) {
+      case SERIAL_PARITY_NONE:
+        frame |= USART_FRAME_PARITY_NONE;
+        break;
+      case SERIAL_PARITY_EVEN:
+        frame |= USART_FRAME_PARITY_EVEN;
+        break;
+      case SERIAL_PARITY_ODD:
+        frame |= USART_FRAME_PARITY_ODD;
+        break;
+      default:
+        return false;
+    }
+    switch (stop_bits) {
+      case SERIAL_STOP_BIT_1:
+        frame |= USART_FRAME_STOPBITS_ONE;
+        break;
+      case SERIAL_STOP_BIT_1_5:
+        frame |= USART_FRAME_STOPBITS_ONEANDAHALF;
+        break;
+      case SERIAL_STOP_BIT_2:
+        frame |= USART_FRAME_STOPBITS_TWO;
+        break;
+      default:
+        return false;
+    }
+    usart->CMD = USART_CMD_RXDIS | USART_CMD_TXDIS;
+    usart->FRAME = (usart->FRAME & ~(_USART_FRAME_DATABITS_MASK | _USART_FRAME_PARITY_MASK | _USART_FRAME_STOPBITS_MASK)) | frame;
+    usart->CMD = USART_CMD_RXEN | USART_CMD_TXEN;
+    return true;
+  }
+
+  // The EUSART supports 7 and 8 data bits
+  EUSART_TypeDef* eusart = (EUSART_TypeDef*)this->peripheral;
+  uint32_t frame = 0u;
+  switch (data_bits) {
+    case SERIAL_DATA_7:
+      frame |= EUSART_FRAMECFG_DATABITS_SEVEN;
+      break;
+    case SERIAL_DATA_8:
+      frame |= EUSART_FRAMECFG_DATABITS_EIGHT;
+      break;
+    default:
+      return false;
+  }
+  switch (parity) {
+    case SERIAL_PARITY_NONE:
+      frame |= EUSART_FRAMECFG_PARITY_NONE;
+      break;
+    case SERIAL_PARITY_EVEN:
+      frame |= EUSART_FRAMECFG_PARITY_EVEN;
+      break;
+    case SERIAL_PARITY_ODD:
+      frame |= EUSART_FRAMECFG_PARITY_ODD;
+      break;
+    default:
+      return false;
+  }
+  switch (stop_bits) {
+    case SERIAL_STOP_BIT_1:
+      frame |= EUSART_FRAMECFG_STOPBITS_ONE;
+      break;
+    case SERIAL_STOP_BIT_1_5:
+      frame |= EUSART_FRAMECFG_STOPBITS_ONEANDAHALF;
+      break;
+    case SERIAL_STOP_BIT_2:
+      frame |= EUSART_FRAMECFG_STOPBITS_TWO;
+      break;
+    default:
+      return false;
+  }
+  eusart_write_config(eusart,
+                      &eusart->FRAMECFG,
+                      _EUSART_FRAMECFG_DATABITS_MASK | _EUSART_FRAMECFG_PARITY_MASK | _EUSART_FRAMECFG_STOPBITS_MASK,
+                      frame);
+  return true;
+}
+
+void UARTClass::configure_baudrate(unsigned long baudrate)
+{
+  // Use the board's default setup with 16x oversampling if the peripheral clock allows it
+  uint32_t clock_freq = get_peripheral_clock_freq(this->peripheral);
+  if (clock_freq == 0u || baudrate * 16u <= clock_freq) {
+    this->baud_rate_set_fn(baudrate);
+    return;
+  }
+
+  // Lower the oversampling for high baud rates (e.g. 2-4 Mbaud) - majority voting needs at least 8 samples
+  uint8_t oversampling;
+  if (baudrate * 8u <= clock_freq) {
+    oversampling = 8u;
+  } else if (baudrate * 6u <= clock_freq) {
+    oversampling = 6u;
+  } else {
+    oversampling = 4u;
+  }
+
+  if (peripheral_is_usart(this->peripheral)) {
+    USART_TypeDef* usart = (USART_TypeDef*)this->peripheral;
+    USART_OVS_TypeDef ovs = (oversampling == 8u) ? usartOVS8 : ((oversampling == 6u) ? usartOVS6 : usartOVS4);
+    if (oversampling < 8u) {
+      usart->CTRL |= USART_CTRL_MVDIS;
+    }
+    USART_BaudrateAsyncSet(usart, 0, baudrate, ovs);
+    return;
+  }
+
+  EUSART_TypeDef* eusart = (EUSART_TypeDef*)this->peripheral;
+  uint32_t ovs = (oversampling == 8u) ? EUSART_CFG0_OVS_X8 : ((oversampling == 6u) ? EUSART_CFG0_OVS_X6 : EUSART_CFG0_OVS_X4);
+  if (oversampling < 8u) {
+    ovs |= EUSART_CFG0_MVDIS;
+  }
+  eusart_write_config(eusart, &eusart->CFG0, _EUSART_CFG0_OVS_MASK | EUSART_CFG0_MVDIS, ovs);
+  EUSART_BaudrateSet(eusart, 0, baudrate);
+}
+
+bool UARTClass::configure_flow_control(bool enable)
+{
+  if (this->flow_control_pins == nullptr) {
+    return !enable;
+  }
+  const uart_flow_control_pins_t* pins = this->flow_control_pins;
+  uint8_t index = get_peripheral_index(this->peripheral);
+  uint32_t cts_route = ((uint32_t)pins->cts_port << _GPIO_USART_CTSROUTE_PORT_SHIFT) | ((uint32_t)pins->cts_pin << _GPIO_USART_CTSROUTE_PIN_SHIFT);
+  uint32_t rts_route = ((uint32_t)pins->rts_port << _GPIO_USART_RTSROUTE_PORT_SHIFT) | ((uint32_t)pins->rts_pin << _GPIO_USART_RTSROUTE_PIN_SHIFT);
+
+  if (enable) {
+    GPIO_PinModeSet(pins->cts_port, pins->cts_pin, gpioModeInput, 0);
+    GPIO_PinModeSet(pins->rts_port, pins->rts_pin, gpioModePushPull, 0);
+  }
+
+  if (peripheral_is_usart(this->peripheral)) {
+    USART_TypeDef* usart = (USART_TypeDef*)this->peripheral;
+    if (enable) {
+      GPIO->USARTROUTE[index].CTSROUTE = cts_route;
+      GPIO->USARTROUTE[index].RTSROUTE = rts_route;
+      GPIO->USARTROUTE[index].ROUTEEN |= GPIO_USART_ROUTEEN_RTSPEN;
+      usart->CTRLX |= USART_CTRLX_CTSEN;
+    } else {
+      usart->CTRLX &= ~USART_CTRLX_CTSEN;
+      GPIO->USARTROUTE[index].ROUTEEN &= ~GPIO_USART_ROUTEEN_RTSPEN;
+      GPIO->USARTROUTE[index].CTSROUTE = 0u;
+      GPIO->USARTROUTE[index].RTSROUTE = 0u;
+    }
+  } else {
+#if defined(EUSART_PRESENT)
+    EUSART_TypeDef* eusart = (EUSART_TypeDef*)this->peripheral;
+    if (enable) {
+      GPIO->EUSARTROUTE[index].CTSROUTE = cts_route;
+      GPIO->EUSARTROUTE[index].RTSROUTE = rts_route;
+      GPIO->EUSARTROUTE[index].ROUTEEN |= GPIO_EUSART_ROUTEEN_RTSPEN;
+    } else {
+      GPIO->EUSARTROUTE[index].ROUTEEN &= ~GPIO_EUSART_ROUTEEN_RTSPEN;
+      GPIO->EUSARTROUTE[index].CTSROUTE = 0u;
+      GPIO->EUSARTROUTE[index].RTSROUTE = 0u;
+    }
+    eusart_write_config(eusart, &eusart->CFG1, EUSART_CFG1_CTSEN, enable ? EUSART_CFG1_CTSEN : 0u);
+#else
+    return false;
+#endif // defined(EUSART_PRESENT)
+  }
+
+  if (!enable) {
+    GPIO_PinModeSet(pins->cts_port, pins->cts_pin, gpioModeInput, 0);
+    GPIO_PinModeSet(pins->rts_port, pins->rts_pin, gpioModeInput, 0);
+  }
+  return true;
+}
+
+// The receive DMA takeover relies on the layout of the iostream driver's private UART context
+// Checked against the iostream of Simplicity SDK 2024.12.1 - fail the build if an SDK update changes it
+static_assert(offsetof(sl_iostream_uart_context_t, dma) == 0u, "sl_iostream_uart_context_t layout changed");
+static_assert(offsetof(sl_iostream_dma_context_t, cfg) == 0u, "sl_iostream_dma_context_t layout changed");
+static_assert(offsetof(sl_iostream_dma_context_t, channel) == sizeof(sl_iostream_dma_config_t), "sl_iostream_dma_context_t layout changed");
+static_assert(sizeof(sl_iostream_dma_config_t) == 8u, "sl_iostream_dma_config_t layout changed");
+static_assert(sizeof(sl_iostream_dma_context_t) == 12u + 2u * sizeof(LDMA_Descriptor_t), "sl_iostream_dma_context_t layout changed");
+static_assert(std::is_same<decltype(sl_iostream_dma_context_t::channel), uint8_t>::value, "sl_iostream_dma_context_t layout changed");
+static_assert(std::is_same<decltype(sl_iostream_dma_config_t::src), uint8_t*>::value, "sl_iostream_dma_config_t layout changed");
+static_assert(std::is_same<decltype(sl_iostream_dma_config_t::peripheral_signal), DMADRV_PeripheralSignal_t>::value, "sl_iostream_dma_config_t layout changed");
+
+bool UARTClass::rx_dma_start()
+{
+  // The iostream driver receives into a small ring buffer of its own with its DMA channel
+  // Take over the channel and point it to our (larger) buffer - the rest of the driver stays untouched
+  // The channel stays allocated to the iostream driver, it's freed by its deinit in 'end()'
+  sl_iostream_uart_context_t* uart_context = (sl_iostream_uart_context_t*)this->instance_handle->stream.context;
+  if (uart_context == nullptr) {
+    return false;
+  }
+  this->rx_dma_channel = uart_context->dma.channel;
+  DMADRV_StopTransfer(this->rx_dma_channel);
+
+  // Split the buffer into chunks of the max LDMA transfer size and link the last chunk back to the first one
+  uint8_t descriptor_count = (this->rx_buffer_size + DMADRV_MAX_XFER_COUNT - 1) / DMADRV_MAX_XFER_COUNT;
+  for (uint8_t i = 0; i < descriptor_count; i++) {
+    size_t offset = i * DMADRV_MAX_XFER_COUNT;
+    size_t count = this->rx_buffer_size - offset;
+    if (count > DMADRV_MAX_XFER_COUNT) {
+      count = DMADRV_MAX_XFER_COUNT;
+    }
+    bool last = (i == descriptor_count - 1);
+    int link_jump = last ? -(int)(descriptor_count - 1) : 1;
+    this->rx_dma_descriptors[i] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(uart_context->dma.cfg.src,
+                                                                                     this->rx_buffer + offset,
+                                                                                     count,
+                                                                                     link_jump);
+    // Only the last chunk raises an interrupt - once per buffer wrap
+    this->rx_dma_descriptors[i].xfer.doneIfs = last ? 1 : 0;
+  }
+
+  this->rx_dma_wraps = 0u;
+  this->rx_read_count = 0u;
+  this->rx_read_index = 0u;
+  this->rx_event_scan_count = 0u;
+  this->rx_terminator_end_count = 0u;
+  this->rx_update_error_counters();
+
+  LDMA_TransferCfg_t transfer_config = LDMA_TRANSFER_CFG_PERIPHERAL(uart_context->dma.cfg.peripheral_signal);
+  Ecode_t result = DMADRV_LdmaStartTransfer((int)this->rx_dma_channel,
+                                            &transfer_config,
+                                            this->rx_dma_descriptors,
+                                            UARTClass::rx_dma_wrap_cb,
+                                            this);
+  this->rx_dma_running = (result == ECODE_EMDRV_DMADRV_OK);
+  return this->rx_dma_running;
+}
+
+void UARTClass::rx_dma_stop()
+{
+  if (!this->rx_dma_running) {
+    return;
+  }
+  DMADRV_StopTransfer(this->rx_dma_channel);
+  this->rx_dma_running = false;
+}
+
+bool UARTClass::rx_dma_wrap_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+  UARTClass* uart = (UARTClass*)userParam;
+  uart->rx_dma_wraps++;
+  return true;
+}
+
+uint32_t UARTClass::rx_dma_get_write_count()
+{
+  if (!this->rx_dma_running) {
+    return this->rx_read_count;
+  }
+  uint32_t channel_mask = 1u << this->rx_dma_channel;
+  uint32_t wrap_pending;
+  uint32_t destination;
+  uint32_t wraps;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  // A wrap may happen while reading the position - read again if the done flag changed in the meantime
+  do {
+    wrap_pending = LDMA->IF & channel_mask;
+    destination = LDMA->CH[this->rx_dma_channel].DST;
+  } while ((LDMA->IF & channel_mask) != wrap_pending);
+  wraps = this->rx_dma_wraps;
+  CORE_EXIT_CRITICAL();
+
+  uint32_t position = destination - (uint32_t)this->rx_buffer;
+  // The destination points to the end of the buffer until the first descriptor is reloaded
+  if (position >= this->rx_buffer_size) {
+    position = 0u;
+  }
+  if (wrap_pending) {
+    wraps++;
+  }
+  return wraps * this->rx_buffer_size + position;
+}
+
+uint32_t UARTClass::rx_available()
+{
+  this->rx_update_error_counters();
+  uint32_t available = this->rx_dma_get_write_count() - this->rx_read_count;
+  // If the DMA has lapped the reader the oldest bytes are lost - skip over them
+  if (available > this->rx_buffer_size) {
+    uint32_t lost = available - this->rx_buffer_size;
+    this->rx_overflow_count += lost;
+    this->rx_read_count += lost;
+    this->rx_read_index = (this->rx_read_index + lost) % this->rx_buffer_size;
+    available = this->rx_buffer_size;
+  }
+  return available;
+}
+
+size_t UARTClass::rx_read_bulk(uint8_t* buffer, size_t size)
+{
+  size_t available = this->rx_available();
+  if (size > available) {
+    size = available;
+  }
+  // Copy in at most two pieces - up to the end of the ring and from its beginning
+  size_t first = this->rx_buffer_size - this->rx_read_index;
+  if (first > size) {
+    first = size;
+  }
+  memcpy(buffer, this->rx_buffer + this->rx_read_index, first);
+  memcpy(buffer + first, this->rx_buffer, size - first);
+  this->rx_consume(size);
+  return size;
+}
+
+void UARTClass::rx_consume(size_t size)
+{
+  this->rx_read_index = (this->rx_read_index + size) % this->rx_buffer_size;
+  this->rx_read_count += size;
+}
+
+void UARTClass::rx_update_error_counters()
+{
+  uint32_t flags;
+  if (peripheral_is_usart(this->peripheral)) {
+    USART_TypeDef* usart = (USART_TypeDef*)this->peripheral;
+    flags = USART_IntGet(usart) & (USART_IF_RXOF | USART_IF_FERR | USART_IF_PERR);
+    USART_IntClear(usart, flags);
+    this->rx_overrun_count += (flags & USART_IF_RXOF) ? 1u : 0u;
+    this->rx_framing_error_count += (flags & USART_IF_FERR) ? 1u : 0u;
+    this->rx_parity_error_count += (flags & USART_IF_PERR) ? 1u : 0u;
+  } else {
+    EUSART_TypeDef* eusart = (EUSART_TypeDef*)this->peripheral;
+    flags = EUSART_IntGet(eusart) & (EUSART_IF_RXOF | EUSART_IF_FERR | EUSART_IF_PERR);
+    EUSART_IntClear(eusart, flags);
+    this->rx_overrun_count += (flags & EUSART_IF_RXOF) ? 1u : 0u;
+    this->rx_framing_error_count += (flags & EUSART_IF_FERR) ? 1u : 0u;
+    this->rx_parity_error_count += (flags & EUSART_IF_PERR) ? 1u : 0u;
+  }
+}
+
 void UARTClass::handleSerialEvent()
 {
-  if (this->available()) {
+  if (!this->initialized) {
+    return;
+  }
+  // Release the energy mode requirement of the transmitter if it has finished
+  (void)this->tx_is_complete();
+  if (this->rx_event_pending()) {
     this->serial_event_fn();
   }
 }
 
+bool UARTClass::rx_event_pending()
+{
+  // Called after every 'loop()' - only the DMA position is read here, the serial mutex is not taken
+  uint32_t write_count = this->rx_dma_get_write_count();
+  uint32_t available = write_count - this->rx_read_count;
+  if (available == 0u) {
+    this->rx_event_scan_count = write_count;
+    return false;
+  }
+
+  if (write_count != this->rx_event_scan_count) {
+    this->rx_last_receive_millis = millis();
+    if (this->rx_event_terminator >= 0) {
+      // Only look at the bytes which arrived since the last check - and are still in the buffer
+      uint32_t scan_count = this->rx_event_scan_count;
+      if (write_count - scan_count > this->rx_buffer_size) {
+        scan_count = write_count - this->rx_buffer_size;
+      }
+      for (; scan_count != write_count; scan_count++) {
+        if (this->rx_buffer[scan_count % this->rx_buffer_size] == (uint8_t)this->rx_event_terminator) {
+          this->rx_terminator_end_count = scan_count + 1u;
+        }
+      }
+    }
+    this->rx_event_scan_count = write_count;
+  }
+
+  // The buffer can't hold more than its size - a larger threshold means a full buffer
+  size_t threshold = (this->rx_event_threshold < this->rx_buffer_size) ? this->rx_event_threshold : this->rx_buffer_size;
+  if (available >= threshold) {
+    return true;
+  }
+  if ((int32_t)(this->rx_terminator_end_count - this->rx_read_count) > 0) {
+    return true;
+  }
+  if (this->rx_idle_timeout_ms > 0u && (millis() - this->rx_last_receive_millis) >= this->rx_idle_timeout_ms) {
+    return true;
+  }
+  return false;
+}
+
 __attribute__((weak)) void serialEvent(void)
 {
   ;
 }
 
+#if defined(SL_SERIAL_CTS_PORT) && defined(SL_SERIAL_RTS_PORT)
+static const uart_flow_control_pins_t serial_flow_control_pins = {
+  (GPIO_Port_TypeDef)SL_SERIAL_CTS_PORT,
+  SL_SERIAL_CTS_PIN,
+  (GPIO_Port_TypeDef)SL_SERIAL_RTS_PORT,
+  SL_SERIAL_RTS_PIN
+};
+#define SERIAL_FLOW_CONTROL_PINS &serial_flow_control_pins
+#else
+#define SERIAL_FLOW_CONTROL_PINS nullptr
+#endif // defined(SL_SERIAL_CTS_PORT) && defined(SL_SERIAL_RTS_PORT)
+
 arduino::UARTClass Serial(sl_serial_stream_handle,
                           sl_serial_instance_handle,
+                          SL_SERIAL_PERIPHERAL,
+                          SERIAL_FLOW_CONTROL_PINS,
                           sl_serial_set_baud_rate,
                           sl_serial_init,
                           sl_serial_deinit,
@@ -196,10 +939,264 @@ __attribute__((weak)) void serialEvent1(void)
   ;
 }
 
+#if defined(SL_SERIAL1_CTS_PORT) && defined(SL_SERIAL1_RTS_PORT)
+static const uart_flow_control_pins_t serial1_flow_control_pins = {
+  (GPIO_Port_TypeDef)SL_SERIAL1_CTS_PORT,
+  SL_SERIAL1_CTS_PIN,
+  (GPIO_Port_TypeDef)SL_SERIAL1_RTS_PORT,
+  SL_SERIAL1_RTS_PIN
+};
+#define SERIAL1_FLOW_CONTROL_PINS &serial1_flow_control_pins
+#else
+#define SERIAL1_FLOW_CONTROL_PINS nullptr
+#endif // defined(SL_SERIAL1_CTS_PORT) && defined(SL_SERIAL1_RTS_PORT)
+
 arduino::UARTClass Serial1(sl_serial1_stream_handle,
                            sl_serial1_instance_handle,
+                           SL_SERIAL1_PERIPHERAL,
+                           SERIAL1_FLOW_CONTROL_PINS,
                            sl_serial1_set_baud_rate,
                            sl_serial1_init,
                            sl_serial1_deinit,
                            serialEvent1);
 #endif // #if (NUM_HW_SERIAL > 1)
+
+bool UARTClass::tx_dma_start()
+{
+  LDMA_PeripheralSignal_t signal;
+  if (!get_tx_dma_peripheral_config(this->peripheral, &signal, &this->tx_data_register)) {
+    return false;
+  }
+
+  DMADRV_Init();
+  if (DMADRV_AllocateChannel(&this->tx_dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK) {
+    return false;
+  }
+  this->tx_dma_config = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL(signal);
+  this->tx_head = 0u;
+  this->tx_tail = 0u;
+  this->tx_count = 0u;
+  this->tx_dma_length = 0u;
+  this->tx_in_progress = false;
+  this->tx_dma_available = true;
+  return true;
+}
+
+void UARTClass::tx_dma_stop()
+{
+  if (!this->tx_dma_available) {
+    return;
+  }
+  DMADRV_StopTransfer(this->tx_dma_channel);
+  DMADRV_FreeChannel(this->tx_dma_channel);
+  this->tx_dma_available = false;
+  this->tx_count = 0u;
+  this->tx_dma_length = 0u;
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  if (this->tx_in_progress) {
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  }
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  this->tx_in_progress = false;
+}
+
+// Has to be called with interrupts disabled
+void UARTClass::tx_dma_start_next_chunk()
+{
+  if (this->tx_dma_length != 0u || this->tx_count == 0u) {
+    return;
+  }
+
+  // Send the contiguous part of the data up to the end of the buffer
+  size_t length = this->tx_buffer_size - this->tx_tail;
+  if (length > this->tx_count) {
+    length = this->tx_count;
+  }
+  if (length > (size_t)DMADRV_MAX_XFER_COUNT) {
+    length = DMADRV_MAX_XFER_COUNT;
+  }
+
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  // Keep the peripheral clocked until the last frame is out
+  if (!this->tx_in_progress) {
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+  }
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  this->tx_in_progress = true;
+
+  this->tx_dma_length = length;
+  this->tx_dma_descriptor = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(this->tx_buffer + this->tx_tail,
+                                                                               this->tx_data_register,
+                                                                               length);
+  DMADRV_LdmaStartTransfer((int)this->tx_dma_channel,
+                           &this->tx_dma_config,
+                           &this->tx_dma_descriptor,
+                           UARTClass::tx_dma_transfer_finished_cb,
+                           this);
+}
+
+bool UARTClass::tx_dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+  UARTClass* uart = (UARTClass*)userParam;
+  uart->tx_tail = (uart->tx_tail + uart->tx_dma_length) % uart->tx_buffer_size;
+  uart->tx_count -= uart->tx_dma_length;
+  uart->tx_dma_length = 0u;
+  uart->tx_dma_start_next_chunk();
+  return true;
+}
+
+bool UARTClass::tx_is_complete()
+{
+  if (!this->tx_in_progress) {
+    return true;
+  }
+  if (this->tx_count != 0u) {
+    return false;
+  }
+
+  // All data is in the peripheral - check whether the last frame has left the shift register
+  bool shift_register_empty;
+  if (peripheral_is_usart(this->peripheral)) {
+    shift_register_empty = (((USART_TypeDef*)this->peripheral)->STATUS & USART_STATUS_TXC) != 0u;
+  } else {
+    shift_register_empty = (((EUSART_TypeDef*)this->peripheral)->STATUS & EUSART_STATUS_TXC) != 0u;
+  }
+  if (!shift_register_empty) {
+    return false;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  // Check again - a write may have started a new transfer in the meantime
+  if (this->tx_in_progress && this->tx_count == 0u) {
+    this->tx_in_progress = false;
+    #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+    #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  }
+  CORE_EXIT_CRITICAL();
+  return !this->tx_in_progress;
+}
+
+// Returns true if the peripheral is a USART instance - the EUSART/EUART instances have a different register layout
+static bool peripheral_is_usart(void* peripheral)
+{
+#if defined(USART0)
+  if (peripheral == USART0) {
+    return true;
+  }
+#endif // defined(USART0)
+#if defined(USART1)
+  if (peripheral == USART1) {
+    return true;
+  }
+#endif // defined(USART1)
+#if defined(USART2)
+  if (peripheral == USART2) {
+    return true;
+  }
+#endif // defined(USART2)
+  return false;
+}
+
+// Returns the instance number of the peripheral within its type (e.g. 1 for EUSART1)
+static uint8_t get_peripheral_index(void* peripheral)
+{
+#if defined(USART1)
+  if (peripheral == USART1) {
+    return 1u;
+  }
+#endif // defined(USART1)
+#if defined(EUSART1)
+  if (peripheral == EUSART1) {
+    return 1u;
+  }
+#endif // defined(EUSART1)
+  return 0u;
+}
+
+// Returns the frequency of the clock feeding the peripheral - or 0 if unknown
+static uint32_t get_peripheral_clock_freq(void* peripheral)
+{
+#if defined(USART0)
+  if (peripheral == USART0) {
+    return CMU_ClockFreqGet(cmuClock_USART0);
+  }
+#endif // defined(USART0)
+#if defined(USART1)
+  if (peripheral == USART1) {
+    return CMU_ClockFreqGet(cmuClock_USART1);
+  }
+#endif // defined(USART1)
+#if defined(EUART0)
+  if (peripheral == EUART0) {
+    return CMU_ClockFreqGet(cmuClock_EUART0);
+  }
+#endif // defined(EUART0)
+#if defined(EUSART0)
+  if (peripheral == EUSART0) {
+    return CMU_ClockFreqGet(cmuClock_EUSART0);
+  }
+#endif // defined(EUSART0)
+#if defined(EUSART1)
+  if (peripheral == EUSART1) {
+    return CMU_ClockFreqGet(cmuClock_EUSART1);
+  }
+#endif // defined(EUSART1)
+  return 0u;
+}
+
+// The EUSART configuration registers can only be written while the peripheral is disabled
+static void eusart_write_config(EUSART_TypeDef* eusart, volatile uint32_t* reg, uint32_t mask, uint32_t value)
+{
+  EUSART_Enable(eusart, eusartDisable);
+  eusart->EN_CLR = EUSART_EN_EN;
+#if defined(_EUSART_EN_DISABLING_MASK)
+  while (eusart->EN & _EUSART_EN_DISABLING_MASK) ;
+#endif // defined(_EUSART_EN_DISABLING_MASK)
+  *reg = (*reg & ~mask) | value;
+  EUSART_Enable(eusart, eusartEnable);
+}
+
+// Provides the DMA request signal and the transmit data register of the peripheral
+static bool get_tx_dma_peripheral_config(void* peripheral, LDMA_PeripheralSignal_t* signal, volatile uint32_t** tx_data_register)
+{
+#if defined(USART0)
+  if (peripheral == USART0) {
+    *signal = ldmaPeripheralSignal_USART0_TXBL;
+    *tx_data_register = &USART0->TXDATA;
+    return true;
+  }
+#endif // defined(USART0)
+#if defined(USART1)
+  if (peripheral == USART1) {
+    *signal = ldmaPeripheralSignal_USART1_TXBL;
+    *tx_data_register = &USART1->TXDATA;
+    return true;
+  }
+#endif // defined(USART1)
+#if defined(EUART0)
+  if (peripheral == EUART0) {
+    *signal = ldmaPeripheralSignal_EUART0_TXFL;
+    *tx_data_register = &EUART0->TXDATA;
+    return true;
+  }
+#endif // defined(EUART0)
+#if defined(EUSART0)
+  if (peripheral == EUSART0) {
+    *signal = ldmaPeripheralSignal_EUSART0_TXFL;
+    *tx_data_register = &EUSART0->TXDATA;
+    return true;
+  }
+#endif // defined(EUSART0)
+#if defined(EUSART1)
+  if (peripheral == EUSART1) {
+    *signal = ldmaPeripheralSignal_EUSART1_TXFL;
+    *tx_data_register = &EUSART1->TXDATA;
+    return true;
+  }
+#endif // defined(EUSART1)
+  return false;
+}
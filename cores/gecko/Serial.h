@@ -37,14 +37,29 @@
 #include "api/Stream.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "dmadrv.h"
 #include "arduino_serial_config.h"
+#include "silabs_printf.h"
+
+extern "C" {
+  #include "sl_power_manager.h"
+}
 
 namespace arduino {
+typedef struct {
+  GPIO_Port_TypeDef cts_port;
+  uint8_t cts_pin;
+  GPIO_Port_TypeDef rts_port;
+  uint8_t rts_pin;
+} uart_flow_control_pins_t;
+
 class UARTClass : public HardwareSerial
 {
 public:
   UARTClass(sl_iostream_t* stream,
             sl_iostream_uart_t* instance,
+            void* peripheral,
+            const uart_flow_control_pins_t* flow_control_pins,
             void(*baud_rate_set_fn)(uint32_t baudrate),
             void(*init_fn)(void),
             void(*deinit_fn)(void),
@@ -55,6 +70,10 @@ public:
   int available(void);
   int peek(void);
   int read(void);
+  size_t read(uint8_t* buffer, size_t size);
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length);
+  int availableForWrite(void);
   void flush(void);
   size_t write(uint8_t data);
   size_t write(const uint8_t* data, size_t size);
@@ -65,10 +84,204 @@ public:
   void printf(const char* fmt, ...);
   void suspend();
   void resume();
+
+  /***************************************************************************//**
+   * Returns the longest contiguous region of received data without removing it
+   * The data can be parsed in place from the receive buffer and released with 'consume()'.
+   * As the buffer is a ring the returned region ends at the end of the buffer - call again
+   * after consuming to get the data which wrapped around to the beginning.
+   * The region stays valid until it is consumed, as long as the buffer does not overflow.
+   *
+   * @param[out] data set to the first unread byte in the receive buffer
+   *
+   * @return the number of bytes available at 'data'
+   ******************************************************************************/
+  size_t peekSpan(const uint8_t** data);
+
+  /***************************************************************************//**
+   * Removes bytes from the receive buffer without copying them
+   * Meant to release the data returned by 'peekSpan()'.
+   *
+   * @param[in] size the number of bytes to remove - limited to the available bytes
+   ******************************************************************************/
+  void consume(size_t size);
+
+  /***************************************************************************//**
+   * Sets the size of the receive buffer
+   * The received bytes are moved to the buffer by DMA in the background - independently
+   * of how often 'loop()' runs. The buffer has to be large enough to hold all the data
+   * arriving between two reads, otherwise the oldest bytes are overwritten.
+   * Has to be called before 'begin()'. The buffer is allocated on the heap, sizes up to
+   * 'default_rx_buffer_size' use the internal buffer.
+   *
+   * @param[in] size the size of the receive buffer in bytes (1 - 'max_rx_buffer_size')
+   *
+   * @return true if the buffer size was set, false if the size is invalid,
+   *         the serial is already running or the allocation failed
+   ******************************************************************************/
+  bool setRxBufferSize(size_t size);
+
+  /***************************************************************************//**
+   * Returns the number of received bytes lost because the receive buffer was full
+   *
+   * @return the number of bytes dropped from the receive buffer
+   ******************************************************************************/
+  uint32_t getRxOverflowCount();
+
+  /***************************************************************************//**
+   * Returns the number of hardware receive overruns
+   * An overrun happens when the peripheral's receive FIFO overflows before the data
+   * could be moved out of it.
+   *
+   * @return the number of receive overrun errors
+   ******************************************************************************/
+  uint32_t getOverrunErrorCount();
+
+  /***************************************************************************//**
+   * Returns the number of frames received with an invalid stop bit
+   *
+   * @return the number of framing errors
+   ******************************************************************************/
+  uint32_t getFramingErrorCount();
+
+  /***************************************************************************//**
+   * Returns the number of frames received with an invalid parity bit
+   *
+   * @return the number of parity errors
+   ******************************************************************************/
+  uint32_t getParityErrorCount();
+
+  /***************************************************************************//**
+   * Resets the receive overflow and error counters to zero
+   ******************************************************************************/
+  void clearErrorCounters();
+
+  /***************************************************************************//**
+   * Sets the size of the transmit buffer
+   * 'write()' copies the data to the buffer and returns immediately, the buffer is
+   * drained by DMA in the background. 'write()' only blocks if the buffer is full.
+   * Has to be called before 'begin()'. The buffer is allocated on the heap, sizes up to
+   * 'default_tx_buffer_size' use the internal buffer.
+   *
+   * @param[in] size the size of the transmit buffer in bytes (1 - 'max_tx_buffer_size')
+   *
+   * @return true if the buffer size was set, false if the size is invalid,
+   *         the serial is already running or the allocation failed
+   ******************************************************************************/
+  bool setTxBufferSize(size_t size);
+
+  /***************************************************************************//**
+   * Returns the frame config the port is running with
+   * The USART supports 5 to 8 data bits and the EUSART 7 or 8 - 'begin()' falls back
+   * to SERIAL_8N1 if the requested config is not supported by the peripheral.
+   *
+   * @return the SERIAL_xxx frame config in effect
+   ******************************************************************************/
+  uint16_t getConfig();
+
+  /***************************************************************************//**
+   * Enables or disables RTS/CTS hardware flow control
+   * Only available on the serial ports which have RTS and CTS pins on the board.
+   * If the serial is running the setting is applied immediately, otherwise on the next 'begin()'.
+   *
+   * @param[in] enable true to enable, false to disable hardware flow control
+   *
+   * @return true if the setting was applied, false if the serial port has no flow control pins
+   ******************************************************************************/
+  bool setHardwareFlowControl(bool enable);
+
+  /***************************************************************************//**
+   * Sets the number of received bytes needed to call 'serialEvent()'
+   * By default 'serialEvent()' is called as soon as a single byte is available.
+   * Use together with 'setRxIdleTimeout()' to get the remaining bytes of a burst too.
+   *
+   * @param[in] threshold the minimum number of available bytes (1 - receive buffer size)
+   ******************************************************************************/
+  void setRxEventThreshold(size_t threshold);
+
+  /***************************************************************************//**
+   * Sets a byte which calls 'serialEvent()' regardless of the threshold
+   * 'serialEvent()' is called as long as a received terminator hasn't been read.
+   *
+   * @param[in] terminator the terminator byte (e.g. '\n'), -1 to disable
+   ******************************************************************************/
+  void setRxEventTerminator(int terminator);
+
+  /***************************************************************************//**
+   * Sets the time after the last received byte when 'serialEvent()' is called
+   * regardless of the threshold
+   *
+   * @param[in] timeout_ms the idle time in milliseconds, 0 to disable
+   ******************************************************************************/
+  void setRxIdleTimeout(uint32_t timeout_ms);
+
+  static const size_t default_rx_buffer_size = 256u;
+  static const size_t max_rx_buffer_size = 4u * DMADRV_MAX_XFER_COUNT;
+  static const size_t default_tx_buffer_size = 256u;
+  static const size_t max_tx_buffer_size = 8192u;
+
 private:
-  static const uint8_t printf_buffer_size = 128u;
+  bool configure_frame(uint16_t config);
+  void configure_baudrate(unsigned long baudrate);
+  bool configure_flow_control(bool enable);
+
+  static const uint8_t max_rx_dma_descriptors = max_rx_buffer_size / DMADRV_MAX_XFER_COUNT;
+
+  bool rx_dma_start();
+  void rx_dma_stop();
+  uint32_t rx_dma_get_write_count();
+  uint32_t rx_available();
+  size_t rx_read_bulk(uint8_t* buffer, size_t size);
+  void rx_consume(size_t size);
+  void rx_update_error_counters();
+  bool rx_event_pending();
+  static bool rx_dma_wrap_cb(unsigned int channel, unsigned int sequenceNo, void *userParam);
+  bool tx_dma_start();
+  void tx_dma_stop();
+  void tx_dma_start_next_chunk();
+  bool tx_is_complete();
+  static bool tx_dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam);
+
+  uint8_t rx_buffer_default[default_rx_buffer_size];
+  uint8_t* rx_buffer;
+  size_t rx_buffer_size;
+  bool rx_buffer_allocated;
+  LDMA_Descriptor_t rx_dma_descriptors[max_rx_dma_descriptors];
+  bool rx_dma_running;
+  unsigned int rx_dma_channel;
+  volatile uint32_t rx_dma_wraps;
+  uint32_t rx_read_count;
+  size_t rx_read_index;
+
+  uint32_t rx_overflow_count;
+  uint32_t rx_overrun_count;
+  uint32_t rx_framing_error_count;
+  uint32_t rx_parity_error_count;
+
+  size_t rx_event_threshold;
+  int rx_event_terminator;
+  uint32_t rx_idle_timeout_ms;
+  uint32_t rx_event_scan_count;
+  uint32_t rx_terminator_end_count;
+  uint32_t rx_last_receive_millis;
+
+  uint8_t tx_buffer_default[default_tx_buffer_size];
+  uint8_t* tx_buffer;
+  size_t tx_buffer_size;
+  bool tx_buffer_allocated;
+  LDMA_Descriptor_t tx_dma_descriptor;
+  LDMA_TransferCfg_t tx_dma_config;
+  volatile uint32_t* tx_data_register;
+  bool tx_dma_available;
+  unsigned int tx_dma_channel;
+  size_t tx_head;
+  volatile size_t tx_tail;
+  volatile size_t tx_count;
+  volatile size_t tx_dma_length;
+  volatile bool tx_in_progress;
 
-  RingBufferN<128> rx_buf;
+  SemaphoreHandle_t tx_mutex;
+  StaticSemaphore_t tx_mutex_buf;
 
   SemaphoreHandle_t serial_mutex;
   StaticSemaphore_t serial_mutex_buf;
@@ -80,9 +293,14 @@ private:
 
   sl_iostream_t* stream_handle;
   sl_iostream_uart_t* instance_handle;
+  void* peripheral;
+  const uart_flow_control_pins_t* flow_control_pins;
+  bool flow_control_set;
+  bool flow_control_enabled;
 
   bool initialized;
   unsigned long baudrate;
+  uint16_t config;
   bool suspended;
 };
 } // namespace arduino
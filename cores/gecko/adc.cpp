@@ -33,6 +33,7 @@ static bool dma_transfer_finished_cb(unsigned int channel, unsigned int sequence
 AdcClass::AdcClass() :
   initialized_single(false),
   initialized_scan(false),
+  initialized_monitor(false),
   paused_transfer(false),
   current_adc_pin(PD2),
   current_adc_reference(iadcCfgReferenceVddx),
@@ -40,6 +41,11 @@ AdcClass::AdcClass() :
   current_read_resolution(this->max_read_resolution_bits),
   current_adc_gain(iadcCfgAnalogGain1x),
   user_onsampling_finished_callback(nullptr),
+  user_onwindow_exit_callback(nullptr),
+  monitor_gte_threshold(0u),
+  monitor_lte_threshold(0u),
+  monitor_prs_channel(-1),
+  monitor_prev_iadc_clock(cmuSelect_EM01GRPACLK),
   adc_mutex(nullptr)
 {
   this->adc_mutex = xSemaphoreCreateMutexStatic(&this->adc_mutex_buf);
@@ -83,31 +89,11 @@ void AdcClass::init_single(PinName pin)
   IADC_initSingle(IADC0, &init_single, &input);
   IADC_enableInt(IADC0, IADC_IEN_SINGLEDONE);
 
-  // Allocate the analog bus for ADC0 inputs
-  // Port C and D are handled together
-  // Even and odd pins on the same port have a different register value
-  bool pin_is_even = (pin % 2 == 0);
-  if (pin >= PD0 || pin >= PC0) {
-    if (pin_is_even) {
-      GPIO->CDBUSALLOC |= GPIO_CDBUSALLOC_CDEVEN0_ADC0;
-    } else {
-      GPIO->CDBUSALLOC |= GPIO_CDBUSALLOC_CDODD0_ADC0;
-    }
-  } else if (pin >= PB0) {
-    if (pin_is_even) {
-      GPIO->BBUSALLOC |= GPIO_BBUSALLOC_BEVEN0_ADC0;
-    } else {
-      GPIO->BBUSALLOC |= GPIO_BBUSALLOC_BODD0_ADC0;
-    }
-  } else {
-    if (pin_is_even) {
-      GPIO->ABUSALLOC |= GPIO_ABUSALLOC_AEVEN0_ADC0;
-    } else {
-      GPIO->ABUSALLOC |= GPIO_ABUSALLOC_AODD0_ADC0;
-    }
-  }
+  // Allocate the analog bus for the ADC input
+  this->allocate_analog_bus(pin);
 
   this->initialized_scan = false;
+  this->initialized_monitor = false;
   this->initialized_single = true;
 }
 
@@ -181,7 +167,171 @@ void AdcClass::init_scan(PinName pin)
   IADC_initScan(IADC0, &init_scan, &scanTable);
   IADC_enableInt(IADC0, IADC_IEN_SCANTABLEDONE);
 
-  // Allocate the analog bus for ADC0 inputs
+  // Allocate the analog bus for the ADC input
+  this->allocate_analog_bus(pin);
+
+  this->initialized_single = false;
+  this->initialized_monitor = false;
+  this->initialized_scan = true;
+}
+
+void AdcClass::init_monitor(PinName pin)
+{
+  // Set up the ADC pin as an input
+  pinMode(pin, INPUT);
+
+  // Create ADC init structs with default values
+  IADC_Init_t init = IADC_INIT_DEFAULT;
+  IADC_AllConfigs_t all_configs = IADC_ALLCONFIGS_DEFAULT;
+  IADC_InitSingle_t init_single = IADC_INITSINGLE_DEFAULT;
+  IADC_SingleInput_t input = IADC_SINGLEINPUT_DEFAULT;
+
+  // Enable IADC0, GPIO and PRS clock branches
+  CMU_ClockEnable(cmuClock_IADC0, true);
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  // Clock the ADC from FSRCO which keeps running in EM2
+  CMU_ClockSelectSet(cmuClock_IADCCLK, cmuSelect_FSRCO);
+
+  // Only request the ADC clock when a PRS trigger arrives for the single queue
+  init.iadcClkSuspend1 = true;
+
+  // Shutdown between conversions to reduce current
+  init.warmup = iadcWarmupNormal;
+
+  // Set the HFSCLK prescale value here
+  init.srcClkPrescale = IADC_calcSrcClkPrescale(IADC0, 20000000, 0);
+
+  // Set the window comparator thresholds
+  init.greaterThanEqualThres = this->monitor_gte_threshold;
+  init.lessThanEqualThres = this->monitor_lte_threshold;
+
+  // Set the voltage reference and gain
+  all_configs.configs[0].reference = this->current_adc_reference;
+  all_configs.configs[0].vRef = this->current_adc_vref;
+  all_configs.configs[0].analogGain = this->current_adc_gain;
+  all_configs.configs[0].adcClkPrescale = IADC_calcAdcClkPrescale(IADC0,
+                                                                  10000000,
+                                                                  0,
+                                                                  iadcCfgModeNormal,
+                                                                  init.srcClkPrescale);
+
+  // Reset and configure the ADC
+  IADC_reset(IADC0);
+  IADC_init(IADC0, &init, &all_configs);
+
+  // Convert once on every rising edge of the PRS trigger
+  init_single.triggerSelect = iadcTriggerSelPrs0PosEdge;
+  init_single.triggerAction = iadcTriggerActionOnce;
+
+  // Assign the input pin and compare every result against the window
+  uint32_t pin_index = pin - PIN_NAME_MIN;
+  input.posInput = GPIO_to_ADC_pin_map[pin_index];
+  input.compare = true;
+
+  // Initialize the ADC
+  IADC_initSingle(IADC0, &init_single, &input);
+
+  // Only the window comparator is allowed to wake up the CPU
+  IADC_clearInt(IADC0, _IADC_IF_MASK);
+  IADC_enableInt(IADC0, IADC_IEN_SINGLECMP);
+  NVIC_ClearPendingIRQ(IADC_IRQn);
+  NVIC_EnableIRQ(IADC_IRQn);
+
+  // Allocate the analog bus for the ADC input
+  this->allocate_analog_bus(pin);
+
+  // Arm the single queue - conversions will happen on the PRS triggers
+  IADC_command(IADC0, iadcCmdStartSingle);
+
+  this->initialized_single = false;
+  this->initialized_scan = false;
+  this->initialized_monitor = true;
+}
+
+sl_status_t AdcClass::init_monitor_trigger(uint32_t period_ms)
+{
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  // Calculate the LETIMER reload value for the requested period
+  uint64_t ticks = ((uint64_t)period_ms * CMU_ClockFreqGet(cmuClock_LETIMER0)) / 1000u;
+  if (ticks == 0u || ticks > _LETIMER_TOP_TOP_MASK) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  // Find a free asynchronous PRS channel
+  if (this->monitor_prs_channel < 0) {
+    for (int ch = 0; ch < (int)PRS_ASYNC_CH_NUM; ch++) {
+      if ((PRS->ASYNC_CH[ch].CTRL & _PRS_ASYNC_CH_CTRL_SOURCESEL_MASK) == 0u) {
+        this->monitor_prs_channel = ch;
+        break;
+      }
+    }
+  }
+  if (this->monitor_prs_channel < 0) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  // Stop the LETIMER if it's already running
+  LETIMER0->EN = 0u;
+  #if defined(LETIMER_EN_DISABLING)
+  while (LETIMER0->EN & LETIMER_EN_DISABLING) ;
+  #endif // defined(LETIMER_EN_DISABLING)
+
+  // Generate a pulse on the LETIMER output 0 at every underflow
+  LETIMER0->CTRL = LETIMER_CTRL_REPMODE_FREE | LETIMER_CTRL_UFOA0_PULSE | LETIMER_CTRL_CNTTOPEN;
+  LETIMER0->EN = LETIMER_EN_EN;
+  LETIMER0->TOP = (uint32_t)ticks - 1u;
+  LETIMER0->CNT = (uint32_t)ticks - 1u;
+
+  // Route the LETIMER output to the ADC single trigger through PRS
+  PRS->ASYNC_CH[this->monitor_prs_channel].CTRL = PRS_ASYNC_LETIMER0_CH0 | PRS_ASYNC_CH_CTRL_FNSEL_A;
+  PRS->CONSUMER_IADC0_SINGLETRIGGER = (uint32_t)this->monitor_prs_channel;
+
+  // Start the LETIMER
+  while (LETIMER0->SYNCBUSY) ;
+  LETIMER0->CMD = LETIMER_CMD_START;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t AdcClass::set_window_thresholds(uint16_t low, uint16_t high)
+{
+  const uint32_t max_raw_value = (1u << this->max_read_resolution_bits) - 1u;
+  const uint8_t resolution_shift = this->max_read_resolution_bits - this->current_read_resolution;
+
+  // Scale the window to the native resolution - the upper bound includes all the dropped LSBs
+  uint32_t low_raw = (uint32_t)low << resolution_shift;
+  uint32_t high_raw = ((uint32_t)high << resolution_shift) | ((1u << resolution_shift) - 1u);
+
+  if (low > high || high_raw > max_raw_value) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  // The comparator matches outside of the window when the 'greater than or equal' threshold
+  // is larger than the 'less than or equal' threshold - and inside of it otherwise
+  if (low_raw == 0u && high_raw == max_raw_value) {
+    // The window covers the whole range - it can never be left
+    return SL_STATUS_INVALID_PARAMETER;
+  } else if (low_raw == 0u) {
+    // Only the upper bound can be crossed - match inside [high + 1, max]
+    this->monitor_gte_threshold = (uint16_t)(high_raw + 1u);
+    this->monitor_lte_threshold = (uint16_t)max_raw_value;
+  } else if (high_raw == max_raw_value) {
+    // Only the lower bound can be crossed - match inside [0, low - 1]
+    this->monitor_gte_threshold = 0u;
+    this->monitor_lte_threshold = (uint16_t)(low_raw - 1u);
+  } else {
+    // Match outside of [low, high]
+    this->monitor_gte_threshold = (uint16_t)(high_raw + 1u);
+    this->monitor_lte_threshold = (uint16_t)(low_raw - 1u);
+  }
+  return SL_STATUS_OK;
+}
+
+void AdcClass::allocate_analog_bus(PinName pin)
+{
   // Port C and D are handled together
   // Even and odd pins on the same port have a different register value
   bool pin_is_even = (pin % 2 == 0);
@@ -204,9 +354,6 @@ void AdcClass::init_scan(PinName pin)
       GPIO->ABUSALLOC |= GPIO_ABUSALLOC_AODD0_ADC0;
     }
   }
-
-  this->initialized_single = false;
-  this->initialized_scan = true;
 }
 
 sl_status_t AdcClass::init_dma(uint32_t *buffer, uint32_t size)
@@ -249,6 +396,10 @@ uint16_t AdcClass::get_sample(PinName pin)
     this->scan_stop();
   }
 
+  if (this->initialized_monitor) {
+    this->deinit_monitor();
+  }
+
   if (!this->initialized_single || (pin != this->current_adc_pin)) {
     this->current_adc_pin = pin;
     this->init_single(this->current_adc_pin);
@@ -310,6 +461,8 @@ void AdcClass::set_reference(uint8_t reference)
     this->init_single(this->current_adc_pin);
   } else if (this->initialized_scan) {
     this->init_scan(this->current_adc_pin);
+  } else if (this->initialized_monitor) {
+    this->init_monitor(this->current_adc_pin);
   }
   xSemaphoreGive(this->adc_mutex);
 }
@@ -355,6 +508,8 @@ void AdcClass::set_gain(analog_gain_t gain) {
     this->init_single(this->current_adc_pin);
   } else if (this->initialized_scan) {
     this->init_scan(this->current_adc_pin);
+  } else if (this->initialized_monitor) {
+    this->init_monitor(this->current_adc_pin);
   }
 
   xSemaphoreGive(this->adc_mutex);
@@ -365,6 +520,10 @@ sl_status_t AdcClass::scan_start(PinName pin, uint32_t *buffer, uint32_t size, v
   sl_status_t status = SL_STATUS_FAIL;
   xSemaphoreTake(this->adc_mutex, portMAX_DELAY);
 
+  if (this->initialized_monitor) {
+    this->deinit_monitor();
+  }
+
   if ((!this->initialized_scan && !this->initialized_single) || (pin != this->current_adc_pin)) {
     // Initialize in scan mode
     this->current_adc_pin = pin;
@@ -401,8 +560,114 @@ void AdcClass::scan_stop()
   this->paused_transfer = true;
 }
 
+sl_status_t AdcClass::monitor_start(PinName pin, uint16_t low, uint16_t high, uint32_t period_ms, void (*user_onwindow_exit_callback)(uint16_t))
+{
+  if (pin == PIN_NAME_NC || period_ms == 0u) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  xSemaphoreTake(this->adc_mutex, portMAX_DELAY);
+
+  sl_status_t status = this->set_window_thresholds(low, high);
+  if (status != SL_STATUS_OK) {
+    xSemaphoreGive(this->adc_mutex);
+    return status;
+  }
+
+  // Stop any ongoing scan
+  if (this->initialized_scan) {
+    DMADRV_StopTransfer(this->dma_channel);
+    DMADRV_FreeChannel(this->dma_channel);
+    this->paused_transfer = false;
+  }
+
+  // Save the ADC clock source so it can be restored when the monitoring stops
+  if (!this->initialized_monitor) {
+    this->monitor_prev_iadc_clock = CMU_ClockSelectGet(cmuClock_IADCCLK);
+  }
+
+  this->current_adc_pin = pin;
+  this->user_onwindow_exit_callback = user_onwindow_exit_callback;
+  this->init_monitor(this->current_adc_pin);
+
+  status = this->init_monitor_trigger(period_ms);
+  if (status != SL_STATUS_OK) {
+    this->deinit_monitor();
+  }
+  xSemaphoreGive(this->adc_mutex);
+  return status;
+}
+
+sl_status_t AdcClass::monitor_set_window(uint16_t low, uint16_t high)
+{
+  xSemaphoreTake(this->adc_mutex, portMAX_DELAY);
+  if (!this->initialized_monitor) {
+    xSemaphoreGive(this->adc_mutex);
+    return SL_STATUS_NOT_INITIALIZED;
+  }
+
+  sl_status_t status = this->set_window_thresholds(low, high);
+  if (status == SL_STATUS_OK) {
+    // The thresholds can only be changed while the ADC is disabled
+    this->init_monitor(this->current_adc_pin);
+  }
+
+  xSemaphoreGive(this->adc_mutex);
+  return status;
+}
+
+uint16_t AdcClass::monitor_get_sample()
+{
+  if (!this->initialized_monitor) {
+    return 0u;
+  }
+  uint16_t result = (uint16_t)IADC_readSingleData(IADC0);
+  return result >> (this->max_read_resolution_bits - this->current_read_resolution);
+}
+
+void AdcClass::monitor_stop()
+{
+  xSemaphoreTake(this->adc_mutex, portMAX_DELAY);
+  this->deinit_monitor();
+  xSemaphoreGive(this->adc_mutex);
+}
+
+// Called with 'adc_mutex' taken
+void AdcClass::deinit_monitor()
+{
+  if (!this->initialized_monitor) {
+    return;
+  }
+
+  // Stop the periodic trigger
+  LETIMER0->EN = 0u;
+  CMU_ClockEnable(cmuClock_LETIMER0, false);
+
+  // Release the PRS channel
+  if (this->monitor_prs_channel >= 0) {
+    PRS->CONSUMER_IADC0_SINGLETRIGGER = _PRS_CONSUMER_IADC0_SINGLETRIGGER_RESETVALUE;
+    PRS->ASYNC_CH[this->monitor_prs_channel].CTRL = _PRS_ASYNC_CH_CTRL_RESETVALUE;
+    this->monitor_prs_channel = -1;
+  }
+
+  // Disable the window comparator interrupt
+  NVIC_DisableIRQ(IADC_IRQn);
+  NVIC_ClearPendingIRQ(IADC_IRQn);
+  IADC_disableInt(IADC0, IADC_IEN_SINGLECMP);
+
+  // Reset the ADC and restore its clock source
+  IADC_reset(IADC0);
+  CMU_ClockSelectSet(cmuClock_IADCCLK, this->monitor_prev_iadc_clock);
+
+  this->user_onwindow_exit_callback = nullptr;
+  this->initialized_monitor = false;
+}
+
 void AdcClass::deinit()
 {
+  if (this->initialized_monitor) {
+    this->deinit_monitor();
+  }
+
   // Stop sampling
   DMADRV_StopTransfer(this->dma_channel);
 
@@ -426,6 +691,38 @@ void AdcClass::handle_dma_finished_callback()
   this->user_onsampling_finished_callback();
 }
 
+void AdcClass::handle_window_compare_irq()
+{
+  uint32_t flags = IADC_getInt(IADC0);
+  IADC_clearInt(IADC0, flags);
+
+  if (!(flags & IADC_IF_SINGLECMP)) {
+    return;
+  }
+
+  // Disarm the comparator - it would fire for every conversion until the value returns into the window
+  IADC_disableInt(IADC0, IADC_IEN_SINGLECMP);
+
+  // Read the latest result and drop the rest of the FIFO
+  uint16_t result = (uint16_t)IADC_readSingleData(IADC0);
+  while (IADC_getSingleFifoCnt(IADC0)) {
+    (void)IADC_pullSingleFifoData(IADC0);
+  }
+
+  if (!this->user_onwindow_exit_callback) {
+    return;
+  }
+
+  // Apply the configured read resolution
+  result = result >> (this->max_read_resolution_bits - this->current_read_resolution);
+  this->user_onwindow_exit_callback(result);
+}
+
+void IADC_IRQHandler(void)
+{
+  ADC.handle_window_compare_irq();
+}
+
 bool dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
 {
   (void)channel;
@@ -111,6 +111,48 @@ public:
    ******************************************************************************/
   void scan_stop();
 
+  /***************************************************************************//**
+   * Starts monitoring a pin with the ADC window comparator
+   *
+   * The conversions are triggered periodically by LETIMER0 through PRS, so the
+   * device can stay in EM2 between samples. The CPU is only woken up when a
+   * sample falls outside the [low, high] window. The comparator is disarmed after
+   * each window exit, use 'monitor_set_window()' to re-arm it.
+   * Single measurements and scans stop the monitoring.
+   *
+   * @param[in] pin The pin number of the ADC input
+   * @param[in] low The lower bound of the window in the current read resolution
+   * @param[in] high The upper bound of the window in the current read resolution
+   * @param[in] period_ms The time between two conversions in milliseconds
+   * @param[in] user_onwindow_exit_callback Callback that gets called from interrupt
+   *            context with the sample which left the window
+   *
+   * @return Status of the monitor init process
+   ******************************************************************************/
+  sl_status_t monitor_start(PinName pin, uint16_t low, uint16_t high, uint32_t period_ms, void (*user_onwindow_exit_callback)(uint16_t));
+
+  /***************************************************************************//**
+   * Sets a new window for the ongoing monitoring and re-arms the comparator
+   *
+   * @param[in] low The lower bound of the window in the current read resolution
+   * @param[in] high The upper bound of the window in the current read resolution
+   *
+   * @return Status of the operation
+   ******************************************************************************/
+  sl_status_t monitor_set_window(uint16_t low, uint16_t high);
+
+  /***************************************************************************//**
+   * Returns the latest sample of the ongoing monitoring without triggering a conversion
+   *
+   * @return the latest monitored sample in the current read resolution
+   ******************************************************************************/
+  uint16_t monitor_get_sample();
+
+  /***************************************************************************//**
+   * Stops the ADC window monitoring
+   ******************************************************************************/
+  void monitor_stop();
+
   /***************************************************************************//**
    * De-initialize the ADC
    ******************************************************************************/
@@ -121,6 +163,11 @@ public:
    ******************************************************************************/
   void handle_dma_finished_callback();
 
+  /***************************************************************************//**
+   * Interrupt handler for the window comparator
+   ******************************************************************************/
+  void handle_window_compare_irq();
+
   // The maximum read resolution of the ADC
   static const uint8_t max_read_resolution_bits = 12u;
 
@@ -150,8 +197,47 @@ private:
    *****************************************************************************/
   sl_status_t init_dma(uint32_t *buffer, uint32_t size);
 
+  /***************************************************************************//**
+   * Initializes the ADC hardware for PRS triggered window compare conversions
+   *
+   * @param[in] pin The pin number of the ADC input
+   ******************************************************************************/
+  void init_monitor(PinName pin);
+
+  /***************************************************************************//**
+   * Initializes LETIMER0 and a PRS channel to periodically trigger the ADC
+   *
+   * @param[in] period_ms The time between two conversions in milliseconds
+   *
+   * @return Status of the trigger init process
+   ******************************************************************************/
+  sl_status_t init_monitor_trigger(uint32_t period_ms);
+
+  /***************************************************************************//**
+   * Stops the monitoring trigger and resets the ADC hardware
+   ******************************************************************************/
+  void deinit_monitor();
+
+  /***************************************************************************//**
+   * Converts a window in the current read resolution to comparator thresholds
+   *
+   * @param[in] low The lower bound of the window
+   * @param[in] high The upper bound of the window
+   *
+   * @return Status of the conversion
+   ******************************************************************************/
+  sl_status_t set_window_thresholds(uint16_t low, uint16_t high);
+
+  /***************************************************************************//**
+   * Allocates the analog bus for the provided ADC input pin
+   *
+   * @param[in] pin The pin number of the ADC input
+   ******************************************************************************/
+  void allocate_analog_bus(PinName pin);
+
   bool initialized_single;
   bool initialized_scan;
+  bool initialized_monitor;
   bool paused_transfer;
 
   PinName current_adc_pin;
@@ -166,6 +252,12 @@ private:
 
   void (*user_onsampling_finished_callback)(void);
 
+  void (*user_onwindow_exit_callback)(uint16_t);
+  uint16_t monitor_gte_threshold;
+  uint16_t monitor_lte_threshold;
+  int monitor_prs_channel;
+  CMU_Select_TypeDef monitor_prev_iadc_clock;
+
   static const IADC_PosInput_t GPIO_to_ADC_pin_map[64];
 
   SemaphoreHandle_t adc_mutex;
@@ -32,7 +32,20 @@
 
 using namespace arduino;
 
-DacClass::DacClass(VDAC_TypeDef *vdac_peripheral, PinName ch0_pin, PinName ch1_pin) :
+// Timers pacing the waveform playback - can be overridden in the variant's DAC config
+#ifndef SL_DAC0_WAVEFORM_TIMER
+#define SL_DAC0_WAVEFORM_TIMER TIMER4
+#endif // SL_DAC0_WAVEFORM_TIMER
+
+#ifndef SL_DAC1_WAVEFORM_TIMER
+#define SL_DAC1_WAVEFORM_TIMER TIMER3
+#endif // SL_DAC1_WAVEFORM_TIMER
+
+static bool waveform_dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam);
+static CMU_Clock_TypeDef get_timer_clock(TIMER_TypeDef *timer);
+static LDMA_PeripheralSignal_t get_timer_overflow_dma_signal(TIMER_TypeDef *timer);
+
+DacClass::DacClass(VDAC_TypeDef *vdac_peripheral, PinName ch0_pin, PinName ch1_pin, TIMER_TypeDef *waveform_timer) :
   dac_initialized(false),
   ch0_pin(ch0_pin),
   ch1_pin(ch1_pin),
@@ -43,7 +56,14 @@ DacClass::DacClass(VDAC_TypeDef *vdac_peripheral, PinName ch0_pin, PinName ch1_p
   auto_deinit(true),
   write_resolution(8),
   dac_max_value(255),
-  voltage_ref(vdacRef1V25)
+  voltage_ref(vdacRef1V25),
+  waveform_timer(waveform_timer),
+  waveform_playing(false),
+  waveform_channel(0u),
+  waveform_mode(DAC_WAVEFORM_ONESHOT),
+  waveform_buffer_idx(0u),
+  waveform_dma_channel(0u),
+  user_onplayback_finished_callback(nullptr)
 {
   this->vdac_peripheral = vdac_peripheral;
 }
@@ -54,6 +74,11 @@ void DacClass::set_output(uint8_t channel_num, uint32_t value)
     return;
   }
 
+  // Writing the channel directly stops the ongoing waveform playback on it
+  if (this->waveform_playing && this->waveform_channel == channel_num) {
+    this->waveform_stop();
+  }
+
   if (value == 0 && this->auto_deinit) {
     this->deinit(channel_num);
     return;
@@ -176,6 +201,11 @@ void DacClass::deinit(uint8_t channel_num)
     return;
   }
 
+  // Stop the waveform playback on the channel
+  if (this->waveform_playing && this->waveform_channel == channel_num) {
+    this->waveform_stop();
+  }
+
   // Reset the whole hardware - we don't have the means to deinitialize a separate channel
   // The other channel which is still enabled will jump to 0V for a brief moment while it's reinitialized
   VDAC_Reset(this->vdac_peripheral);
@@ -239,12 +269,237 @@ void DacClass::set_voltage_reference(dac_voltage_ref_t reference)
   }
 }
 
+sl_status_t DacClass::waveform_start(uint8_t channel_num,
+                                     const uint16_t *buffer,
+                                     uint32_t size,
+                                     uint32_t sample_rate,
+                                     dac_waveform_mode_t mode,
+                                     void (*user_onplayback_finished_callback)(uint8_t))
+{
+  if (channel_num > 1 || buffer == nullptr || size == 0u || size > LDMA_DESCRIPTOR_MAX_XFER_SIZE) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (mode != DAC_WAVEFORM_ONESHOT && mode != DAC_WAVEFORM_LOOP) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  this->waveform_stop();
+
+  volatile uint32_t *dac_data_reg = (channel_num == 0) ? &this->vdac_peripheral->CH0F : &this->vdac_peripheral->CH1F;
+
+  #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+  if (mode == DAC_WAVEFORM_ONESHOT) {
+    this->waveform_descriptors[0] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(buffer, dac_data_reg, size);
+  } else {
+    // Link the descriptor to itself for continuous playback
+    this->waveform_descriptors[0] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(buffer, dac_data_reg, size, 0);
+    // Only interrupt at the end of the buffer if someone is interested
+    this->waveform_descriptors[0].xfer.doneIfs = (user_onplayback_finished_callback != nullptr);
+  }
+  // Move one 12 bit sample per transfer
+  this->waveform_descriptors[0].xfer.size = ldmaCtrlSizeHalf;
+
+  this->waveform_mode = mode;
+  this->user_onplayback_finished_callback = user_onplayback_finished_callback;
+  return this->waveform_init(channel_num, sample_rate);
+}
+
+sl_status_t DacClass::waveform_start_pingpong(uint8_t channel_num,
+                                              const uint16_t *buffer0,
+                                              const uint16_t *buffer1,
+                                              uint32_t size,
+                                              uint32_t sample_rate,
+                                              void (*user_onplayback_finished_callback)(uint8_t))
+{
+  if (channel_num > 1 || buffer0 == nullptr || buffer1 == nullptr || size == 0u || size > LDMA_DESCRIPTOR_MAX_XFER_SIZE) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  this->waveform_stop();
+
+  volatile uint32_t *dac_data_reg = (channel_num == 0) ? &this->vdac_peripheral->CH0F : &this->vdac_peripheral->CH1F;
+
+  // Link the two descriptors to each other - each one interrupts when its buffer is finished
+  #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+  this->waveform_descriptors[0] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(buffer0, dac_data_reg, size, 1);
+  this->waveform_descriptors[1] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(buffer1, dac_data_reg, size, -1);
+  this->waveform_descriptors[0].xfer.size = ldmaCtrlSizeHalf;
+  this->waveform_descriptors[1].xfer.size = ldmaCtrlSizeHalf;
+
+  this->waveform_mode = DAC_WAVEFORM_PINGPONG;
+  this->user_onplayback_finished_callback = user_onplayback_finished_callback;
+  return this->waveform_init(channel_num, sample_rate);
+}
+
+sl_status_t DacClass::waveform_init(uint8_t channel_num, uint32_t sample_rate)
+{
+  if (sample_rate == 0u || sample_rate > this->waveform_max_sample_rate) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  // Keep the PWM from allocating channels on the timer - fail if it's already generating PWM
+  if (!PWM.reserve_timer(this->waveform_timer)) {
+    return SL_STATUS_BUSY;
+  }
+
+  // Make sure the DAC channel is up and running
+  this->init(channel_num);
+
+  CMU_Clock_TypeDef timer_clock = get_timer_clock(this->waveform_timer);
+  CMU_ClockEnable(timer_clock, true);
+
+  // Calculate the prescaler and the top value resulting in the requested sample rate
+  // The range is computed in 64 bits - it doesn't fit 32 bits on the 32-bit timers
+  uint32_t ticks_per_sample = CMU_ClockFreqGet(timer_clock) / sample_rate;
+  uint64_t timer_range = (uint64_t)TIMER_MaxCount(this->waveform_timer) + 1u;
+  uint32_t prescale = (ticks_per_sample > 0u) ? (uint32_t)((ticks_per_sample - 1u) / timer_range) : 0u;
+  if (ticks_per_sample == 0u || prescale > (uint32_t)timerPrescale1024) {
+    PWM.release_timer(this->waveform_timer);
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  uint32_t top = ticks_per_sample / (prescale + 1u) - 1u;
+
+  TIMER_Init_TypeDef timer_init = TIMER_INIT_DEFAULT;
+  timer_init.enable = false;
+  timer_init.prescale = (TIMER_Prescale_TypeDef)prescale;
+  TIMER_Init(this->waveform_timer, &timer_init);
+  TIMER_TopSet(this->waveform_timer, top);
+
+  // Initialize DMA with default parameters
+  DMADRV_Init();
+
+  // Allocate DMA channel
+  if (DMADRV_AllocateChannel(&this->waveform_dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK) {
+    TIMER_Reset(this->waveform_timer);
+    PWM.release_timer(this->waveform_timer);
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  // Require at least EM1 to keep the timer peripheral running
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+
+  this->waveform_channel = channel_num;
+  this->waveform_buffer_idx = 0u;
+  this->waveform_playing = true;
+
+  // Move the next sample to the DAC on every timer overflow
+  LDMA_TransferCfg_t transfer_cfg = LDMA_TRANSFER_CFG_PERIPHERAL(get_timer_overflow_dma_signal(this->waveform_timer));
+  DMADRV_LdmaStartTransfer((int)this->waveform_dma_channel, &transfer_cfg, &this->waveform_descriptors[0], waveform_dma_transfer_finished_cb, this);
+
+  TIMER_Enable(this->waveform_timer, true);
+  return SL_STATUS_OK;
+}
+
+void DacClass::waveform_stop()
+{
+  if (!this->waveform_playing) {
+    return;
+  }
+
+  // Stop the timer first so no more requests are generated
+  TIMER_Reset(this->waveform_timer);
+  DMADRV_StopTransfer(this->waveform_dma_channel);
+  DMADRV_FreeChannel(this->waveform_dma_channel);
+  PWM.release_timer(this->waveform_timer);
+
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  // Remove the energy mode requirement
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+
+  this->waveform_playing = false;
+}
+
+bool DacClass::waveform_is_playing()
+{
+  return this->waveform_playing;
+}
+
+void DacClass::handle_waveform_dma_callback()
+{
+  uint8_t finished_buffer_idx = this->waveform_buffer_idx;
+
+  if (this->waveform_mode == DAC_WAVEFORM_PINGPONG) {
+    this->waveform_buffer_idx ^= 1u;
+  } else if (this->waveform_mode == DAC_WAVEFORM_ONESHOT) {
+    // The last sample stays on the output
+    this->waveform_stop();
+  }
+
+  if (!this->user_onplayback_finished_callback) {
+    return;
+  }
+  this->user_onplayback_finished_callback(finished_buffer_idx);
+}
+
+bool waveform_dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+
+  DacClass *dac = static_cast<DacClass*>(userParam);
+  dac->handle_waveform_dma_callback();
+  return true;
+}
+
+CMU_Clock_TypeDef get_timer_clock(TIMER_TypeDef *timer)
+{
+  #if defined(TIMER1)
+  if (timer == TIMER1) {
+    return cmuClock_TIMER1;
+  }
+  #endif // TIMER1
+  #if defined(TIMER2)
+  if (timer == TIMER2) {
+    return cmuClock_TIMER2;
+  }
+  #endif // TIMER2
+  #if defined(TIMER3)
+  if (timer == TIMER3) {
+    return cmuClock_TIMER3;
+  }
+  #endif // TIMER3
+  #if defined(TIMER4)
+  if (timer == TIMER4) {
+    return cmuClock_TIMER4;
+  }
+  #endif // TIMER4
+  return cmuClock_TIMER0;
+}
+
+LDMA_PeripheralSignal_t get_timer_overflow_dma_signal(TIMER_TypeDef *timer)
+{
+  #if defined(TIMER1)
+  if (timer == TIMER1) {
+    return ldmaPeripheralSignal_TIMER1_UFOF;
+  }
+  #endif // TIMER1
+  #if defined(TIMER2)
+  if (timer == TIMER2) {
+    return ldmaPeripheralSignal_TIMER2_UFOF;
+  }
+  #endif // TIMER2
+  #if defined(TIMER3)
+  if (timer == TIMER3) {
+    return ldmaPeripheralSignal_TIMER3_UFOF;
+  }
+  #endif // TIMER3
+  #if defined(TIMER4)
+  if (timer == TIMER4) {
+    return ldmaPeripheralSignal_TIMER4_UFOF;
+  }
+  #endif // TIMER4
+  return ldmaPeripheralSignal_TIMER0_UFOF;
+}
+
 #if (NUM_DAC_HW > 0)
-arduino::DacClass DAC_0(VDAC0, SL_DAC0_CH0_PIN, SL_DAC0_CH1_PIN);
+arduino::DacClass DAC_0(VDAC0, SL_DAC0_CH0_PIN, SL_DAC0_CH1_PIN, SL_DAC0_WAVEFORM_TIMER);
 #endif
 
 #if (NUM_DAC_HW > 1)
-arduino::DacClass DAC_1(VDAC1, SL_DAC1_CH0_PIN, SL_DAC1_CH1_PIN);
+arduino::DacClass DAC_1(VDAC1, SL_DAC1_CH0_PIN, SL_DAC1_CH1_PIN, SL_DAC1_WAVEFORM_TIMER);
 #endif
 
 #endif // NUM_DAC_HW
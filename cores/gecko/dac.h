@@ -33,6 +33,14 @@
 
 #include "em_cmu.h"
 #include "em_vdac.h"
+#include "em_timer.h"
+#include "em_ldma.h"
+#include "dmadrv.h"
+#include "sl_status.h"
+
+extern "C" {
+  #include "sl_power_manager.h"
+}
 
 enum dac_voltage_ref_t {
   DAC_VREF_1V25 = 0,          // 1.25V
@@ -41,6 +49,12 @@ enum dac_voltage_ref_t {
   DAC_VREF_EXTERNAL_PIN       // External VREF pin (PA00 if available)
 };
 
+enum dac_waveform_mode_t {
+  DAC_WAVEFORM_ONESHOT = 0,   // Play the buffer once, then hold the last sample
+  DAC_WAVEFORM_LOOP,          // Play the buffer continuously
+  DAC_WAVEFORM_PINGPONG       // Alternate between two buffers - the finished one can be refilled in the callback
+};
+
 namespace arduino {
 class DacClass {
 public:
@@ -52,8 +66,9 @@ public:
    * @param[in] vdac_peripheral The DAC peripheral to be used
    * @param[in] ch0_pin The output pin for channel 0
    * @param[in] ch1_pin The output pin for channel 1
+   * @param[in] waveform_timer The timer pacing the waveform playback
    ******************************************************************************/
-  DacClass(VDAC_TypeDef* vdac_peripheral, PinName ch0_pin, PinName ch1_pin);
+  DacClass(VDAC_TypeDef* vdac_peripheral, PinName ch0_pin, PinName ch1_pin, TIMER_TypeDef* waveform_timer);
 
   /***************************************************************************//**
    * Sets the specified DAC channel's output to the desired value
@@ -110,6 +125,78 @@ public:
    ******************************************************************************/
   void set_voltage_reference(dac_voltage_ref_t reference);
 
+  /***************************************************************************//**
+   * Starts playing a waveform on the specified DAC channel
+   * The samples are fed to the DAC by LDMA on every overflow of the waveform
+   * timer - the CPU is not involved in the playback.
+   * The samples are always 12 bit (0-4095) regardless of the write resolution.
+   * The buffer must remain valid until the playback finishes or gets stopped.
+   * Only one waveform can be played at a time on a DAC peripheral.
+   * The waveform timer is taken from the PWM for the duration of the playback,
+   * SL_STATUS_BUSY is returned if the PWM is using it.
+   *
+   * @param[in] channel_num the DAC channel to play the waveform on
+   * @param[in] buffer the samples to play
+   * @param[in] size the number of samples in the buffer
+   * @param[in] sample_rate the playback rate in samples per second
+   * @param[in] mode DAC_WAVEFORM_ONESHOT or DAC_WAVEFORM_LOOP
+   * @param[in] user_onplayback_finished_callback Callback that gets called from
+   *            interrupt context each time the end of the buffer is reached
+   *            (optional)
+   *
+   * @return Status of the waveform init process
+   ******************************************************************************/
+  sl_status_t waveform_start(uint8_t channel_num,
+                             const uint16_t* buffer,
+                             uint32_t size,
+                             uint32_t sample_rate,
+                             dac_waveform_mode_t mode,
+                             void (*user_onplayback_finished_callback)(uint8_t) = nullptr);
+
+  /***************************************************************************//**
+   * Starts streaming samples from two alternating buffers on the specified DAC channel
+   * While one buffer is being played the other one can be refilled. The callback
+   * receives the index (0 or 1) of the buffer that has just finished playing
+   * and is free to be refilled.
+   *
+   * @param[in] channel_num the DAC channel to play the waveform on
+   * @param[in] buffer0 the first buffer to play
+   * @param[in] buffer1 the second buffer to play
+   * @param[in] size the number of samples in each buffer
+   * @param[in] sample_rate the playback rate in samples per second
+   * @param[in] user_onplayback_finished_callback Callback that gets called from
+   *            interrupt context when a buffer finished playing
+   *
+   * @return Status of the waveform init process
+   ******************************************************************************/
+  sl_status_t waveform_start_pingpong(uint8_t channel_num,
+                                      const uint16_t* buffer0,
+                                      const uint16_t* buffer1,
+                                      uint32_t size,
+                                      uint32_t sample_rate,
+                                      void (*user_onplayback_finished_callback)(uint8_t));
+
+  /***************************************************************************//**
+   * Stops the ongoing waveform playback
+   * The channel keeps outputting the last played sample.
+   ******************************************************************************/
+  void waveform_stop();
+
+  /***************************************************************************//**
+   * Returns whether a waveform is being played
+   *
+   * @return true if a waveform is being played, false otherwise
+   ******************************************************************************/
+  bool waveform_is_playing();
+
+  /***************************************************************************//**
+   * Callback handler for the waveform DMA transfer
+   ******************************************************************************/
+  void handle_waveform_dma_callback();
+
+  // The maximum waveform sample rate
+  static const uint32_t waveform_max_sample_rate = 500000u;
+
 private:
   /***************************************************************************//**
    * Initializes a specific channel of the DAC hardware
@@ -118,6 +205,16 @@ private:
    ******************************************************************************/
   void init_channel(uint8_t channel_num);
 
+  /***************************************************************************//**
+   * Sets up the waveform timer and starts the DMA transfer of the prepared descriptors
+   *
+   * @param[in] channel_num the DAC channel to play the waveform on
+   * @param[in] sample_rate the playback rate in samples per second
+   *
+   * @return Status of the waveform init process
+   ******************************************************************************/
+  sl_status_t waveform_init(uint8_t channel_num, uint32_t sample_rate);
+
   bool dac_initialized;
   PinName ch0_pin;
   PinName ch1_pin;
@@ -131,6 +228,15 @@ private:
   uint32_t dac_max_value;
   VDAC_Ref_TypeDef voltage_ref;
 
+  TIMER_TypeDef* waveform_timer;
+  bool waveform_playing;
+  uint8_t waveform_channel;
+  dac_waveform_mode_t waveform_mode;
+  uint8_t waveform_buffer_idx;
+  unsigned int waveform_dma_channel;
+  LDMA_Descriptor_t waveform_descriptors[2];
+  void (*user_onplayback_finished_callback)(uint8_t);
+
   // VDAC to max frequency (1 MHz)
   static const uint32_t vdac_max_freq = 1000000u;
   // The DAC has a 12 bit resolution - the max accepted value is 4095
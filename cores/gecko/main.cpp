@@ -88,11 +88,9 @@ void arduino_task(void *p_arg)
 
 inline static void handle_serial_events()
 {
-  Serial.task();
   Serial.handleSerialEvent();
 
   #if (NUM_HW_SERIAL > 1)
-  Serial1.task();
   Serial1.handleSerialEvent();
   #endif // #if (NUM_HW_SERIAL > 1)
 }
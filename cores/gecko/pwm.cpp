@@ -28,188 +28,774 @@
 
 using namespace arduino;
 
+static bool sequence_dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam);
+
 PwmClass::PwmClass() :
-  pwm_mode(pwm_mode_t::DUTY_CYCLE),
+  pwm_timers{
+    { TIMER0, cmuClock_TIMER0, ldmaPeripheralSignal_TIMER0_UFOF },
+    { TIMER1, cmuClock_TIMER1, ldmaPeripheralSignal_TIMER1_UFOF },
+    { TIMER2, cmuClock_TIMER2, ldmaPeripheralSignal_TIMER2_UFOF },
+    { TIMER3, cmuClock_TIMER3, ldmaPeripheralSignal_TIMER3_UFOF },
+    { TIMER4, cmuClock_TIMER4, ldmaPeripheralSignal_TIMER4_UFOF }
+  },
   auto_deinit(true),
   pwm_mutex(nullptr),
-  duty_cycle_set_time(0u),
   duty_cycle_mode_write_resolution(8),
   duty_cycle_mode_max_value(255)
 {
-  pwm_config = {
-    .frequency = this->duty_cycle_mode_default_freq,
-    .polarity  = PWM_ACTIVE_HIGH,
-  };
+  for (auto& pwm_timer : pwm_timers) {
+    pwm_timer.mode = pwm_mode_t::DUTY_CYCLE;
+    pwm_timer.frequency = 0u;
+    pwm_timer.top = 0u;
+    pwm_timer.reserved = false;
+    pwm_timer.sequence_running = false;
+    pwm_timer.sequence_cc_channel = 0u;
+    pwm_timer.sequence_mode = PWM_SEQUENCE_ONESHOT;
+    pwm_timer.sequence_buffer_idx = 0u;
+    pwm_timer.sequence_dma_channel = 0u;
+    pwm_timer.user_onsequence_finished_callback = nullptr;
+  }
 
   for (auto& pwm_pin : pwm_pins) {
     pwm_pin.pin = PIN_NAME_MAX;
-    pwm_pin.inst.timer = TIMER0;
-    pwm_pin.inst.channel = 0;
-    pwm_pin.inst.port = gpioPortA;
-    pwm_pin.inst.pin = 0;
-    pwm_pin.inst.location = 0;
+    pwm_pin.value = 0u;
+    pwm_pin.max_value = 0u;
   }
+  memset(this->pin_write_resolution, 0u, sizeof(this->pin_write_resolution));
 
   this->pwm_mutex = xSemaphoreCreateMutexStatic(&this->pwm_mutex_buf);
   configASSERT(this->pwm_mutex);
 }
 
-bool PwmClass::init(PinName pin, int frequency)
+bool PwmClass::duty_cycle_mode(PinName pin, int duty_cycle)
 {
-  uint8_t pwm_channel_idx = get_next_free_pwm_channel_idx();
-  if (pwm_channel_idx == UINT8_MAX) {
-    // No more free PWM channels available
+  if (duty_cycle < 0 || pin >= PIN_NAME_MAX) {
     return false;
   }
 
-  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
-  // Require at least EM1 to keep the timer peripheral running
-  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
-  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+
+  // If the pin is generating a tone - stop it first
+  uint8_t pwm_channel_idx = get_pwm_channel_idx_for_pin(pin);
+  if (pwm_channel_idx != UINT8_MAX && this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].mode != pwm_mode_t::DUTY_CYCLE) {
+    this->release_pwm_channel(pwm_channel_idx);
+    pwm_channel_idx = UINT8_MAX;
+  }
+  // Writing the duty cycle takes over from a running sequence
+  if (pwm_channel_idx != UINT8_MAX) {
+    this->stop_sequence_on_channel(pwm_channel_idx);
+  }
 
-  this->pwm_pins[pwm_channel_idx].pin = pin;
-  this->pwm_pins[pwm_channel_idx].duty_cycle_percent = 101;
-  this->pwm_pins[pwm_channel_idx].inst.port = getSilabsPortFromArduinoPin(pin);
-  this->pwm_pins[pwm_channel_idx].inst.pin = getSilabsPinFromArduinoPin(pin);
-  this->pwm_pins[pwm_channel_idx].inst.channel = pwm_channel_idx;
+  // Initialize PWM if the pin doesn't have an initialized instance
+  if (pwm_channel_idx == UINT8_MAX) {
+    pwm_channel_idx = this->allocate_pwm_channel(pin, pwm_mode_t::DUTY_CYCLE, this->duty_cycle_mode_default_freq);
+    // Return if PWM could not be initialized
+    if (pwm_channel_idx == UINT8_MAX) {
+      xSemaphoreGive(this->pwm_mutex);
+      return false;
+    }
+  }
 
-  GPIO_PinModeSet(this->pwm_pins[pwm_channel_idx].inst.port, this->pwm_pins[pwm_channel_idx].inst.pin, gpioModePushPull, 0);
-  pwm_config.frequency = frequency;
-  sl_pwm_init(&this->pwm_pins[pwm_channel_idx].inst, &pwm_config);
-  sl_pwm_start(&this->pwm_pins[pwm_channel_idx].inst);
+  if ((uint32_t)duty_cycle > this->get_max_value(pwm_channel_idx)) {
+    xSemaphoreGive(this->pwm_mutex);
+    return false;
+  }
+
+  // Stop the PWM on 0 duty cycle (if auto deinit is enabled), set the requested duty cycle otherwise
+  if (duty_cycle == 0 && this->auto_deinit) {
+    this->release_pwm_channel(pwm_channel_idx);
+  } else {
+    // Arduino passes the duty cycle as a number from 0 to the configured write resolution's max (255 by default).
+    // Scale it to the timer period without losing precision.
+    // The new value is buffered and takes effect at the start of the next period - no glitches, no waiting.
+    this->pwm_pins[pwm_channel_idx].value = (uint32_t)duty_cycle;
+    TIMER_CompareBufSet(this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].timer,
+                        pwm_channel_idx % cc_channels_per_timer,
+                        this->get_compare_value(pwm_channel_idx, (uint32_t)duty_cycle));
+  }
+
+  xSemaphoreGive(this->pwm_mutex);
   return true;
 }
 
-void PwmClass::duty_cycle_mode(PinName pin, int duty_cycle)
+bool PwmClass::duty_cycle_mode_batch(const PinName* pins, const int* duty_cycles, uint8_t count)
 {
-  if (duty_cycle < 0 || duty_cycle > (int)this->duty_cycle_mode_max_value || pin >= PIN_NAME_MAX) {
-    return;
+  if (pins == nullptr || duty_cycles == nullptr || count == 0u || count > this->max_pwm_channels) {
+    return false;
   }
-
-  // If the previous duty cycle setting was within the stabilization time - we wait for the stabilization time to elapse
-  // If different channels's duty cycles are set in quick succession they won't take effect - therefore we have to wait in between
-  while (millis() < this->duty_cycle_set_time + this->pwm_stabilization_time_ms) {
-    yield();
+  for (uint8_t i = 0; i < count; i++) {
+    if (pins[i] >= PIN_NAME_MAX || duty_cycles[i] < 0) {
+      return false;
+    }
   }
 
   xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
 
-  // If the PWM was running in a different mode before - deinitialize it
-  if (this->pwm_mode != pwm_mode_t::DUTY_CYCLE) {
-    deinit_all_pwm_channels();
-    this->pwm_mode = pwm_mode_t::DUTY_CYCLE;
+  // Start the pins which are not active yet
+  uint8_t pwm_channel_idxs[max_pwm_channels];
+  for (uint8_t i = 0; i < count; i++) {
+    pwm_channel_idxs[i] = get_pwm_channel_idx_for_pin(pins[i]);
+    if (pwm_channel_idxs[i] != UINT8_MAX && this->pwm_timers[pwm_channel_idxs[i] / cc_channels_per_timer].mode != pwm_mode_t::DUTY_CYCLE) {
+      this->release_pwm_channel(pwm_channel_idxs[i]);
+      pwm_channel_idxs[i] = UINT8_MAX;
+    }
+    if (pwm_channel_idxs[i] != UINT8_MAX) {
+      this->stop_sequence_on_channel(pwm_channel_idxs[i]);
+    }
+    if (pwm_channel_idxs[i] == UINT8_MAX) {
+      pwm_channel_idxs[i] = this->allocate_pwm_channel(pins[i], pwm_mode_t::DUTY_CYCLE, this->duty_cycle_mode_default_freq);
+      if (pwm_channel_idxs[i] == UINT8_MAX) {
+        xSemaphoreGive(this->pwm_mutex);
+        return false;
+      }
+    }
   }
 
-  // Initialize PWM if the pin doesn't have an initialized instance
-  if (get_pwm_channel_idx_for_pin(pin) == UINT8_MAX) {
-    bool res = this->init(pin, this->duty_cycle_mode_default_freq);
-    // Return if PWM could not be initialized
-    if (!res) {
+  // Calculate all the compare values before touching the timers
+  uint32_t compare_values[max_pwm_channels];
+  for (uint8_t i = 0; i < count; i++) {
+    if ((uint32_t)duty_cycles[i] > this->get_max_value(pwm_channel_idxs[i])) {
       xSemaphoreGive(this->pwm_mutex);
-      return;
+      return false;
     }
+    compare_values[i] = this->get_compare_value(pwm_channel_idxs[i], (uint32_t)duty_cycles[i]);
   }
-  // Calculate the duty cycle percent from the provided value
-  // Arduino passes the duty cycle as a number from 0 to the configured write resolution's max (255 by default).
-  // We need the duty cycle to be expressed as a number from 0-100.
-  int duty_cycle_percent = duty_cycle * 100 / this->duty_cycle_mode_max_value;
+
+  // Write the values of each timer in the same period - they take effect together on the next overflow
+  for (uint8_t timer_idx = 0; timer_idx < this->max_pwm_timers; timer_idx++) {
+    uint8_t num_of_writes = 0u;
+    for (uint8_t i = 0; i < count; i++) {
+      if (pwm_channel_idxs[i] / cc_channels_per_timer == timer_idx) {
+        num_of_writes++;
+      }
+    }
+    if (num_of_writes == 0u) {
+      continue;
+    }
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    this->wait_for_buffered_update_window(timer_idx, num_of_writes);
+    for (uint8_t i = 0; i < count; i++) {
+      if (pwm_channel_idxs[i] / cc_channels_per_timer == timer_idx) {
+        TIMER_CompareBufSet(this->pwm_timers[timer_idx].timer, pwm_channel_idxs[i] % cc_channels_per_timer, compare_values[i]);
+      }
+    }
+    CORE_EXIT_CRITICAL();
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    this->pwm_pins[pwm_channel_idxs[i]].value = (uint32_t)duty_cycles[i];
+  }
+
+  xSemaphoreGive(this->pwm_mutex);
+  return true;
+}
+
+bool PwmClass::frequency_mode(PinName pin, int frequency)
+{
+  if (pin >= PIN_NAME_MAX || frequency < 0) {
+    return false;
+  }
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
 
   uint8_t pwm_channel_idx = get_pwm_channel_idx_for_pin(pin);
-  // Don't change anything if the requested duty cycle is the same as the currently set
-  if (this->pwm_pins[pwm_channel_idx].duty_cycle_percent == (uint8_t)duty_cycle_percent) {
+  // Stop waveform generation if the frequency is zero
+  if (frequency == 0) {
+    if (pwm_channel_idx != UINT8_MAX) {
+      this->release_pwm_channel(pwm_channel_idx);
+    }
     xSemaphoreGive(this->pwm_mutex);
-    return;
+    return true;
   }
-  this->pwm_pins[pwm_channel_idx].duty_cycle_percent = (uint8_t)duty_cycle_percent;
 
-  // Stop the PWM on 0 duty cycle (if auto deinit is enabled), set the requested duty cycle otherwise
-  if (duty_cycle_percent == 0 && this->auto_deinit) {
-    this->stop(pin);
+  bool res = true;
+  if (pwm_channel_idx != UINT8_MAX && this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].mode == pwm_mode_t::FREQUENCY) {
+    // The pin is already generating a tone - change the frequency of its timer
+    res = this->set_timer_frequency(pwm_channel_idx / cc_channels_per_timer, (uint32_t)frequency);
   } else {
-    sl_pwm_set_duty_cycle(&this->pwm_pins[pwm_channel_idx].inst, (uint8_t)duty_cycle_percent);
-    this->duty_cycle_set_time = millis();
+    // The pin is running in duty cycle mode - move it to a timer on its own
+    if (pwm_channel_idx != UINT8_MAX) {
+      this->release_pwm_channel(pwm_channel_idx);
+    }
+    pwm_channel_idx = this->allocate_pwm_channel(pin, pwm_mode_t::FREQUENCY, (uint32_t)frequency);
+    res = (pwm_channel_idx != UINT8_MAX);
   }
+  if (!res) {
+    xSemaphoreGive(this->pwm_mutex);
+    return false;
+  }
+
+  // Arduino requires a 50% duty cycle in tone mode
+  this->pwm_pins[pwm_channel_idx].value = 1u;
+  this->pwm_pins[pwm_channel_idx].max_value = 2u;
+  TIMER_CompareBufSet(this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].timer,
+                      pwm_channel_idx % cc_channels_per_timer,
+                      this->get_compare_value(pwm_channel_idx, 1u));
 
   xSemaphoreGive(this->pwm_mutex);
+  return true;
+}
+
+void PwmClass::stop(PinName pin)
+{
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  if (pwm_channel_idx != UINT8_MAX) {
+    this->release_pwm_channel(pwm_channel_idx);
+  }
+  xSemaphoreGive(this->pwm_mutex);
 }
 
-void PwmClass::frequency_mode(PinName pin, int frequency)
+void PwmClass::duty_cycle_mode_set_write_resolution(uint8_t resolution)
 {
-  // Frequency mode handles only one channel
-  if (pin >= PIN_NAME_MAX) {
+  if (resolution < 1 || resolution > this->duty_cycle_mode_write_resolution_max) {
     return;
   }
+  this->duty_cycle_mode_write_resolution = resolution;
+  this->duty_cycle_mode_max_value = (1u << this->duty_cycle_mode_write_resolution) - 1u;
+}
+
+bool PwmClass::duty_cycle_mode_set_write_resolution(PinName pin, uint8_t resolution)
+{
+  if (pin >= PIN_NAME_MAX || resolution < 1 || resolution > this->duty_cycle_mode_write_resolution_max) {
+    return false;
+  }
   xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  // The resolution is not applicable for tones
+  if (pwm_channel_idx != UINT8_MAX && this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].mode != pwm_mode_t::DUTY_CYCLE) {
+    xSemaphoreGive(this->pwm_mutex);
+    return false;
+  }
+  // Start the pin at 0% duty cycle if it's not active yet
+  if (pwm_channel_idx == UINT8_MAX) {
+    pwm_channel_idx = this->allocate_pwm_channel(pin, pwm_mode_t::DUTY_CYCLE, this->duty_cycle_mode_default_freq);
+    if (pwm_channel_idx == UINT8_MAX) {
+      xSemaphoreGive(this->pwm_mutex);
+      return false;
+    }
+  }
+  pwm_pin_t* pwm_pin = &this->pwm_pins[pwm_channel_idx];
+  uint32_t old_max_value = this->get_max_value(pwm_channel_idx);
+  pwm_pin->max_value = (1u << resolution) - 1u;
+  this->pin_write_resolution[pin] = resolution;
+  // Keep the current duty cycle in the new resolution
+  pwm_pin->value = (uint32_t)(((uint64_t)pwm_pin->value * pwm_pin->max_value) / old_max_value);
+  xSemaphoreGive(this->pwm_mutex);
+  return true;
+}
 
-  // If the PWM was running in a different mode before - deinitialize it
-  if (this->pwm_mode != pwm_mode_t::FREQUENCY) {
-    deinit_all_pwm_channels();
+bool PwmClass::duty_cycle_mode_set_frequency(PinName pin, uint32_t frequency)
+{
+  if (pin >= PIN_NAME_MAX || frequency == 0u) {
+    return false;
   }
-  this->pwm_mode = pwm_mode_t::FREQUENCY;
-  // Stop waveform generation if the frequency is zero
-  if (frequency == 0) {
-    this->stop(pin);
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  // Tones have their frequency set by 'frequency_mode()'
+  if (pwm_channel_idx != UINT8_MAX && this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].mode != pwm_mode_t::DUTY_CYCLE) {
     xSemaphoreGive(this->pwm_mutex);
-    return;
+    return false;
   }
-  // Initialize PWM with the requested frequency
-  if (!this->init(pin, frequency)) {
+
+  bool res = true;
+  if (pwm_channel_idx == UINT8_MAX) {
+    // Start the pin at 0% duty cycle with the requested frequency
+    res = (this->allocate_pwm_channel(pin, pwm_mode_t::DUTY_CYCLE, frequency) != UINT8_MAX);
+  } else {
+    uint8_t timer_idx = pwm_channel_idx / cc_channels_per_timer;
+    if (this->pwm_timers[timer_idx].frequency == frequency) {
+      // Nothing to do
+    } else if (this->get_num_of_pwm_channels_in_use(timer_idx) == 1u) {
+      // The pin has the timer for itself - change the frequency of the timer
+      res = this->set_timer_frequency(timer_idx, frequency);
+    } else if (this->find_timer_for_channel(pwm_mode_t::DUTY_CYCLE, frequency) == UINT8_MAX) {
+      // There's no timer available at the new frequency - the pin stays where it is
+      res = false;
+    } else {
+      // Move the pin to a timer running at the requested frequency
+      pwm_pin_t old_pwm_pin = this->pwm_pins[pwm_channel_idx];
+      this->release_pwm_channel(pwm_channel_idx);
+      pwm_channel_idx = this->allocate_pwm_channel(pin, pwm_mode_t::DUTY_CYCLE, frequency);
+      if (pwm_channel_idx == UINT8_MAX) {
+        res = false;
+      } else {
+        this->pwm_pins[pwm_channel_idx].value = old_pwm_pin.value;
+        this->pwm_pins[pwm_channel_idx].max_value = old_pwm_pin.max_value;
+        TIMER_CompareBufSet(this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].timer,
+                            pwm_channel_idx % cc_channels_per_timer,
+                            this->get_compare_value(pwm_channel_idx, old_pwm_pin.value));
+      }
+    }
+  }
+  xSemaphoreGive(this->pwm_mutex);
+  return res;
+}
+
+void PwmClass::set_auto_deinit(bool auto_deinit)
+{
+  this->auto_deinit = auto_deinit;
+}
+
+uint32_t PwmClass::duty_cycle_to_compare_value(PinName pin, uint32_t duty_cycle)
+{
+  uint32_t compare_value = 0u;
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  if (pwm_channel_idx != UINT8_MAX) {
+    uint32_t max_value = this->get_max_value(pwm_channel_idx);
+    compare_value = this->get_compare_value(pwm_channel_idx, duty_cycle > max_value ? max_value : duty_cycle);
+  }
+  xSemaphoreGive(this->pwm_mutex);
+  return compare_value;
+}
+
+sl_status_t PwmClass::sequence_start(PinName pin,
+                                     const uint32_t* buffer,
+                                     uint32_t size,
+                                     pwm_sequence_mode_t mode,
+                                     void (*user_onsequence_finished_callback)(PinName, uint8_t))
+{
+  if (buffer == nullptr || size == 0u || size > LDMA_DESCRIPTOR_MAX_XFER_SIZE) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (mode != PWM_SEQUENCE_ONESHOT && mode != PWM_SEQUENCE_LOOP) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  if (pwm_channel_idx == UINT8_MAX || this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].mode != pwm_mode_t::DUTY_CYCLE) {
     xSemaphoreGive(this->pwm_mutex);
-    return;
+    return SL_STATUS_INVALID_STATE;
   }
-  // Set the requested frequency
-  // Arduino requires a 50% duty cycle in tone mode
-  uint8_t pwm_channel_idx = get_pwm_channel_idx_for_pin(pin);
-  sl_pwm_set_duty_cycle(&this->pwm_pins[pwm_channel_idx].inst, 50);
+  pwm_timer_t* pwm_timer = &this->pwm_timers[pwm_channel_idx / cc_channels_per_timer];
+  volatile uint32_t* compare_buf_reg = &pwm_timer->timer->CC[pwm_channel_idx % cc_channels_per_timer].OCB;
 
+  // Restarting on the same pin is fine - another pin on the same timer is not
+  if (pwm_timer->sequence_running && pwm_timer->sequence_cc_channel != pwm_channel_idx % cc_channels_per_timer) {
+    xSemaphoreGive(this->pwm_mutex);
+    return SL_STATUS_BUSY;
+  }
+  this->stop_sequence(pwm_channel_idx / cc_channels_per_timer);
+
+  #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+  if (mode == PWM_SEQUENCE_ONESHOT) {
+    pwm_timer->sequence_descriptors[0] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(buffer, compare_buf_reg, size);
+  } else {
+    // Link the descriptor to itself for continuous playback
+    pwm_timer->sequence_descriptors[0] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(buffer, compare_buf_reg, size, 0);
+    // Only interrupt at the end of the buffer if someone is interested
+    pwm_timer->sequence_descriptors[0].xfer.doneIfs = (user_onsequence_finished_callback != nullptr);
+  }
+  // Move one compare value per transfer
+  pwm_timer->sequence_descriptors[0].xfer.size = ldmaCtrlSizeWord;
+
+  pwm_timer->sequence_mode = mode;
+  pwm_timer->user_onsequence_finished_callback = user_onsequence_finished_callback;
+  sl_status_t status = this->sequence_init(pwm_channel_idx);
   xSemaphoreGive(this->pwm_mutex);
+  return status;
 }
 
-void PwmClass::stop(PinName pin)
+sl_status_t PwmClass::sequence_start_pingpong(PinName pin,
+                                              const uint32_t* buffer0,
+                                              const uint32_t* buffer1,
+                                              uint32_t size,
+                                              void (*user_onsequence_finished_callback)(PinName, uint8_t))
+{
+  if (buffer0 == nullptr || buffer1 == nullptr || size == 0u || size > LDMA_DESCRIPTOR_MAX_XFER_SIZE) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  if (pwm_channel_idx == UINT8_MAX || this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].mode != pwm_mode_t::DUTY_CYCLE) {
+    xSemaphoreGive(this->pwm_mutex);
+    return SL_STATUS_INVALID_STATE;
+  }
+  pwm_timer_t* pwm_timer = &this->pwm_timers[pwm_channel_idx / cc_channels_per_timer];
+  volatile uint32_t* compare_buf_reg = &pwm_timer->timer->CC[pwm_channel_idx % cc_channels_per_timer].OCB;
+
+  // Restarting on the same pin is fine - another pin on the same timer is not
+  if (pwm_timer->sequence_running && pwm_timer->sequence_cc_channel != pwm_channel_idx % cc_channels_per_timer) {
+    xSemaphoreGive(this->pwm_mutex);
+    return SL_STATUS_BUSY;
+  }
+  this->stop_sequence(pwm_channel_idx / cc_channels_per_timer);
+
+  // Link the two descriptors to each other - each one interrupts when its buffer is finished
+  #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+  pwm_timer->sequence_descriptors[0] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(buffer0, compare_buf_reg, size, 1);
+  pwm_timer->sequence_descriptors[1] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(buffer1, compare_buf_reg, size, -1);
+  pwm_timer->sequence_descriptors[0].xfer.size = ldmaCtrlSizeWord;
+  pwm_timer->sequence_descriptors[1].xfer.size = ldmaCtrlSizeWord;
+
+  pwm_timer->sequence_mode = PWM_SEQUENCE_PINGPONG;
+  pwm_timer->user_onsequence_finished_callback = user_onsequence_finished_callback;
+  sl_status_t status = this->sequence_init(pwm_channel_idx);
+  xSemaphoreGive(this->pwm_mutex);
+  return status;
+}
+
+sl_status_t PwmClass::sequence_init(uint8_t pwm_channel_idx)
+{
+  uint8_t timer_idx = pwm_channel_idx / cc_channels_per_timer;
+  pwm_timer_t* pwm_timer = &this->pwm_timers[timer_idx];
+
+  // Initialize DMA with default parameters
+  DMADRV_Init();
+
+  // Allocate DMA channel
+  if (DMADRV_AllocateChannel(&pwm_timer->sequence_dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  pwm_timer->sequence_cc_channel = pwm_channel_idx % cc_channels_per_timer;
+  pwm_timer->sequence_buffer_idx = 0u;
+  pwm_timer->sequence_running = true;
+
+  // Move the next compare value to the buffer register on every timer overflow
+  LDMA_TransferCfg_t transfer_cfg = LDMA_TRANSFER_CFG_PERIPHERAL(pwm_timer->dma_overflow_signal);
+  DMADRV_LdmaStartTransfer((int)pwm_timer->sequence_dma_channel,
+                           &transfer_cfg,
+                           &pwm_timer->sequence_descriptors[0],
+                           sequence_dma_transfer_finished_cb,
+                           (void*)(uintptr_t)timer_idx);
+  return SL_STATUS_OK;
+}
+
+void PwmClass::sequence_stop(PinName pin)
+{
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
+  if (pwm_channel_idx != UINT8_MAX) {
+    this->stop_sequence_on_channel(pwm_channel_idx);
+  }
+  xSemaphoreGive(this->pwm_mutex);
+}
+
+bool PwmClass::sequence_is_running(PinName pin)
 {
   uint8_t pwm_channel_idx = this->get_pwm_channel_idx_for_pin(pin);
   if (pwm_channel_idx == UINT8_MAX) {
-    return;
+    return false;
   }
-  sl_pwm_stop(&this->pwm_pins[pwm_channel_idx].inst);
+  pwm_timer_t* pwm_timer = &this->pwm_timers[pwm_channel_idx / cc_channels_per_timer];
+  return pwm_timer->sequence_running && pwm_timer->sequence_cc_channel == pwm_channel_idx % cc_channels_per_timer;
+}
 
-  // Deinit the PWM peripheral if there are no users left
-  if (this->get_num_of_pwm_channels_in_use() == 0) {
-    sl_pwm_deinit(&this->pwm_pins[pwm_channel_idx].inst);
+void PwmClass::handle_sequence_dma_callback(uint8_t timer_idx)
+{
+  pwm_timer_t* pwm_timer = &this->pwm_timers[timer_idx];
+  if (!pwm_timer->sequence_running) {
+    return;
+  }
+  uint8_t finished_buffer_idx = pwm_timer->sequence_buffer_idx;
+  PinName pin = this->pwm_pins[timer_idx * cc_channels_per_timer + pwm_timer->sequence_cc_channel].pin;
+  void (*user_onsequence_finished_callback)(PinName, uint8_t) = pwm_timer->user_onsequence_finished_callback;
 
-    #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
-    // Remove the energy mode requirement
-    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
-    #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  if (pwm_timer->sequence_mode == PWM_SEQUENCE_PINGPONG) {
+    pwm_timer->sequence_buffer_idx ^= 1u;
+  } else if (pwm_timer->sequence_mode == PWM_SEQUENCE_ONESHOT) {
+    // The last compare value stays on the output
+    this->stop_sequence(timer_idx);
   }
 
-  this->pwm_pins[pwm_channel_idx].pin = PIN_NAME_MAX;
+  if (user_onsequence_finished_callback) {
+    user_onsequence_finished_callback(pin, finished_buffer_idx);
+  }
 }
 
-void PwmClass::duty_cycle_mode_set_write_resolution(uint8_t resolution)
+void PwmClass::stop_sequence(uint8_t timer_idx)
 {
-  if (resolution < 1 || resolution > this->duty_cycle_mode_write_resolution_max) {
+  pwm_timer_t* pwm_timer = &this->pwm_timers[timer_idx];
+  if (!pwm_timer->sequence_running) {
     return;
   }
-  this->duty_cycle_mode_write_resolution = resolution;
-  this->duty_cycle_mode_max_value = pow(2, this->duty_cycle_mode_write_resolution) - 1;
+  pwm_timer->sequence_running = false;
+  DMADRV_StopTransfer(pwm_timer->sequence_dma_channel);
+  DMADRV_FreeChannel(pwm_timer->sequence_dma_channel);
 }
 
-void PwmClass::set_auto_deinit(bool auto_deinit)
+void PwmClass::stop_sequence_on_channel(uint8_t pwm_channel_idx)
 {
-  this->auto_deinit = auto_deinit;
+  pwm_timer_t* pwm_timer = &this->pwm_timers[pwm_channel_idx / cc_channels_per_timer];
+  if (pwm_timer->sequence_running && pwm_timer->sequence_cc_channel == pwm_channel_idx % cc_channels_per_timer) {
+    this->stop_sequence(pwm_channel_idx / cc_channels_per_timer);
+  }
 }
 
-uint8_t PwmClass::get_next_free_pwm_channel_idx()
+bool PwmClass::reserve_timer(TIMER_TypeDef* timer)
 {
-  for (uint8_t i = 0; i < this->max_pwm_channels; i++) {
-    if (this->pwm_pins[i].pin == PIN_NAME_MAX) {
+  bool res = false;
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < this->max_pwm_timers; i++) {
+    if (this->pwm_timers[i].timer == timer) {
+      if (!this->pwm_timers[i].reserved && this->get_num_of_pwm_channels_in_use(i) == 0u) {
+        this->pwm_timers[i].reserved = true;
+        res = true;
+      }
+      break;
+    }
+  }
+  xSemaphoreGive(this->pwm_mutex);
+  return res;
+}
+
+void PwmClass::release_timer(TIMER_TypeDef* timer)
+{
+  for (auto& pwm_timer : this->pwm_timers) {
+    if (pwm_timer.timer == timer) {
+      pwm_timer.reserved = false;
+    }
+  }
+}
+
+uint8_t PwmClass::get_num_of_free_pwm_channels()
+{
+  uint8_t count = 0u;
+  xSemaphoreTake(this->pwm_mutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < this->max_pwm_timers; i++) {
+    if (this->pwm_timers[i].reserved || (this->pwm_timers[i].frequency != 0u && this->pwm_timers[i].mode == pwm_mode_t::FREQUENCY)) {
+      continue;
+    }
+    count += this->cc_channels_per_timer - this->get_num_of_pwm_channels_in_use(i);
+  }
+  xSemaphoreGive(this->pwm_mutex);
+  return count;
+}
+
+uint8_t PwmClass::find_timer_for_channel(pwm_mode_t mode, uint32_t frequency)
+{
+  // Duty cycle mode channels with the same frequency are grouped on the same timer
+  if (mode == pwm_mode_t::DUTY_CYCLE) {
+    for (uint8_t i = 0; i < this->max_pwm_timers; i++) {
+      pwm_timer_t* pwm_timer = &this->pwm_timers[i];
+      if (pwm_timer->frequency == frequency && pwm_timer->mode == pwm_mode_t::DUTY_CYCLE
+          && this->get_num_of_pwm_channels_in_use(i) < this->cc_channels_per_timer) {
+        return i;
+      }
+    }
+  }
+  // Otherwise take a timer which is not running yet
+  for (uint8_t i = 0; i < this->max_pwm_timers; i++) {
+    uint32_t prescale, top;
+    if (this->pwm_timers[i].frequency == 0u && !this->pwm_timers[i].reserved
+        && this->calculate_timer_config(i, frequency, &prescale, &top)) {
       return i;
     }
   }
   return UINT8_MAX;
 }
 
+uint8_t PwmClass::allocate_pwm_channel(PinName pin, pwm_mode_t mode, uint32_t frequency)
+{
+  uint8_t timer_idx = this->find_timer_for_channel(mode, frequency);
+  if (timer_idx == UINT8_MAX) {
+    // No more free PWM channels available
+    return UINT8_MAX;
+  }
+  pwm_timer_t* pwm_timer = &this->pwm_timers[timer_idx];
+
+  // Start the timer if this is its first channel
+  if (pwm_timer->frequency == 0u) {
+    uint32_t prescale, top;
+    if (!this->calculate_timer_config(timer_idx, frequency, &prescale, &top)) {
+      return UINT8_MAX;
+    }
+    #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+    // Require at least EM1 to keep the timer peripherals running
+    if (this->get_num_of_pwm_channels_in_use() == 0u) {
+      sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+    }
+    #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+
+    CMU_ClockEnable(pwm_timer->clock, true);
+    TIMER_Init_TypeDef timer_init = TIMER_INIT_DEFAULT;
+    timer_init.enable = false;
+    timer_init.prescale = (TIMER_Prescale_TypeDef)prescale;
+    // Let each overflow request exactly one DMA transfer for sequences
+    timer_init.dmaClrAct = true;
+    TIMER_Init(pwm_timer->timer, &timer_init);
+    TIMER_TopSet(pwm_timer->timer, top);
+    TIMER_TopBufSet(pwm_timer->timer, top);
+    pwm_timer->mode = mode;
+    pwm_timer->frequency = frequency;
+    pwm_timer->top = top;
+  }
+
+  // Find a free compare channel on the timer
+  uint8_t cc_channel = 0u;
+  while (this->pwm_pins[timer_idx * cc_channels_per_timer + cc_channel].pin != PIN_NAME_MAX) {
+    cc_channel++;
+  }
+  uint8_t pwm_channel_idx = timer_idx * cc_channels_per_timer + cc_channel;
+  pwm_pin_t* pwm_pin = &this->pwm_pins[pwm_channel_idx];
+  pwm_pin->pin = pin;
+  pwm_pin->value = 0u;
+  // The write resolution of the pin survives releasing the channel - e.g. by auto deinit at 0% duty cycle
+  uint8_t resolution = this->pin_write_resolution[pin];
+  pwm_pin->max_value = resolution ? ((1u << resolution) - 1u) : 0u;
+
+  GPIO_Port_TypeDef port = getSilabsPortFromArduinoPin(pin);
+  uint8_t gpio_pin = getSilabsPinFromArduinoPin(pin);
+  GPIO_PinModeSet(port, gpio_pin, gpioModePushPull, 0);
+
+  // Configure the compare channel for PWM output starting at 0% duty cycle
+  TIMER_InitCC_TypeDef cc_init = TIMER_INITCC_DEFAULT;
+  cc_init.mode = timerCCModePWM;
+  TIMER_InitCC(pwm_timer->timer, cc_channel, &cc_init);
+  TIMER_CompareSet(pwm_timer->timer, cc_channel, 0u);
+  TIMER_CompareBufSet(pwm_timer->timer, cc_channel, 0u);
+
+  // Route the compare channel output to the pin
+  uint32_t timer_num = (uint32_t)TIMER_NUM(pwm_timer->timer);
+  volatile uint32_t* cc_route = &GPIO->TIMERROUTE[timer_num].CC0ROUTE + cc_channel;
+  *cc_route = ((uint32_t)port << _GPIO_TIMER_CC0ROUTE_PORT_SHIFT) | ((uint32_t)gpio_pin << _GPIO_TIMER_CC0ROUTE_PIN_SHIFT);
+  GPIO->TIMERROUTE[timer_num].ROUTEEN |= (GPIO_TIMER_ROUTEEN_CC0PEN << cc_channel);
+
+  // Configuring the compare channel stops the timer - start it again
+  TIMER_Enable(pwm_timer->timer, true);
+  return pwm_channel_idx;
+}
+
+void PwmClass::release_pwm_channel(uint8_t pwm_channel_idx)
+{
+  uint8_t timer_idx = pwm_channel_idx / cc_channels_per_timer;
+  uint8_t cc_channel = pwm_channel_idx % cc_channels_per_timer;
+  pwm_timer_t* pwm_timer = &this->pwm_timers[timer_idx];
+  pwm_pin_t* pwm_pin = &this->pwm_pins[pwm_channel_idx];
+
+  this->stop_sequence_on_channel(pwm_channel_idx);
+
+  // Disconnect the compare channel from the pin - the pin outputs a constant low level
+  GPIO->TIMERROUTE[TIMER_NUM(pwm_timer->timer)].ROUTEEN &= ~(GPIO_TIMER_ROUTEEN_CC0PEN << cc_channel);
+  TIMER_CompareSet(pwm_timer->timer, cc_channel, 0u);
+  TIMER_CompareBufSet(pwm_timer->timer, cc_channel, 0u);
+  GPIO_PinOutClear(getSilabsPortFromArduinoPin(pwm_pin->pin), getSilabsPinFromArduinoPin(pwm_pin->pin));
+  pwm_pin->pin = PIN_NAME_MAX;
+
+  // Stop the timer if there are no users left on it
+  if (this->get_num_of_pwm_channels_in_use(timer_idx) == 0u) {
+    TIMER_Reset(pwm_timer->timer);
+    CMU_ClockEnable(pwm_timer->clock, false);
+    pwm_timer->frequency = 0u;
+    pwm_timer->top = 0u;
+
+    #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+    // Remove the energy mode requirement if this was the last channel
+    if (this->get_num_of_pwm_channels_in_use() == 0u) {
+      sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+    }
+    #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  }
+}
+
+bool PwmClass::calculate_timer_config(uint8_t timer_idx, uint32_t frequency, uint32_t* prescale, uint32_t* top)
+{
+  if (frequency == 0u) {
+    return false;
+  }
+  // Calculate the smallest prescaler (the highest resolution) resulting in the requested frequency
+  // The top value is kept below the counter maximum so that 100% duty cycle remains reachable
+  TIMER_TypeDef* timer = this->pwm_timers[timer_idx].timer;
+  uint32_t ticks_per_period = CMU_ClockFreqGet(this->pwm_timers[timer_idx].clock) / frequency;
+  *prescale = (ticks_per_period - 1u) / TIMER_MaxCount(timer);
+  if (ticks_per_period < 2u || *prescale > (uint32_t)timerPrescale1024) {
+    return false;
+  }
+  *top = ticks_per_period / (*prescale + 1u) - 1u;
+  return true;
+}
+
+bool PwmClass::set_timer_frequency(uint8_t timer_idx, uint32_t frequency)
+{
+  uint32_t prescale, top;
+  if (!this->calculate_timer_config(timer_idx, frequency, &prescale, &top)) {
+    return false;
+  }
+  pwm_timer_t* pwm_timer = &this->pwm_timers[timer_idx];
+  TIMER_TypeDef* timer = pwm_timer->timer;
+  // The compare values of a running sequence are only valid for the current period
+  this->stop_sequence(timer_idx);
+  pwm_timer->frequency = frequency;
+  pwm_timer->top = top;
+
+  // Recalculate the compare values for the new period
+  uint32_t compare_values[cc_channels_per_timer];
+  for (uint8_t cc_channel = 0; cc_channel < cc_channels_per_timer; cc_channel++) {
+    uint8_t pwm_channel_idx = timer_idx * cc_channels_per_timer + cc_channel;
+    if (this->pwm_pins[pwm_channel_idx].pin != PIN_NAME_MAX) {
+      compare_values[cc_channel] = this->get_compare_value(pwm_channel_idx, this->pwm_pins[pwm_channel_idx].value);
+    }
+  }
+
+  if (prescale == ((timer->CFG & _TIMER_CFG_PRESC_MASK) >> _TIMER_CFG_PRESC_SHIFT)) {
+    // Only the period changes - update the top and the compare values through the buffer registers
+    // so that the new period and duty cycles take effect together on the next overflow
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    this->wait_for_buffered_update_window(timer_idx, this->get_num_of_pwm_channels_in_use(timer_idx) + 1u);
+    TIMER_TopBufSet(timer, top);
+    for (uint8_t cc_channel = 0; cc_channel < cc_channels_per_timer; cc_channel++) {
+      if (this->pwm_pins[timer_idx * cc_channels_per_timer + cc_channel].pin != PIN_NAME_MAX) {
+        TIMER_CompareBufSet(timer, cc_channel, compare_values[cc_channel]);
+      }
+    }
+    CORE_EXIT_CRITICAL();
+    return true;
+  }
+
+  // The prescaler can only be changed while the timer is disabled - the channel configuration is kept
+  TIMER_Enable(timer, false);
+  timer->EN_CLR = TIMER_EN_EN;
+  #if defined(_TIMER_EN_DISABLING_MASK)
+  while (timer->EN & _TIMER_EN_DISABLING_MASK) ;
+  #endif // _TIMER_EN_DISABLING_MASK
+  timer->CFG = (timer->CFG & ~_TIMER_CFG_PRESC_MASK) | (prescale << _TIMER_CFG_PRESC_SHIFT);
+  timer->EN_SET = TIMER_EN_EN;
+  TIMER_TopSet(timer, top);
+  TIMER_TopBufSet(timer, top);
+  TIMER_CounterSet(timer, 0u);
+  // The buffers are written as well so that no previously buffered value gets loaded on the next overflow
+  for (uint8_t cc_channel = 0; cc_channel < cc_channels_per_timer; cc_channel++) {
+    if (this->pwm_pins[timer_idx * cc_channels_per_timer + cc_channel].pin != PIN_NAME_MAX) {
+      TIMER_CompareSet(timer, cc_channel, compare_values[cc_channel]);
+      TIMER_CompareBufSet(timer, cc_channel, compare_values[cc_channel]);
+    }
+  }
+  TIMER_Enable(timer, true);
+  return true;
+}
+
+void PwmClass::wait_for_buffered_update_window(uint8_t timer_idx, uint32_t num_of_writes)
+{
+  // The buffer registers are loaded on overflow - if the overflow happens in the middle of a multi register
+  // update, then part of the new values would take effect one period later than the rest.
+  // If the period is about to end we wait for the overflow and write the values at the start of the next one.
+  TIMER_TypeDef* timer = this->pwm_timers[timer_idx].timer;
+  uint32_t prescale = (timer->CFG & _TIMER_CFG_PRESC_MASK) >> _TIMER_CFG_PRESC_SHIFT;
+  uint32_t margin = num_of_writes * this->buffered_update_cycles_per_write / (prescale + 1u) + 1u;
+  TIMER_IntClear(timer, TIMER_IF_OF);
+  if (TIMER_TopGet(timer) - TIMER_CounterGet(timer) < margin) {
+    while (!(TIMER_IntGet(timer) & TIMER_IF_OF)) ;
+  }
+}
+
+uint32_t PwmClass::get_compare_value(uint8_t pwm_channel_idx, uint32_t value)
+{
+  // Scale the value to the timer period - a compare value above the top value results in 100% duty cycle
+  uint32_t top = this->pwm_timers[pwm_channel_idx / cc_channels_per_timer].top;
+  return (uint32_t)(((uint64_t)value * ((uint64_t)top + 1u)) / this->get_max_value(pwm_channel_idx));
+}
+
+uint32_t PwmClass::get_max_value(uint8_t pwm_channel_idx)
+{
+  uint32_t max_value = this->pwm_pins[pwm_channel_idx].max_value;
+  return max_value ? max_value : this->duty_cycle_mode_max_value;
+}
+
 uint8_t PwmClass::get_pwm_channel_idx_for_pin(PinName pin)
 {
   for (uint8_t i = 0; i < this->max_pwm_channels; i++) {
@@ -220,24 +806,35 @@ uint8_t PwmClass::get_pwm_channel_idx_for_pin(PinName pin)
   return UINT8_MAX;
 }
 
-uint8_t PwmClass::get_num_of_pwm_channels_in_use()
+uint8_t PwmClass::get_num_of_pwm_channels_in_use(uint8_t timer_idx)
 {
   uint8_t count = 0u;
-  for (auto& pwm_pin : this->pwm_pins) {
-    if (pwm_pin.pin != PIN_NAME_MAX) {
+  for (uint8_t cc_channel = 0; cc_channel < cc_channels_per_timer; cc_channel++) {
+    if (this->pwm_pins[timer_idx * cc_channels_per_timer + cc_channel].pin != PIN_NAME_MAX) {
       count++;
     }
   }
   return count;
 }
 
-void PwmClass::deinit_all_pwm_channels()
+uint8_t PwmClass::get_num_of_pwm_channels_in_use()
 {
+  uint8_t count = 0u;
   for (auto& pwm_pin : this->pwm_pins) {
     if (pwm_pin.pin != PIN_NAME_MAX) {
-      this->stop(pwm_pin.pin);
+      count++;
     }
   }
+  return count;
+}
+
+bool sequence_dma_transfer_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+
+  PWM.handle_sequence_dma_callback((uint8_t)(uintptr_t)userParam);
+  return true;
 }
 
 arduino::PwmClass PWM;
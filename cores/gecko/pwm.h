@@ -33,8 +33,13 @@
 #include <inttypes.h>
 #include "pinDefinitions.h"
 #include "wiring_private.h"
-#include "sl_pwm.h"
+#include "em_cmu.h"
 #include "em_gpio.h"
+#include "em_timer.h"
+#include "em_core.h"
+#include "em_ldma.h"
+#include "dmadrv.h"
+#include "sl_status.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
 
@@ -42,6 +47,12 @@ extern "C" {
   #include "sl_power_manager.h"
 }
 
+enum pwm_sequence_mode_t {
+  PWM_SEQUENCE_ONESHOT = 0,   // Play the buffer once, then hold the last compare value
+  PWM_SEQUENCE_LOOP,          // Play the buffer continuously
+  PWM_SEQUENCE_PINGPONG       // Alternate between two buffers - the finished one can be refilled in the callback
+};
+
 namespace arduino {
 class PwmClass {
 public:
@@ -52,25 +63,50 @@ public:
 
   /**************************************************************************//**
    * PWM signal generation in duty cycle mode
-   * In this mode the frequency is fixed at a constant value and the duty
-   * cycle is variable by the user. Used for 'analogWrite'.
-   * Can handle multiple channels.
+   * In this mode the frequency is fixed and the duty cycle is variable
+   * by the user. Used for 'analogWrite'.
+   * Can handle multiple channels - the channels are spread over the TIMER
+   * peripherals, pins with the same frequency share a timer.
+   * The duty cycle is written to the timer compare value at the full
+   * resolution of the timer, no precision is lost on the way.
+   * The update is buffered and takes effect at the start of the next period.
    *
    * @param[in] pin output pin for the PWM signal
-   * @param[in] duty_cycle duty cycle for the PWM signal (0-255)
+   * @param[in] duty_cycle duty cycle for the PWM signal (0 - max value of the write resolution)
+   *
+   * @return true if the duty cycle was set, false if the parameters are invalid
+   *         or there are no free PWM channels left
    *****************************************************************************/
-  void duty_cycle_mode(PinName pin, int duty_cycle);
+  bool duty_cycle_mode(PinName pin, int duty_cycle);
+
+  /**************************************************************************//**
+   * Sets the duty cycle of multiple pins in the same PWM period
+   * The new duty cycles of the pins sharing a timer take effect together
+   * at the start of the next period. Pins which are not active yet are started first.
+   * A duty cycle of 0 is applied as is - the pins are not deinitialized.
+   *
+   * @param[in] pins the output pins for the PWM signals
+   * @param[in] duty_cycles the duty cycles for each pin (0 - max value of the pin's write resolution)
+   * @param[in] count the number of pins (max 'max_pwm_channels')
+   *
+   * @return true if all duty cycles were set successfully, false otherwise
+   *****************************************************************************/
+  bool duty_cycle_mode_batch(const PinName* pins, const int* duty_cycles, uint8_t count);
 
   /**************************************************************************//**
    * PWM signal generation in frequency mode
    * In this mode the duty cycle is fixed at 50% and the frequency
    * is variable by the user. Used for 'tone'.
-   * Can only handle one channel at a time.
+   * Each pin in frequency mode occupies a timer on its own,
+   * the duty cycle mode channels on the other timers keep running.
    *
    * @param[in] pin output pin for the PWM signal
-   * @param[in] frequency the desired frequency of the PWM signal
+   * @param[in] frequency the desired frequency of the PWM signal - 0 stops the output
+   *
+   * @return true if the frequency was set, false if the parameters are invalid
+   *         or there are no free timers left
    *****************************************************************************/
-  void frequency_mode(PinName pin, int frequency);
+  bool frequency_mode(PinName pin, int frequency);
 
   /**************************************************************************//**
    * Stops any ongoing PWM signal generation and output
@@ -81,17 +117,48 @@ public:
 
   /***************************************************************************//**
    * Sets the write resolution in bits.
-   * The default is 8 bits, the maximum is 12 bits.
+   * The default is 8 bits, the maximum is 16 bits.
+   * Applies to all channels which don't have their own resolution set.
    *
    * @param[in] resolution the requested write resolution in bits
    ******************************************************************************/
   void duty_cycle_mode_set_write_resolution(uint8_t resolution);
 
+  /***************************************************************************//**
+   * Sets the write resolution in bits for a single pin.
+   * The default is the global write resolution, the maximum is 16 bits.
+   * Starts the pin at 0% duty cycle if it's not active yet.
+   * The setting is kept when the pin is stopped - also by auto deinit on
+   * 0% duty cycle - and applies again when the pin is restarted.
+   *
+   * @param[in] pin the PWM pin to set the write resolution for
+   * @param[in] resolution the requested write resolution in bits
+   *
+   * @return true if the resolution was set successfully, false otherwise
+   ******************************************************************************/
+  bool duty_cycle_mode_set_write_resolution(PinName pin, uint8_t resolution);
+
+  /***************************************************************************//**
+   * Sets the PWM frequency of a pin used in duty cycle mode.
+   * Starts the pin at 0% duty cycle if it's not active yet.
+   * The duty cycle of the pin is kept at the new frequency.
+   * The pin is moved to a timer running at the requested frequency if
+   * it shares its current timer with other pins.
+   * The achievable duty cycle resolution is the timer clock divided by the
+   * frequency - requesting a higher frequency results in fewer steps.
+   *
+   * @param[in] pin the PWM pin to set the frequency for
+   * @param[in] frequency the requested PWM frequency in Hz
+   *
+   * @return true if the frequency was set successfully, false if the frequency
+   *         is out of range or there are no free timers left
+   ******************************************************************************/
+  bool duty_cycle_mode_set_frequency(PinName pin, uint32_t frequency);
+
   /***************************************************************************//**
    * Turns the automatic deinitialization feature on or off.
-   * When it's on the PWM hardware will be deinitialized when 0 duty cycle is
-   * requested. If multiple channels are active, then this deinitialization will
-   * momentarily interrupt the other channels.
+   * When it's on the PWM channel will be deinitialized when 0 duty cycle is
+   * requested. The last channel on a timer also stops the timer.
    * When auto deinit is off PWM can still be stopped by calling stop() explicitly.
    * It's on by default. This setting is only relevant in duty cycle mode.
    *
@@ -99,54 +166,252 @@ public:
    ******************************************************************************/
   void set_auto_deinit(bool auto_deinit);
 
-private:
-  /**************************************************************************//**
-   * Initializes PWM signal generation
+  /***************************************************************************//**
+   * Converts a duty cycle value to the timer compare value of a pin
+   * Used for filling the buffers of PWM sequences. The result is only valid
+   * while the frequency of the pin is unchanged.
    *
-   * @param[in] pin output pin for the PWM signal
-   * @param[in] frequency the desired frequency of the PWM signal
+   * @param[in] pin an active duty cycle mode PWM pin
+   * @param[in] duty_cycle the duty cycle (0 - max value of the pin's write resolution)
    *
-   * @return true if the initialization was successful, false otherwise
-   *****************************************************************************/
-  bool init(PinName pin, int frequency);
+   * @return the compare value for the duty cycle - 0 if the pin is not active
+   ******************************************************************************/
+  uint32_t duty_cycle_to_compare_value(PinName pin, uint32_t duty_cycle);
 
+  /***************************************************************************//**
+   * Starts playing a sequence of compare values on a PWM pin
+   * The compare values are moved to the timer's compare buffer register by LDMA
+   * on every overflow - each value lasts for exactly one PWM period and the CPU
+   * is not involved. Use 'duty_cycle_to_compare_value()' to fill the buffer.
+   * The buffer must remain valid until the sequence finishes or gets stopped.
+   * The pin has to be started in duty cycle mode first (e.g. with
+   * 'duty_cycle_mode_set_frequency()'). One sequence can run per timer, writing
+   * the duty cycle or changing the frequency of the pin stops the sequence.
+   *
+   * @param[in] pin the PWM pin to play the sequence on
+   * @param[in] buffer the compare values to play
+   * @param[in] size the number of compare values in the buffer
+   * @param[in] mode PWM_SEQUENCE_ONESHOT or PWM_SEQUENCE_LOOP
+   * @param[in] user_onsequence_finished_callback Callback that gets called from
+   *            interrupt context each time the end of the buffer is reached
+   *            (optional)
+   *
+   * @return Status of the sequence init process
+   ******************************************************************************/
+  sl_status_t sequence_start(PinName pin,
+                             const uint32_t* buffer,
+                             uint32_t size,
+                             pwm_sequence_mode_t mode,
+                             void (*user_onsequence_finished_callback)(PinName, uint8_t) = nullptr);
+
+  /***************************************************************************//**
+   * Starts playing a sequence of compare values from two alternating buffers
+   * Works the same as 'sequence_start()' - when one buffer is finished the
+   * other one continues seamlessly and the callback is called with the index
+   * of the finished buffer, which can be refilled while the other one plays.
+   *
+   * @param[in] pin the PWM pin to play the sequence on
+   * @param[in] buffer0 the first buffer of compare values
+   * @param[in] buffer1 the second buffer of compare values
+   * @param[in] size the number of compare values in each buffer
+   * @param[in] user_onsequence_finished_callback Callback that gets called from
+   *            interrupt context with the pin and the index of the finished buffer
+   *
+   * @return Status of the sequence init process
+   ******************************************************************************/
+  sl_status_t sequence_start_pingpong(PinName pin,
+                                      const uint32_t* buffer0,
+                                      const uint32_t* buffer1,
+                                      uint32_t size,
+                                      void (*user_onsequence_finished_callback)(PinName, uint8_t));
+
+  /***************************************************************************//**
+   * Stops the sequence playing on a PWM pin
+   * The last played compare value stays on the output.
+   *
+   * @param[in] pin the PWM pin to stop the sequence on
+   ******************************************************************************/
+  void sequence_stop(PinName pin);
+
+  /***************************************************************************//**
+   * Returns whether a sequence is playing on a PWM pin
+   *
+   * @param[in] pin the PWM pin
+   *
+   * @return true if a sequence is playing on the pin, false otherwise
+   ******************************************************************************/
+  bool sequence_is_running(PinName pin);
+
+  /***************************************************************************//**
+   * Handles the end of a sequence buffer - called from the DMA callback
+   *
+   * @param[in] timer_idx the index of the timer running the sequence
+   ******************************************************************************/
+  void handle_sequence_dma_callback(uint8_t timer_idx);
+
+  /***************************************************************************//**
+   * Reserves a TIMER peripheral for another driver
+   * The PWM won't allocate channels on a reserved timer.
+   *
+   * @param[in] timer the timer to reserve
+   *
+   * @return true if the timer was reserved, false if it's used for PWM or already reserved
+   ******************************************************************************/
+  bool reserve_timer(TIMER_TypeDef* timer);
+
+  /***************************************************************************//**
+   * Releases a TIMER peripheral reserved with 'reserve_timer()'
+   * Can be called from interrupt context.
+   *
+   * @param[in] timer the timer to release
+   ******************************************************************************/
+  void release_timer(TIMER_TypeDef* timer);
+
+  /***************************************************************************//**
+   * Provides the number of PWM channels which are not in use
+   *
+   * @return the number of free PWM channels
+   ******************************************************************************/
+  uint8_t get_num_of_free_pwm_channels();
+
+  static const uint8_t max_pwm_timers = 5u;
+  static const uint8_t cc_channels_per_timer = 3u;
+  static const uint8_t max_pwm_channels = max_pwm_timers * cc_channels_per_timer;
+
+private:
   enum pwm_mode_t {
     DUTY_CYCLE,
     FREQUENCY
   };
 
-  sl_pwm_config_t pwm_config;
-  pwm_mode_t pwm_mode;
-  bool auto_deinit;
+  typedef struct {
+    TIMER_TypeDef* timer;
+    CMU_Clock_TypeDef clock;
+    LDMA_PeripheralSignal_t dma_overflow_signal;
+    pwm_mode_t mode;
+    uint32_t frequency;
+    uint32_t top;
+    volatile bool reserved;
+    volatile bool sequence_running;
+    uint8_t sequence_cc_channel;
+    pwm_sequence_mode_t sequence_mode;
+    uint8_t sequence_buffer_idx;
+    unsigned int sequence_dma_channel;
+    LDMA_Descriptor_t sequence_descriptors[2];
+    void (*user_onsequence_finished_callback)(PinName, uint8_t);
+  } pwm_timer_t;
 
-  static const int duty_cycle_mode_default_freq = 1000;
+  typedef struct {
+    PinName pin;
+    uint32_t value;
+    uint32_t max_value;
+  } pwm_pin_t;
 
-  SemaphoreHandle_t pwm_mutex;
-  StaticSemaphore_t pwm_mutex_buf;
+  /**************************************************************************//**
+   * Finds a timer for a new channel with the requested mode and frequency
+   * Duty cycle mode channels share the timers running at the same frequency,
+   * frequency mode channels get a timer on their own.
+   *
+   * @param[in] mode the mode of the new channel
+   * @param[in] frequency the frequency of the new channel
+   *
+   * @return the index of the timer in 'pwm_timers' - UINT8_MAX if there's no suitable timer
+   *****************************************************************************/
+  uint8_t find_timer_for_channel(pwm_mode_t mode, uint32_t frequency);
 
-  static const uint8_t max_pwm_channels = 3u;
-  static const uint32_t pwm_stabilization_time_ms = 2u;
+  /**************************************************************************//**
+   * Allocates a PWM channel and starts it with 0% duty cycle
+   *
+   * @param[in] pin output pin for the PWM signal
+   * @param[in] mode the mode of the channel
+   * @param[in] frequency the desired frequency of the PWM signal
+   *
+   * @return the index of the channel in 'pwm_pins' - UINT8_MAX if there are no free channels
+   *****************************************************************************/
+  uint8_t allocate_pwm_channel(PinName pin, pwm_mode_t mode, uint32_t frequency);
 
-  uint32_t duty_cycle_set_time;
+  /**************************************************************************//**
+   * Stops and frees a PWM channel - stops the timer if it was its last channel
+   *
+   * @param[in] pwm_channel_idx the index of the channel in 'pwm_pins'
+   *****************************************************************************/
+  void release_pwm_channel(uint8_t pwm_channel_idx);
 
-  uint8_t duty_cycle_mode_write_resolution;
-  uint32_t duty_cycle_mode_max_value;
-  static const uint8_t duty_cycle_mode_write_resolution_max = 12u;
+  /**************************************************************************//**
+   * Starts the LDMA transfer of a sequence prepared in the timer's descriptors
+   *
+   * @param[in] pwm_channel_idx the index of the channel in 'pwm_pins'
+   *
+   * @return Status of the sequence init process
+   *****************************************************************************/
+  sl_status_t sequence_init(uint8_t pwm_channel_idx);
 
-  typedef struct {
-    PinName pin;
-    uint8_t duty_cycle_percent;
-    sl_pwm_instance_t inst;
-  } pwm_pin_t;
+  /**************************************************************************//**
+   * Stops the sequence running on a timer if there's any
+   * Can be called from interrupt context.
+   *
+   * @param[in] timer_idx the index of the timer in 'pwm_timers'
+   *****************************************************************************/
+  void stop_sequence(uint8_t timer_idx);
 
-  pwm_pin_t pwm_pins[max_pwm_channels];
+  /**************************************************************************//**
+   * Stops the sequence running on a channel if there's any
+   *
+   * @param[in] pwm_channel_idx the index of the channel in 'pwm_pins'
+   *****************************************************************************/
+  void stop_sequence_on_channel(uint8_t pwm_channel_idx);
+
+  /**************************************************************************//**
+   * Calculates the timer configuration for the provided frequency
+   *
+   * @param[in] timer_idx the index of the timer in 'pwm_timers'
+   * @param[in] frequency the desired frequency of the PWM signal
+   * @param[out] prescale the calculated prescaler value
+   * @param[out] top the calculated top value
+   *
+   * @return true if the frequency can be generated, false otherwise
+   *****************************************************************************/
+  bool calculate_timer_config(uint8_t timer_idx, uint32_t frequency, uint32_t* prescale, uint32_t* top);
+
+  /**************************************************************************//**
+   * Configures a running timer to run at the provided frequency
+   * Keeps the duty cycle of all the channels on the timer.
+   *
+   * @param[in] timer_idx the index of the timer in 'pwm_timers'
+   * @param[in] frequency the desired frequency of the PWM signal
+   *
+   * @return true if the frequency can be generated, false otherwise
+   *****************************************************************************/
+  bool set_timer_frequency(uint8_t timer_idx, uint32_t frequency);
+
+  /**************************************************************************//**
+   * Calculates the timer compare value of a channel for a duty cycle value
+   *
+   * @param[in] pwm_channel_idx the index of the channel in 'pwm_pins'
+   * @param[in] value the duty cycle value (0 - max value of the channel)
+   *
+   * @return the compare value for the current top value of the channel's timer
+   *****************************************************************************/
+  uint32_t get_compare_value(uint8_t pwm_channel_idx, uint32_t value);
+
+  /**************************************************************************//**
+   * Provides the write resolution max value of a channel
+   *
+   * @param[in] pwm_channel_idx the index of the channel in 'pwm_pins'
+   *
+   * @return the value corresponding to 100% duty cycle
+   *****************************************************************************/
+  uint32_t get_max_value(uint8_t pwm_channel_idx);
 
   /**************************************************************************//**
-   * Provides the next free PWM channel index if available
+   * Waits until the current PWM period has enough time left for updating
+   * the provided number of buffer registers before the next overflow
+   * Has to be called with interrupts disabled.
    *
-   * @return the next free PWM channel index - UINT8_MAX if no channels available
+   * @param[in] timer_idx the index of the timer in 'pwm_timers'
+   * @param[in] num_of_writes the number of buffer registers to be written
    *****************************************************************************/
-  uint8_t get_next_free_pwm_channel_idx();
+  void wait_for_buffered_update_window(uint8_t timer_idx, uint32_t num_of_writes);
 
   /**************************************************************************//**
    * Returns the PWM channel index for the provided pin
@@ -158,6 +423,15 @@ private:
    *****************************************************************************/
   uint8_t get_pwm_channel_idx_for_pin(PinName pin);
 
+  /**************************************************************************//**
+   * Provides the number of PWM channels in use on a timer
+   *
+   * @param[in] timer_idx the index of the timer in 'pwm_timers'
+   *
+   * @return the number of PWM channels in use on the timer
+   *****************************************************************************/
+  uint8_t get_num_of_pwm_channels_in_use(uint8_t timer_idx);
+
   /**************************************************************************//**
    * Provides the number of PWM channels in use
    *
@@ -165,10 +439,23 @@ private:
    *****************************************************************************/
   uint8_t get_num_of_pwm_channels_in_use();
 
-  /**************************************************************************//**
-   * Deinitializes all active PWM channels
-   *****************************************************************************/
-  void deinit_all_pwm_channels();
+  pwm_timer_t pwm_timers[max_pwm_timers];
+  pwm_pin_t pwm_pins[max_pwm_channels];
+  // Write resolution of each pin in bits - zero uses the global resolution
+  uint8_t pin_write_resolution[PIN_NAME_MAX];
+  bool auto_deinit;
+
+  static const uint32_t duty_cycle_mode_default_freq = 1000u;
+
+  SemaphoreHandle_t pwm_mutex;
+  StaticSemaphore_t pwm_mutex_buf;
+
+  // Worst case number of timer clock cycles needed to write one buffer register
+  static const uint32_t buffered_update_cycles_per_write = 32u;
+
+  uint8_t duty_cycle_mode_write_resolution;
+  uint32_t duty_cycle_mode_max_value;
+  static const uint8_t duty_cycle_mode_write_resolution_max = 16u;
 };
 } // namespace arduino
 
@@ -0,0 +1,524 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "silabs_framing.h"
+
+#include <cstdlib>
+#include <cstring>
+#include "em_cmu.h"
+#include "em_core.h"
+
+using namespace arduino;
+
+static const uint8_t slip_end = 0xC0;
+static const uint8_t slip_esc = 0xDB;
+static const uint8_t slip_esc_end = 0xDC;
+static const uint8_t slip_esc_esc = 0xDD;
+static const uint8_t cobs_max_code = 0xFF;
+
+// Nibble lookup tables for the reflected CRC polynomials
+static const uint32_t crc32_table[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+static const uint16_t crc16_table[16] = {
+  0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+  0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F
+};
+
+static volatile bool gpcrc_busy = false;
+
+static uint8_t get_crc_size(framing_crc_t crc);
+static uint32_t crc_software(framing_crc_t type, const uint8_t* data, size_t size);
+static uint32_t crc_hardware(framing_crc_t type, const uint8_t* data, size_t size);
+
+FramedStream::FramedStream(Stream& stream, framing_mode_t mode, framing_crc_t crc) :
+  FramedStream(stream, nullptr, mode, crc)
+{
+  ;
+}
+
+FramedStream::FramedStream(UARTClass& serial, framing_mode_t mode, framing_crc_t crc) :
+  FramedStream(serial, &serial, mode, crc)
+{
+  ;
+}
+
+FramedStream::FramedStream(Stream& stream, UARTClass* serial, framing_mode_t mode, framing_crc_t crc) :
+  stream(stream),
+  serial(serial),
+  mode(mode),
+  crc(crc),
+  crc_size(get_crc_size(crc)),
+  frame_pool(nullptr),
+  frame_sizes(nullptr),
+  frame_buffer_size(0),
+  frame_count(0),
+  frame_read_index(0),
+  frames_ready(0),
+  frame_callback(nullptr),
+  crc_error_count(0),
+  framing_error_count(0),
+  dropped_frame_count(0),
+  tx_stage_length(0),
+  tx_failed(false),
+  tx_mutex(nullptr)
+{
+  this->tx_mutex = xSemaphoreCreateMutexStatic(&this->tx_mutex_buf);
+  configASSERT(this->tx_mutex);
+  this->decode_reset();
+}
+
+FramedStream::~FramedStream()
+{
+  this->end();
+}
+
+bool FramedStream::begin(size_t max_frame_size, uint8_t frame_count)
+{
+  if (max_frame_size == 0u || frame_count == 0u) {
+    return false;
+  }
+  this->end();
+
+  // Each buffer holds the payload and the received CRC
+  size_t buffer_size = max_frame_size + this->crc_size;
+  this->frame_pool = (uint8_t*)malloc(buffer_size * frame_count);
+  this->frame_sizes = (size_t*)malloc(sizeof(size_t) * frame_count);
+  if (this->frame_pool == nullptr || this->frame_sizes == nullptr) {
+    this->end();
+    return false;
+  }
+  this->frame_buffer_size = buffer_size;
+  this->frame_count = frame_count;
+  this->frame_read_index = 0u;
+  this->frames_ready = 0u;
+  this->decode_reset();
+  return true;
+}
+
+void FramedStream::end()
+{
+  free(this->frame_pool);
+  free(this->frame_sizes);
+  this->frame_pool = nullptr;
+  this->frame_sizes = nullptr;
+  this->frame_buffer_size = 0u;
+  this->frame_count = 0u;
+  this->frames_ready = 0u;
+}
+
+void FramedStream::onFrame(void (*callback)(const uint8_t* data, size_t size))
+{
+  this->frame_callback = callback;
+}
+
+void FramedStream::poll()
+{
+  if (this->frame_pool == nullptr) {
+    return;
+  }
+
+  // Decode directly from the serial receive buffer if possible
+  if (this->serial != nullptr) {
+    const uint8_t* data;
+    size_t size;
+    while ((size = this->serial->peekSpan(&data)) > 0u) {
+      this->decode(data, size);
+      this->serial->consume(size);
+    }
+    return;
+  }
+
+  while (this->stream.available() > 0) {
+    int data = this->stream.read();
+    if (data < 0) {
+      break;
+    }
+    this->decode_byte((uint8_t)data);
+  }
+}
+
+size_t FramedStream::writeFrame(const uint8_t* data, size_t size)
+{
+  if (data == nullptr && size > 0u) {
+    return 0u;
+  }
+
+  uint8_t crc_bytes[4];
+  uint32_t crc_value = FramedStream::calculateCrc(this->crc, data, size);
+  for (uint8_t i = 0u; i < this->crc_size; i++) {
+    crc_bytes[i] = (uint8_t)(crc_value >> (8u * i));
+  }
+  // The encoded payload is the frame data followed by the CRC
+  size_t total = size + this->crc_size;
+  auto payload_byte = [&](size_t index) -> uint8_t {
+                        return index < size ? data[index] : crc_bytes[index - size];
+                      };
+
+  xSemaphoreTake(this->tx_mutex, portMAX_DELAY);
+  this->tx_stage_length = 0u;
+  this->tx_failed = false;
+
+  if (this->mode == FRAMING_SLIP) {
+    // Start with a delimiter to flush any line noise from the receiver
+    this->encode_put(slip_end);
+    for (size_t i = 0u; i < total; i++) {
+      uint8_t byte = payload_byte(i);
+      if (byte == slip_end) {
+        this->encode_put(slip_esc);
+        this->encode_put(slip_esc_end);
+      } else if (byte == slip_esc) {
+        this->encode_put(slip_esc);
+        this->encode_put(slip_esc_esc);
+      } else {
+        this->encode_put(byte);
+      }
+    }
+    this->encode_put(slip_end);
+  } else {
+    // Each block starts with the distance to the next zero byte which it replaces
+    size_t position = 0u;
+    while (true) {
+      size_t run = 0u;
+      while (position + run < total && run < (cobs_max_code - 1u) && payload_byte(position + run) != 0u) {
+        run++;
+      }
+      this->encode_put((uint8_t)(run + 1u));
+      for (size_t i = 0u; i < run; i++) {
+        this->encode_put(payload_byte(position + i));
+      }
+      position += run;
+      if (position >= total) {
+        break;
+      }
+      // A full block has no zero byte after it
+      if (run < (cobs_max_code - 1u)) {
+        position++;
+      }
+    }
+    this->encode_put(0u);
+  }
+
+  this->encode_flush();
+  bool failed = this->tx_failed;
+  xSemaphoreGive(this->tx_mutex);
+  return failed ? 0u : size;
+}
+
+uint8_t FramedStream::available()
+{
+  return this->frames_ready;
+}
+
+const uint8_t* FramedStream::peekFrame(size_t* size)
+{
+  if (this->frames_ready == 0u) {
+    return nullptr;
+  }
+  if (size != nullptr) {
+    *size = this->frame_sizes[this->frame_read_index];
+  }
+  return this->get_frame_buffer(this->frame_read_index);
+}
+
+void FramedStream::releaseFrame()
+{
+  if (this->frames_ready == 0u) {
+    return;
+  }
+  this->frame_read_index = (this->frame_read_index + 1u) % this->frame_count;
+  this->frames_ready--;
+}
+
+uint32_t FramedStream::getCrcErrorCount()
+{
+  return this->crc_error_count;
+}
+
+uint32_t FramedStream::getFramingErrorCount()
+{
+  return this->framing_error_count;
+}
+
+uint32_t FramedStream::getDroppedFrameCount()
+{
+  return this->dropped_frame_count;
+}
+
+void FramedStream::clearErrorCounters()
+{
+  this->crc_error_count = 0u;
+  this->framing_error_count = 0u;
+  this->dropped_frame_count = 0u;
+}
+
+uint32_t FramedStream::calculateCrc(framing_crc_t type, const uint8_t* data, size_t size)
+{
+  if (type == FRAMING_CRC_NONE) {
+    return 0u;
+  }
+
+  // The GPCRC is shared by all the instances - whoever finds it busy calculates in software
+  bool gpcrc_free;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  gpcrc_free = !gpcrc_busy;
+  gpcrc_busy = true;
+  CORE_EXIT_CRITICAL();
+
+  if (!gpcrc_free) {
+    return crc_software(type, data, size);
+  }
+  uint32_t result = crc_hardware(type, data, size);
+  gpcrc_busy = false;
+  return result;
+}
+
+void FramedStream::decode(const uint8_t* data, size_t size)
+{
+  for (size_t i = 0u; i < size; i++) {
+    this->decode_byte(data[i]);
+  }
+}
+
+void FramedStream::decode_byte(uint8_t data)
+{
+  if (this->mode == FRAMING_SLIP) {
+    if (data == slip_end) {
+      this->decode_frame_end();
+      return;
+    }
+    if (this->rx_slip_escape) {
+      this->rx_slip_escape = false;
+      if (data == slip_esc_end) {
+        this->decode_append(slip_end);
+      } else if (data == slip_esc_esc) {
+        this->decode_append(slip_esc);
+      } else if (!this->rx_discard) {
+        this->rx_discard = true;
+        this->framing_error_count++;
+      }
+      return;
+    }
+    if (data == slip_esc) {
+      this->rx_slip_escape = true;
+      this->rx_in_frame = true;
+      return;
+    }
+    this->decode_append(data);
+    return;
+  }
+
+  if (data == 0u) {
+    this->decode_frame_end();
+    return;
+  }
+  if (this->rx_cobs_remaining == 0u) {
+    // A new block - the previous one ended with an implied zero unless it was full
+    if (this->rx_in_frame && this->rx_cobs_code != cobs_max_code) {
+      this->decode_append(0u);
+    }
+    this->rx_in_frame = true;
+    this->rx_cobs_code = data;
+    this->rx_cobs_remaining = data - 1u;
+    return;
+  }
+  this->decode_append(data);
+  this->rx_cobs_remaining--;
+}
+
+void FramedStream::decode_append(uint8_t data)
+{
+  this->rx_in_frame = true;
+  if (this->rx_discard) {
+    return;
+  }
+  if (this->rx_length == 0u && this->frames_ready >= this->frame_count) {
+    // There's no free buffer - the frame is dropped
+    this->rx_discard = true;
+    this->dropped_frame_count++;
+    return;
+  }
+  if (this->rx_length >= this->frame_buffer_size) {
+    // Too large - the frame is dropped
+    this->rx_discard = true;
+    this->framing_error_count++;
+    return;
+  }
+  uint8_t write_index = (this->frame_read_index + this->frames_ready) % this->frame_count;
+  this->get_frame_buffer(write_index)[this->rx_length++] = data;
+}
+
+void FramedStream::decode_frame_end()
+{
+  bool in_frame = this->rx_in_frame;
+  bool discard = this->rx_discard;
+  size_t length = this->rx_length;
+  bool truncated = (this->mode == FRAMING_COBS) ? (this->rx_cobs_remaining != 0u) : this->rx_slip_escape;
+  this->decode_reset();
+
+  // Back to back delimiters are allowed and don't produce empty frames
+  // Discarded frames have already been counted when they were dropped
+  if (!in_frame || discard) {
+    return;
+  }
+  if (truncated || length < this->crc_size) {
+    this->framing_error_count++;
+    return;
+  }
+  if (this->frames_ready >= this->frame_count) {
+    this->dropped_frame_count++;
+    return;
+  }
+
+  uint8_t write_index = (this->frame_read_index + this->frames_ready) % this->frame_count;
+  uint8_t* frame = this->get_frame_buffer(write_index);
+  size_t size = length - this->crc_size;
+  if (this->crc != FRAMING_CRC_NONE) {
+    uint32_t received_crc = 0u;
+    for (uint8_t i = 0u; i < this->crc_size; i++) {
+      received_crc |= (uint32_t)frame[size + i] << (8u * i);
+    }
+    if (received_crc != FramedStream::calculateCrc(this->crc, frame, size)) {
+      this->crc_error_count++;
+      return;
+    }
+  }
+
+  if (this->frame_callback != nullptr) {
+    // The buffer is reused as soon as the callback returns
+    this->frame_callback(frame, size);
+    return;
+  }
+  this->frame_sizes[write_index] = size;
+  this->frames_ready++;
+}
+
+void FramedStream::decode_reset()
+{
+  this->rx_length = 0u;
+  this->rx_in_frame = false;
+  this->rx_discard = false;
+  this->rx_slip_escape = false;
+  this->rx_cobs_code = 0u;
+  this->rx_cobs_remaining = 0u;
+}
+
+void FramedStream::encode_put(uint8_t data)
+{
+  this->tx_stage[this->tx_stage_length++] = data;
+  if (this->tx_stage_length >= tx_stage_size) {
+    this->encode_flush();
+  }
+}
+
+void FramedStream::encode_flush()
+{
+  if (this->tx_stage_length == 0u) {
+    return;
+  }
+  if (this->stream.write(this->tx_stage, this->tx_stage_length) != this->tx_stage_length) {
+    this->tx_failed = true;
+  }
+  this->tx_stage_length = 0u;
+}
+
+uint8_t* FramedStream::get_frame_buffer(uint8_t index)
+{
+  return this->frame_pool + (size_t)index * this->frame_buffer_size;
+}
+
+static uint8_t get_crc_size(framing_crc_t crc)
+{
+  switch (crc) {
+    case FRAMING_CRC16:
+      return 2u;
+    case FRAMING_CRC32:
+      return 4u;
+    default:
+      return 0u;
+  }
+}
+
+static uint32_t crc_software(framing_crc_t type, const uint8_t* data, size_t size)
+{
+  if (type == FRAMING_CRC32) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0u; i < size; i++) {
+      crc ^= data[i];
+      crc = (crc >> 4) ^ crc32_table[crc & 0x0Fu];
+      crc = (crc >> 4) ^ crc32_table[crc & 0x0Fu];
+    }
+    return crc ^ 0xFFFFFFFFu;
+  }
+
+  uint16_t crc = 0xFFFFu;
+  for (size_t i = 0u; i < size; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ crc16_table[crc & 0x0Fu];
+    crc = (crc >> 4) ^ crc16_table[crc & 0x0Fu];
+  }
+  return (uint16_t)(crc ^ 0xFFFFu);
+}
+
+static uint32_t crc_hardware(framing_crc_t type, const uint8_t* data, size_t size)
+{
+  CMU_ClockEnable(cmuClock_GPCRC, true);
+  GPCRC->EN = GPCRC_EN_EN;
+  // The GPCRC shifts the data in LSB first - the polynomials are written in reflected form
+  if (type == FRAMING_CRC32) {
+    GPCRC->CTRL = GPCRC_CTRL_POLYSEL_CRC32;
+    GPCRC->INIT = 0xFFFFFFFFu;
+  } else {
+    GPCRC->CTRL = GPCRC_CTRL_POLYSEL_CRC16;
+    GPCRC->POLY = 0x8408u;
+    GPCRC->INIT = 0xFFFFu;
+  }
+  GPCRC->CMD = GPCRC_CMD_INIT;
+
+  // Feed the bytes up to a word boundary one by one, then whole words
+  while (size > 0u && ((uintptr_t)data & 0x3u) != 0u) {
+    GPCRC->INPUTDATABYTE = *data++;
+    size--;
+  }
+  while (size >= 4u) {
+    GPCRC->INPUTDATA = *(const uint32_t*)data;
+    data += 4u;
+    size -= 4u;
+  }
+  while (size > 0u) {
+    GPCRC->INPUTDATABYTE = *data++;
+    size--;
+  }
+
+  uint32_t result = GPCRC->DATA;
+  GPCRC->EN = 0u;
+  if (type == FRAMING_CRC32) {
+    return result ^ 0xFFFFFFFFu;
+  }
+  return (result ^ 0xFFFFu) & 0xFFFFu;
+}
@@ -0,0 +1,235 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Framed binary transport (COBS/SLIP + CRC) over any Stream
+
+#include "Arduino.h"
+
+#ifndef SILABS_FRAMING_H
+#define SILABS_FRAMING_H
+
+#include <inttypes.h>
+#include "api/Stream.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "Serial.h"
+
+enum framing_mode_t {
+  FRAMING_COBS = 0,   // Consistent Overhead Byte Stuffing - frames are terminated by a zero byte
+  FRAMING_SLIP        // Serial Line Internet Protocol (RFC 1055) - frames are terminated by 0xC0, empty frames are only received with a CRC
+};
+
+enum framing_crc_t {
+  FRAMING_CRC_NONE = 0,   // No integrity check
+  FRAMING_CRC16,          // CRC-16/X-25 (reflected 0x1021, as used by HDLC) - 2 bytes, little endian
+  FRAMING_CRC32           // CRC-32 (IEEE 802.3, as used by zlib) - 4 bytes, little endian
+};
+
+namespace arduino {
+class FramedStream {
+public:
+  /***************************************************************************//**
+   * Constructor for FramedStream
+   *
+   * @param[in] stream the Stream to send and receive the frames on (e.g. ezBLE)
+   * @param[in] mode the byte stuffing used to delimit the frames
+   * @param[in] crc the CRC appended to each frame
+   ******************************************************************************/
+  FramedStream(Stream& stream, framing_mode_t mode = FRAMING_COBS, framing_crc_t crc = FRAMING_CRC16);
+
+  /***************************************************************************//**
+   * Constructor for FramedStream on a serial port
+   * The received data is decoded directly from the serial receive buffer without
+   * reading it byte by byte.
+   *
+   * @param[in] serial the serial port to send and receive the frames on
+   * @param[in] mode the byte stuffing used to delimit the frames
+   * @param[in] crc the CRC appended to each frame
+   ******************************************************************************/
+  FramedStream(UARTClass& serial, framing_mode_t mode = FRAMING_COBS, framing_crc_t crc = FRAMING_CRC16);
+
+  /***************************************************************************//**
+   * Destructor for FramedStream
+   ******************************************************************************/
+  ~FramedStream();
+
+  /***************************************************************************//**
+   * Allocates the receive frame pool and starts decoding frames
+   * The underlying Stream has to be started separately (e.g. with 'Serial.begin()').
+   *
+   * @param[in] max_frame_size the largest frame payload to be received in bytes
+   * @param[in] frame_count the number of received frames which can be held at once
+   *
+   * @return true on success, false if the parameters are invalid or the allocation failed
+   ******************************************************************************/
+  bool begin(size_t max_frame_size = default_max_frame_size, uint8_t frame_count = default_frame_count);
+
+  /***************************************************************************//**
+   * Stops decoding frames and frees the receive frame pool
+   ******************************************************************************/
+  void end();
+
+  /***************************************************************************//**
+   * Sets the function which should be called for each received frame
+   * The callback gets the frame in place in the frame pool - the data is only
+   * valid until the callback returns. If no callback is set the frames are queued
+   * and can be fetched with 'peekFrame()'.
+   *
+   * @param[in] callback pointer to the callback function, nullptr to queue the frames
+   ******************************************************************************/
+  void onFrame(void (*callback)(const uint8_t* data, size_t size));
+
+  /***************************************************************************//**
+   * Reads and decodes all the data available on the Stream
+   * Has to be called periodically (e.g. from 'loop()'). The frame callback is
+   * called from here.
+   ******************************************************************************/
+  void poll();
+
+  /***************************************************************************//**
+   * Encodes and sends a frame
+   * The frame is encoded on the fly while it's written to the Stream, no
+   * intermediate copy of the whole frame is made.
+   *
+   * @param[in] data pointer to the frame payload
+   * @param[in] size size of the frame payload in bytes
+   *
+   * @return the number of payload bytes sent - 'size' on success, 0 on failure
+   ******************************************************************************/
+  size_t writeFrame(const uint8_t* data, size_t size);
+
+  /***************************************************************************//**
+   * Returns the number of received frames waiting in the queue
+   *
+   * @return the number of queued frames
+   ******************************************************************************/
+  uint8_t available();
+
+  /***************************************************************************//**
+   * Returns the oldest queued frame without copying it
+   * The frame stays in the pool until it's released with 'releaseFrame()'.
+   *
+   * @param[out] size set to the size of the frame payload in bytes
+   *
+   * @return pointer to the frame payload, nullptr if there are no queued frames
+   ******************************************************************************/
+  const uint8_t* peekFrame(size_t* size);
+
+  /***************************************************************************//**
+   * Releases the oldest queued frame and makes its buffer available for reception
+   ******************************************************************************/
+  void releaseFrame();
+
+  /***************************************************************************//**
+   * Returns the number of frames dropped because of a CRC mismatch
+   *
+   * @return the number of CRC errors
+   ******************************************************************************/
+  uint32_t getCrcErrorCount();
+
+  /***************************************************************************//**
+   * Returns the number of frames dropped because of invalid encoding
+   * Also counts the frames which were larger than the maximum frame size.
+   *
+   * @return the number of framing errors
+   ******************************************************************************/
+  uint32_t getFramingErrorCount();
+
+  /***************************************************************************//**
+   * Returns the number of frames dropped because all the frame buffers were in use
+   *
+   * @return the number of dropped frames
+   ******************************************************************************/
+  uint32_t getDroppedFrameCount();
+
+  /***************************************************************************//**
+   * Resets the error counters to zero
+   ******************************************************************************/
+  void clearErrorCounters();
+
+  /***************************************************************************//**
+   * Calculates the CRC of a buffer
+   * Uses the GPCRC peripheral if it's free, falls back to software otherwise.
+   *
+   * @param[in] type the CRC to calculate
+   * @param[in] data pointer to the data
+   * @param[in] size size of the data in bytes
+   *
+   * @return the CRC value, 0 for FRAMING_CRC_NONE
+   ******************************************************************************/
+  static uint32_t calculateCrc(framing_crc_t type, const uint8_t* data, size_t size);
+
+  static const size_t default_max_frame_size = 256u;
+  static const uint8_t default_frame_count = 4u;
+
+private:
+  FramedStream(Stream& stream, UARTClass* serial, framing_mode_t mode, framing_crc_t crc);
+  void decode(const uint8_t* data, size_t size);
+  void decode_byte(uint8_t data);
+  void decode_append(uint8_t data);
+  void decode_frame_end();
+  void decode_reset();
+  void encode_put(uint8_t data);
+  void encode_flush();
+  uint8_t* get_frame_buffer(uint8_t index);
+
+  static const size_t tx_stage_size = 64u;
+
+  Stream& stream;
+  UARTClass* const serial;
+  const framing_mode_t mode;
+  const framing_crc_t crc;
+  const uint8_t crc_size;
+
+  uint8_t* frame_pool;
+  size_t* frame_sizes;
+  size_t frame_buffer_size;
+  uint8_t frame_count;
+  uint8_t frame_read_index;
+  uint8_t frames_ready;
+  void (*frame_callback)(const uint8_t* data, size_t size);
+
+  // Receive decoder state
+  size_t rx_length;
+  bool rx_in_frame;
+  bool rx_discard;
+  bool rx_slip_escape;
+  uint8_t rx_cobs_code;
+  uint8_t rx_cobs_remaining;
+
+  uint32_t crc_error_count;
+  uint32_t framing_error_count;
+  uint32_t dropped_frame_count;
+
+  uint8_t tx_stage[tx_stage_size];
+  size_t tx_stage_length;
+  bool tx_failed;
+  SemaphoreHandle_t tx_mutex;
+  StaticSemaphore_t tx_mutex_buf;
+};
+} // namespace arduino
+
+#endif // SILABS_FRAMING_H
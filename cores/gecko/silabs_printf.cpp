@@ -0,0 +1,394 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "silabs_printf.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace arduino;
+
+typedef struct {
+  bool left_align;
+  bool zero_pad;
+  bool plus_sign;
+  bool space_sign;
+  bool alternate;
+  int width;
+  int precision;
+  char length[3];
+  char conversion;
+} format_spec_t;
+
+static size_t write_padding(Print& output, char pad, int count);
+static size_t write_padded(Print& output, const char* data, size_t size, const format_spec_t& spec);
+static size_t write_integer(Print& output, unsigned long long value, bool negative, const format_spec_t& spec);
+static void build_spec_string(const format_spec_t& spec, const char* length, char* buf, size_t buf_size);
+template<typename T>
+static size_t write_formatted(Print& output, const char* spec_string, T value);
+
+size_t silabs_vprintf(Print& output, const char* fmt, va_list args)
+{
+  size_t written = 0u;
+  const char* literal_start = fmt;
+
+  while (*fmt != '\0') {
+    if (*fmt != '%') {
+      fmt++;
+      continue;
+    }
+
+    // Write the literal part preceding the conversion straight from the format string
+    if (fmt > literal_start) {
+      written += output.write((const uint8_t*)literal_start, fmt - literal_start);
+    }
+    const char* spec_start = fmt;
+    fmt++;
+
+    format_spec_t spec = {};
+    spec.precision = -1;
+
+    // Flags
+    for (;; fmt++) {
+      if (*fmt == '-') {
+        spec.left_align = true;
+      } else if (*fmt == '0') {
+        spec.zero_pad = true;
+      } else if (*fmt == '+') {
+        spec.plus_sign = true;
+      } else if (*fmt == ' ') {
+        spec.space_sign = true;
+      } else if (*fmt == '#') {
+        spec.alternate = true;
+      } else {
+        break;
+      }
+    }
+
+    // Width
+    if (*fmt == '*') {
+      spec.width = va_arg(args, int);
+      if (spec.width < 0) {
+        spec.left_align = true;
+        spec.width = -spec.width;
+      }
+      fmt++;
+    } else {
+      while (*fmt >= '0' && *fmt <= '9') {
+        spec.width = spec.width * 10 + (*fmt - '0');
+        fmt++;
+      }
+    }
+
+    // Precision
+    if (*fmt == '.') {
+      fmt++;
+      spec.precision = 0;
+      if (*fmt == '*') {
+        spec.precision = va_arg(args, int);
+        fmt++;
+      } else {
+        while (*fmt >= '0' && *fmt <= '9') {
+          spec.precision = spec.precision * 10 + (*fmt - '0');
+          fmt++;
+        }
+      }
+    }
+
+    // Length modifier
+    uint8_t length_idx = 0u;
+    while ((*fmt == 'h' || *fmt == 'l' || *fmt == 'z' || *fmt == 'j' || *fmt == 't' || *fmt == 'L')
+           && length_idx < sizeof(spec.length) - 1) {
+      spec.length[length_idx++] = *fmt;
+      fmt++;
+    }
+    bool is_long_long = (strcmp(spec.length, "ll") == 0) || (spec.length[0] == 'j');
+    bool is_long = (spec.length[0] == 'l' && !is_long_long) || (spec.length[0] == 'z') || (spec.length[0] == 't');
+
+    spec.conversion = *fmt;
+    if (spec.conversion == '\0') {
+      // Incomplete conversion at the end of the format string - write it as is
+      literal_start = spec_start;
+      break;
+    }
+    fmt++;
+    literal_start = fmt;
+
+    // The integer, character and string conversions are handled here, the rest goes to the C library
+    switch (spec.conversion) {
+      case '%':
+        written += output.write((uint8_t)'%');
+        continue;
+
+      case 'c': {
+        char c = (char)va_arg(args, int);
+        written += write_padded(output, &c, 1u, spec);
+        continue;
+      }
+
+      case 's': {
+        const char* str = va_arg(args, const char*);
+        if (str == nullptr) {
+          str = "(null)";
+        }
+        size_t size = (spec.precision >= 0) ? strnlen(str, (size_t)spec.precision) : strlen(str);
+        written += write_padded(output, str, size, spec);
+        continue;
+      }
+
+      case 'd':
+      case 'i': {
+        long long value;
+        if (is_long_long) {
+          value = va_arg(args, long long);
+        } else if (is_long) {
+          value = va_arg(args, long);
+        } else {
+          value = va_arg(args, int);
+        }
+        if (spec.length[0] == 'h') {
+          value = (spec.length[1] == 'h') ? (long long)(signed char)value : (long long)(short)value;
+        }
+        bool negative = value < 0;
+        unsigned long long magnitude = negative ? (0ull - (unsigned long long)value) : (unsigned long long)value;
+        written += write_integer(output, magnitude, negative, spec);
+        continue;
+      }
+
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o': {
+        unsigned long long value;
+        if (is_long_long) {
+          value = va_arg(args, unsigned long long);
+        } else if (is_long) {
+          value = va_arg(args, unsigned long);
+        } else {
+          value = va_arg(args, unsigned int);
+        }
+        if (spec.length[0] == 'h') {
+          value = (spec.length[1] == 'h') ? (unsigned char)value : (unsigned short)value;
+        }
+        written += write_integer(output, value, false, spec);
+        continue;
+      }
+
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        char spec_string[32];
+        build_spec_string(spec, spec.length, spec_string, sizeof(spec_string));
+        if (spec.length[0] == 'L') {
+          written += write_formatted(output, spec_string, va_arg(args, long double));
+        } else {
+          written += write_formatted(output, spec_string, va_arg(args, double));
+        }
+        continue;
+      }
+
+      case 'p': {
+        char spec_string[32];
+        build_spec_string(spec, "", spec_string, sizeof(spec_string));
+        written += write_formatted(output, spec_string, va_arg(args, void*));
+        continue;
+      }
+
+      case 'n':
+        // Writing back the number of characters is not supported - skip the argument
+        (void)va_arg(args, void*);
+        continue;
+
+      default:
+        // Unknown conversion - write it as is
+        written += output.write((const uint8_t*)spec_start, fmt - spec_start);
+        continue;
+    }
+  }
+
+  if (*literal_start != '\0') {
+    written += output.write((const uint8_t*)literal_start, strlen(literal_start));
+  }
+  return written;
+}
+
+// Writes 'count' pieces of the padding character
+static size_t write_padding(Print& output, char pad, int count)
+{
+  static const char spaces[] = "                ";
+  static const char zeros[] = "0000000000000000";
+  const char* source = (pad == '0') ? zeros : spaces;
+  size_t written = 0u;
+  while (count > 0) {
+    int chunk = (count > (int)(sizeof(spaces) - 1u)) ? (int)(sizeof(spaces) - 1u) : count;
+    written += output.write((const uint8_t*)source, (size_t)chunk);
+    count -= chunk;
+  }
+  return written;
+}
+
+// Writes the data aligned to the field width of the conversion
+static size_t write_padded(Print& output, const char* data, size_t size, const format_spec_t& spec)
+{
+  size_t written = 0u;
+  int padding = spec.width - (int)size;
+  if (!spec.left_align) {
+    written += write_padding(output, ' ', padding);
+  }
+  if (size > 0u) {
+    written += output.write((const uint8_t*)data, size);
+  }
+  if (spec.left_align) {
+    written += write_padding(output, ' ', padding);
+  }
+  return written;
+}
+
+// Converts an integer to text and writes it with the sign and padding of the conversion
+static size_t write_integer(Print& output, unsigned long long value, bool negative, const format_spec_t& spec)
+{
+  // Enough for a 64 bit value in octal
+  char digits[23];
+  uint8_t base = 10u;
+  const char* digit_chars = "0123456789abcdef";
+  if (spec.conversion == 'x') {
+    base = 16u;
+  } else if (spec.conversion == 'X') {
+    base = 16u;
+    digit_chars = "0123456789ABCDEF";
+  } else if (spec.conversion == 'o') {
+    base = 8u;
+  }
+
+  // Fill the digits from the end - 32 bit values avoid the slow 64 bit division
+  // A precision of zero prints nothing for a zero value
+  size_t pos = sizeof(digits);
+  bool is_zero = (value == 0u);
+  if (value > UINT32_MAX) {
+    do {
+      digits[--pos] = digit_chars[value % base];
+      value /= base;
+    } while (value != 0u);
+  } else if (!is_zero || spec.precision != 0) {
+    uint32_t value32 = (uint32_t)value;
+    do {
+      digits[--pos] = digit_chars[value32 % base];
+      value32 /= base;
+    } while (value32 != 0u);
+  }
+  size_t digit_count = sizeof(digits) - pos;
+
+  // The precision gives the minimum number of digits
+  int leading_zeros = (spec.precision > (int)digit_count) ? spec.precision - (int)digit_count : 0;
+
+  // Sign or the alternate form prefix
+  const char* prefix = "";
+  if (negative) {
+    prefix = "-";
+  } else if (spec.plus_sign && (spec.conversion == 'd' || spec.conversion == 'i')) {
+    prefix = "+";
+  } else if (spec.space_sign && (spec.conversion == 'd' || spec.conversion == 'i')) {
+    prefix = " ";
+  } else if (spec.alternate && spec.conversion == 'x' && !is_zero) {
+    prefix = "0x";
+  } else if (spec.alternate && spec.conversion == 'X' && !is_zero) {
+    prefix = "0X";
+  } else if (spec.alternate && spec.conversion == 'o' && leading_zeros == 0 && (digit_count == 0u || digits[pos] != '0')) {
+    leading_zeros = 1;
+  }
+  size_t prefix_size = strlen(prefix);
+
+  // Zero padding is ignored when a precision is given
+  bool zero_pad = spec.zero_pad && !spec.left_align && spec.precision < 0;
+  int padding = spec.width - (int)digit_count - leading_zeros - (int)prefix_size;
+  size_t written = 0u;
+  if (!spec.left_align && !zero_pad) {
+    written += write_padding(output, ' ', padding);
+  }
+  if (prefix_size > 0u) {
+    written += output.write((const uint8_t*)prefix, prefix_size);
+  }
+  if (zero_pad) {
+    written += write_padding(output, '0', padding);
+  }
+  written += write_padding(output, '0', leading_zeros);
+  if (digit_count > 0u) {
+    written += output.write((const uint8_t*)&digits[pos], digit_count);
+  }
+  if (spec.left_align) {
+    written += write_padding(output, ' ', padding);
+  }
+  return written;
+}
+
+// Rebuilds a single conversion specification for the C library with the given length modifier
+static void build_spec_string(const format_spec_t& spec, const char* length, char* buf, size_t buf_size)
+{
+  char precision[12] = "";
+  if (spec.precision >= 0) {
+    snprintf(precision, sizeof(precision), ".%d", spec.precision);
+  }
+  snprintf(buf, buf_size, "%%%s%s%s%s%s%.0d%s%s%c",
+           spec.left_align ? "-" : "",
+           spec.zero_pad ? "0" : "",
+           spec.plus_sign ? "+" : "",
+           spec.space_sign ? " " : "",
+           spec.alternate ? "#" : "",
+           spec.width,
+           precision,
+           length,
+           spec.conversion);
+}
+
+// Formats a single value with the C library and writes it to the output
+template<typename T>
+static size_t write_formatted(Print& output, const char* spec_string, T value)
+{
+  char buf[32];
+  int size = snprintf(buf, sizeof(buf), spec_string, value);
+  if (size <= 0) {
+    return 0u;
+  }
+  if ((size_t)size < sizeof(buf)) {
+    return output.write((const uint8_t*)buf, (size_t)size);
+  }
+
+  // The result doesn't fit the local buffer - format it again into a large enough one
+  char* large_buf = (char*)malloc((size_t)size + 1u);
+  if (large_buf == nullptr) {
+    return output.write((const uint8_t*)buf, sizeof(buf) - 1u);
+  }
+  snprintf(large_buf, (size_t)size + 1u, spec_string, value);
+  size_t written = output.write((const uint8_t*)large_buf, (size_t)size);
+  free(large_buf);
+  return written;
+}
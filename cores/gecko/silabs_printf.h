@@ -0,0 +1,51 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Streaming printf for the Print based transports
+
+#ifndef SILABS_PRINTF_H
+#define SILABS_PRINTF_H
+
+#include "Arduino.h"
+#include <cstdarg>
+
+/***************************************************************************//**
+ * Formats a string and writes it directly to a Print output
+ * The output is written in pieces as the format string is processed - there's no
+ * intermediate buffer and no length limit. The literal parts of the format string
+ * are written as is, the '%d', '%i', '%u', '%x', '%X', '%o', '%c', '%s' and '%%'
+ * conversions are handled by a fast integer-only path. All other conversions
+ * (e.g. floating point) are formatted one by one with the C library.
+ *
+ * @param[in] output the Print instance to write the formatted string to
+ * @param[in] fmt the format string
+ * @param[in] args the arguments for the format string
+ *
+ * @return the number of bytes written to the output
+ ******************************************************************************/
+size_t silabs_vprintf(arduino::Print& output, const char* fmt, va_list args);
+
+#endif // SILABS_PRINTF_H
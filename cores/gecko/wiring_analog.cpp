@@ -65,6 +65,35 @@ void analogReadDMA(pin_size_t pin, uint32_t *buffer, uint32_t size, void (*user_
   analogReadDMA(pin_name, buffer, size, user_onsampling_finished_callback);
 }
 
+bool analogMonitorStart(PinName pin, uint16_t low, uint16_t high, uint32_t period_ms, void (*user_onwindow_exit_callback)(uint16_t))
+{
+  return ADC.monitor_start(pin, low, high, period_ms, user_onwindow_exit_callback) == SL_STATUS_OK;
+}
+
+bool analogMonitorStart(pin_size_t pin, uint16_t low, uint16_t high, uint32_t period_ms, void (*user_onwindow_exit_callback)(uint16_t))
+{
+  PinName pin_name = pinToPinName(pin);
+  if (pin_name == PIN_NAME_NC) {
+    return false;
+  }
+  return analogMonitorStart(pin_name, low, high, period_ms, user_onwindow_exit_callback);
+}
+
+bool analogMonitorSetWindow(uint16_t low, uint16_t high)
+{
+  return ADC.monitor_set_window(low, high) == SL_STATUS_OK;
+}
+
+int analogMonitorRead()
+{
+  return (int)ADC.monitor_get_sample();
+}
+
+void analogMonitorStop()
+{
+  ADC.monitor_stop();
+}
+
 void analogReferenceDAC(uint8_t reference)
 {
   #if (NUM_DAC_HW > 0)
@@ -149,6 +178,57 @@ void analogWriteResolution(int resolution)
   #endif // (NUM_DAC_HW > 1)
 }
 
+bool analogWriteResolution(pin_size_t pin, int resolution)
+{
+  PinName pin_name = pinToPinName(pin);
+  if (pin_name == PIN_NAME_NC || resolution < 0) {
+    return false;
+  }
+  return analogWriteResolution(pin_name, resolution);
+}
+
+bool analogWriteResolution(PinName pin, int resolution)
+{
+  if (resolution < 0) {
+    return false;
+  }
+  return PWM.duty_cycle_mode_set_write_resolution(pin, (uint8_t)resolution);
+}
+
+bool analogWriteFrequency(pin_size_t pin, uint32_t frequency)
+{
+  PinName pin_name = pinToPinName(pin);
+  if (pin_name == PIN_NAME_NC) {
+    return false;
+  }
+  return analogWriteFrequency(pin_name, frequency);
+}
+
+bool analogWriteFrequency(PinName pin, uint32_t frequency)
+{
+  return PWM.duty_cycle_mode_set_frequency(pin, frequency);
+}
+
+bool analogWriteBatch(const pin_size_t* pins, const int* values, uint8_t count)
+{
+  if (pins == nullptr || count > PwmClass::max_pwm_channels) {
+    return false;
+  }
+  PinName pin_names[PwmClass::max_pwm_channels];
+  for (uint8_t i = 0; i < count; i++) {
+    pin_names[i] = pinToPinName(pins[i]);
+    if (pin_names[i] == PIN_NAME_NC) {
+      return false;
+    }
+  }
+  return analogWriteBatch(pin_names, values, count);
+}
+
+bool analogWriteBatch(const PinName* pins, const int* values, uint8_t count)
+{
+  return PWM.duty_cycle_mode_batch(pins, values, count);
+}
+
 void analogReadResolution(int resolution)
 {
   ADC.set_read_resolution((uint8_t)resolution);
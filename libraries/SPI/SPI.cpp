@@ -26,18 +26,48 @@
 
 #include "SPI.h"
 #include "arduino_spi_config.h"
+#include "em_core.h"
 
 using namespace arduino;
 
 SilabsSPI::SilabsSPI(SPIDRV_Handle_t sl_spidrv_handle, SPIDRV_Init_t* sl_spidrv_config, SPIDRV_Callback_t dma_transfer_finished_callback) :
-  initialized(false)
+  initialized(false),
+  dma_threshold(SPI_DMA_THRESHOLD),
+  settings_valid(false),
+  settings_cache(),
+  settings_cache_use_count(0),
+  async_queue_head(nullptr),
+  async_queue_tail(nullptr),
+  async_current(nullptr),
+  bus_reserved(false),
+  sync_transfer_active(false),
+  dma_descriptor_capacity(dma_descriptors_internal),
+  dma_tx_dummy(0u),
+  dma_rx_dummy(0u),
+  dma_transfer_active(false),
+  dma_wait_blocking(false),
+  follower_mode(false),
+  follower_callbacks_enabled(false),
+  leader_config(),
+  follower_cs_port(gpioPortA),
+  follower_cs_port_pin(0u),
+  follower_cs_interrupt_num(0u),
+  follower_tx_buf(nullptr),
+  follower_rx_buf(nullptr),
+  follower_size(0u),
+  follower_armed(false),
+  follower_callback(nullptr)
 {
   this->sl_spidrv_handle = sl_spidrv_handle;
   this->sl_spidrv_config = sl_spidrv_config;
   this->dma_transfer_finished_callback = dma_transfer_finished_callback;
+  this->dma_tx_descriptors = this->dma_descriptors_default;
+  this->dma_rx_descriptors = this->dma_descriptors_default + dma_descriptors_internal;
 
   this->spi_transfer_mutex = xSemaphoreCreateMutexStatic(&this->spi_transfer_mutex_buf);
   configASSERT(this->spi_transfer_mutex);
+  this->spi_dma_done_sem = xSemaphoreCreateBinaryStatic(&this->spi_dma_done_sem_buf);
+  configASSERT(this->spi_dma_done_sem);
   this->spi_busy_mutex = xSemaphoreCreateMutexStatic(&this->spi_busy_mutex_buf);
   configASSERT(this->spi_busy_mutex);
 }
@@ -51,59 +81,70 @@ void SilabsSPI::begin()
   if (sc == SL_STATUS_OK) {
     this->initialized = true;
   }
+  // The peripheral is configured from the driver configuration - the registers are calculated again
+  this->settings_valid = false;
+  for (uint8_t i = 0u; i < settings_cache_size; i++) {
+    this->settings_cache[i].valid = false;
+  }
 }
 
 void SilabsSPI::beginTransaction(SPISettings settings)
 {
   xSemaphoreTake(this->spi_busy_mutex, portMAX_DELAY);
-  // Don't do anything if the settings don't change
-  if (this->settings.getClockFreq() == settings.getClockFreq()
-      && this->settings.getBitOrder() == settings.getBitOrder()
-      && this->settings.getDataMode() == settings.getDataMode()) {
-    return;
-  }
-  // Deinit the peripheral
-  SPIDRV_DeInit(this->sl_spidrv_handle);
-  // Apply the new settings
-  this->sl_spidrv_config->bitRate = settings.getClockFreq();
-  setBitOrder(settings.getBitOrder());
-  setDataMode(settings.getDataMode());
-  // Reinit the peripheral
-  SPIDRV_Init(this->sl_spidrv_handle, this->sl_spidrv_config);
+  // Queued asynchronous transactions are held back until 'endTransaction()' - the running one finishes first
+  this->bus_reserved = true;
+  this->async_wait_idle();
+  // Only the registers which differ from the current settings are written
+  this->apply_settings(settings);
 }
 
-// Uses direct blocking transfers with the USART/EUSART driver
+// Uses direct blocking transfers by polling the FIFO
 uint8_t SilabsSPI::transfer(uint8_t data)
 {
   uint8_t rx_byte = 0u;
   xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-  rx_byte = sl_spi_direct_transfer((void*)this->sl_spidrv_config->port, data);
+  this->sync_claim();
+  this->fifo_transfer(&data, &rx_byte, 1u);
+  this->sync_release();
   xSemaphoreGive(this->spi_transfer_mutex);
   return rx_byte;
 }
 
-// Uses direct blocking transfers with the USART/EUSART driver
+// Uses direct blocking transfers by polling the FIFO
 uint16_t SilabsSPI::transfer16(uint16_t data)
 {
-  uint16_t rx_bytes = 0u;
   uint8_t rx_data[2];
   uint8_t tx_data[2];
   tx_data[0] = (uint8_t)(data >> 8);
   tx_data[1] = (uint8_t)data;
-  rx_data[0] = this->transfer(tx_data[0]);
-  rx_data[1] = this->transfer(tx_data[1]);
-  rx_bytes = ((uint16_t)rx_data[0] << 8) + rx_data[1];
-  return rx_bytes;
+  xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
+  this->sync_claim();
+  this->fifo_transfer(tx_data, rx_data, sizeof(tx_data));
+  this->sync_release();
+  xSemaphoreGive(this->spi_transfer_mutex);
+  return ((uint16_t)rx_data[0] << 8) + rx_data[1];
+}
+
+// Uses direct blocking transfers by polling the FIFO
+uint32_t SilabsSPI::transfer32(uint32_t data)
+{
+  uint8_t rx_data[4];
+  uint8_t tx_data[4];
+  tx_data[0] = (uint8_t)(data >> 24);
+  tx_data[1] = (uint8_t)(data >> 16);
+  tx_data[2] = (uint8_t)(data >> 8);
+  tx_data[3] = (uint8_t)data;
+  xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
+  this->sync_claim();
+  this->fifo_transfer(tx_data, rx_data, sizeof(tx_data));
+  this->sync_release();
+  xSemaphoreGive(this->spi_transfer_mutex);
+  return ((uint32_t)rx_data[0] << 24) + ((uint32_t)rx_data[1] << 16) + ((uint32_t)rx_data[2] << 8) + rx_data[3];
 }
 
-// Uses DMA and waits for the transaction to complete, has a large overhead for small amounts of data
 void SilabsSPI::transfer(void* tx_buf, size_t count, bool block)
 {
-  if (block) {
-    this->_transfer_block(tx_buf, count);
-  } else {
-    this->_transfer_nonblock(tx_buf, count);
-  }
+  this->buffer_transfer(tx_buf, nullptr, count, block);
 }
 
 void SilabsSPI::transfer(void *buf, size_t count)
@@ -115,81 +156,9 @@ void SilabsSPI::transfer(void *buf, size_t count)
   this->transfer(buf, buf, count, true);
 }
 
-void SilabsSPI::_transfer_block(void* tx_buf, size_t count)
-{
-  size_t bytes_transferred = 0;
-  // Go while we still have bytes to transfer
-  while (bytes_transferred < count) {
-    size_t current_transfer_size = get_next_dma_transfer_size(bytes_transferred, count);
-    // Start the data transfer with DMA
-    SPIDRV_MTransmitB(sl_spidrv_handle, (uint8_t*)tx_buf + bytes_transferred, current_transfer_size);
-    // Add the transferred amount to the total transferred bytes
-    bytes_transferred += current_transfer_size;
-  }
-}
-
-void SilabsSPI::_transfer_nonblock(void* tx_buf, size_t count)
-{
-  size_t bytes_transferred = 0;
-
-  // Take the transfer mutex
-  xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-  // Go while we still have bytes to transfer
-  while (bytes_transferred < count) {
-    size_t current_transfer_size = get_next_dma_transfer_size(bytes_transferred, count);
-    // Start the data transfer with DMA
-    SPIDRV_MTransmit(sl_spidrv_handle, (uint8_t*)tx_buf + bytes_transferred, current_transfer_size, this->dma_transfer_finished_callback);
-    // Try to take the mutex again - current task will be blocked here until the transfer finishes
-    // The dma_transfer_finished_callback will give the mutex back and the next chunk transfer will start then
-    xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-    // Add the transferred amount to the total transferred bytes
-    bytes_transferred += current_transfer_size;
-  }
-  // Give back the transfer mutex
-  xSemaphoreGive(this->spi_transfer_mutex);
-}
-
 void SilabsSPI::transfer(void* tx_buf, void* rx_buf, size_t count, bool block)
 {
-  if (block) {
-    this->_transfer_block(tx_buf, rx_buf, count);
-  } else {
-    this->_transfer_nonblock(tx_buf, rx_buf, count);
-  }
-}
-
-void SilabsSPI::_transfer_block(void* tx_buf, void* rx_buf, size_t count)
-{
-  size_t bytes_transferred = 0;
-  // Go while we still have bytes to transfer
-  while (bytes_transferred < count) {
-    size_t current_transfer_size = get_next_dma_transfer_size(bytes_transferred, count);
-    // Transfer the data
-    SPIDRV_MTransferB(this->sl_spidrv_handle, tx_buf, rx_buf, current_transfer_size);
-    // Add the transferred amount to the total transferred bytes
-    bytes_transferred += current_transfer_size;
-  }
-}
-
-void SilabsSPI::_transfer_nonblock(void* tx_buf, void* rx_buf, size_t count)
-{
-  size_t bytes_transferred = 0;
-
-  // Take the transfer mutex
-  xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-  // Go while we still have bytes to transfer
-  while (bytes_transferred < count) {
-    size_t current_transfer_size = get_next_dma_transfer_size(bytes_transferred, count);
-    // Transfer the data
-    SPIDRV_MTransfer(this->sl_spidrv_handle, tx_buf, rx_buf, current_transfer_size, this->dma_transfer_finished_callback);
-    // Try to take the mutex again - current task will be blocked here until the transfer finishes
-    // The dma_transfer_finished_callback will give the mutex back and the next chunk transfer will start then
-    xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-    // Add the transferred amount to the total transferred bytes
-    bytes_transferred += current_transfer_size;
-  }
-  // Give back the transfer mutex
-  xSemaphoreGive(this->spi_transfer_mutex);
+  this->buffer_transfer(tx_buf, rx_buf, count, block);
 }
 
 uint8_t SilabsSPI::receive()
@@ -204,54 +173,106 @@ uint16_t SilabsSPI::receive16()
 
 void SilabsSPI::receive(void* rx_buf, size_t count, bool block)
 {
-  if (block) {
-    this->_receive_block(rx_buf, count);
-  } else {
-    this->_receive_nonblock(rx_buf, count);
-  }
+  this->buffer_transfer(nullptr, rx_buf, count, block);
 }
 
-void SilabsSPI::_receive_block(void* rx_buf, size_t count)
+void SilabsSPI::endTransaction(void)
 {
-  size_t bytes_received = 0;
-  // Go while we still have bytes to receive
-  while (bytes_received < count) {
-    size_t current_transfer_size = get_next_dma_transfer_size(bytes_received, count);
-    // Receive the data
-    SPIDRV_MReceiveB(this->sl_spidrv_handle, rx_buf, current_transfer_size);
-    // Add the transferred amount to the total transferred bytes
-    bytes_received += current_transfer_size;
+  // Start the transactions which were queued while the bus was reserved
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  this->bus_reserved = false;
+  if (this->async_current == nullptr) {
+    this->async_start_next();
   }
+  CORE_EXIT_CRITICAL();
+  xSemaphoreGive(this->spi_busy_mutex);
 }
 
-void SilabsSPI::_receive_nonblock(void* rx_buf, size_t count)
+bool SilabsSPI::queueTransaction(spi_transaction_t* transaction)
 {
-  size_t bytes_received = 0;
+  if (!this->initialized || this->follower_mode || transaction == nullptr || transaction->count == 0u) {
+    return false;
+  }
+  if (transaction->tx_buf == nullptr && transaction->rx_buf == nullptr) {
+    return false;
+  }
+  if (transaction->state == SPI_TRANSACTION_QUEUED || transaction->state == SPI_TRANSACTION_ACTIVE) {
+    return false;
+  }
 
-  // Take the transfer mutex
-  xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-  // Go while we still have bytes to receive
-  while (bytes_received < count) {
-    size_t current_transfer_size = get_next_dma_transfer_size(bytes_received, count);
-    // Receive the data
-    SPIDRV_MReceive(this->sl_spidrv_handle, rx_buf, current_transfer_size, this->dma_transfer_finished_callback);
-    // Try to take the mutex again - current task will be blocked here until the transfer finishes
-    // The dma_transfer_finished_callback will give the mutex back and the next chunk transfer will start then
+  if (transaction->cs_pin != SPI_NO_CS_PIN) {
+    PinName cs_pin_name = pinToPinName(transaction->cs_pin);
+    if (cs_pin_name == PIN_NAME_NC) {
+      return false;
+    }
+    transaction->cs_port = getSilabsPortFromArduinoPin(cs_pin_name);
+    transaction->cs_port_pin = getSilabsPinFromArduinoPin(cs_pin_name);
+  }
+
+  // A transaction longer than the descriptor chain grows it first - it's started with interrupts disabled
+  // where allocation is not possible. The running transfers have to finish before the chain is replaced.
+  size_t descriptor_count = (transaction->count + DMADRV_MAX_XFER_COUNT - 1u) / DMADRV_MAX_XFER_COUNT;
+  if (descriptor_count > this->dma_descriptor_capacity && !xPortIsInsideInterrupt()) {
     xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
-    // Add the transferred amount to the total transferred bytes
-    bytes_received += current_transfer_size;
+    this->sync_claim();
+    bool reserved = this->dma_reserve_descriptors(descriptor_count);
+    this->sync_release();
+    xSemaphoreGive(this->spi_transfer_mutex);
+    if (!reserved) {
+      return false;
+    }
   }
-  // Give back the transfer mutex
-  xSemaphoreGive(this->spi_transfer_mutex);
+  transaction->next = nullptr;
+  transaction->state = SPI_TRANSACTION_QUEUED;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (this->async_queue_head == nullptr) {
+    this->async_queue_head = transaction;
+  } else {
+    this->async_queue_tail->next = transaction;
+  }
+  this->async_queue_tail = transaction;
+  // Otherwise it's started from the DMA interrupt when the previous transactions finish,
+  // or when the synchronous transfer or the 'beginTransaction()' holder releases the bus
+  if (this->async_current == nullptr) {
+    this->async_start_next();
+  }
+  CORE_EXIT_CRITICAL();
+  return true;
 }
 
-void SilabsSPI::endTransaction(void)
+bool SilabsSPI::waitTransaction(spi_transaction_t* transaction, uint32_t timeout_ms)
 {
-  xSemaphoreGive(this->spi_busy_mutex);
+  if (transaction == nullptr) {
+    return false;
+  }
+  uint32_t start_millis = millis();
+  while (transaction->state == SPI_TRANSACTION_QUEUED || transaction->state == SPI_TRANSACTION_ACTIVE) {
+    if (millis() - start_millis >= timeout_ms) {
+      return false;
+    }
+    yield();
+  }
+  return transaction->state == SPI_TRANSACTION_DONE;
 }
 
 void SilabsSPI::end(void)
 {
+  if (this->follower_mode) {
+    GPIO_ExtIntConfig(this->follower_cs_port, this->follower_cs_port_pin, this->follower_cs_interrupt_num, false, false, false);
+    GPIOINT_CallbackUnRegister(this->follower_cs_interrupt_num);
+    this->dma_stop();
+    this->follower_armed = false;
+    SPIDRV_DeInit(this->sl_spidrv_handle);
+    // Go back to the leader configuration of the board
+    *this->sl_spidrv_config = this->leader_config;
+    this->follower_mode = false;
+    this->initialized = false;
+    return;
+  }
+  this->async_wait_idle();
   this->endTransaction();
   SPIDRV_DeInit(this->sl_spidrv_handle);
   this->initialized = false;
@@ -296,12 +317,143 @@ void SilabsSPI::setClockDivider(uint8_t clockDiv)
 
 void SilabsSPI::attachInterrupt(void)
 {
-  ;
+  this->follower_callbacks_enabled = true;
 }
 
 void SilabsSPI::detachInterrupt(void)
 {
-  ;
+  this->follower_callbacks_enabled = false;
+}
+
+bool SilabsSPI::beginFollower(pin_size_t cs_pin, uint8_t data_mode, uint8_t bit_order)
+{
+  if (this->initialized) {
+    return false;
+  }
+  PinName cs_pin_name = pinToPinName(cs_pin);
+  if (cs_pin_name == PIN_NAME_NC) {
+    return false;
+  }
+  GPIO_Port_TypeDef cs_port = getSilabsPortFromArduinoPin(cs_pin_name);
+  uint8_t cs_port_pin = (uint8_t)getSilabsPinFromArduinoPin(cs_pin_name);
+
+  // The chip select is routed to the peripheral - it only shifts data while it's asserted
+  this->leader_config = *this->sl_spidrv_config;
+  this->sl_spidrv_config->type = spidrvSlave;
+  this->sl_spidrv_config->portCs = (sl_gpio_port_t)cs_port;
+  this->sl_spidrv_config->pinCs = cs_port_pin;
+  this->sl_spidrv_config->slaveStartMode = spidrvSlaveStartImmediate;
+  this->setBitOrder(bit_order);
+  this->setDataMode(data_mode);
+  sl_status_t sc = SPIDRV_Init(this->sl_spidrv_handle, this->sl_spidrv_config);
+  if (sc != SL_STATUS_OK) {
+    *this->sl_spidrv_config = this->leader_config;
+    return false;
+  }
+
+  // The deasserting edge of the chip select ends the transfer
+  unsigned int interrupt_num = GPIOINT_CallbackRegisterExt(cs_port_pin, SilabsSPI::follower_cs_handler, this);
+  if (interrupt_num == INTERRUPT_UNAVAILABLE) {
+    SPIDRV_DeInit(this->sl_spidrv_handle);
+    *this->sl_spidrv_config = this->leader_config;
+    return false;
+  }
+  this->follower_cs_port = cs_port;
+  this->follower_cs_port_pin = cs_port_pin;
+  this->follower_cs_interrupt_num = interrupt_num;
+  this->follower_tx_buf = nullptr;
+  this->follower_rx_buf = nullptr;
+  this->follower_size = 0u;
+  this->follower_armed = false;
+  this->follower_callbacks_enabled = true;
+  this->follower_mode = true;
+  this->settings_valid = false;
+  this->initialized = true;
+  GPIO_ExtIntConfig(cs_port, cs_port_pin, interrupt_num, true, false, true);
+  return true;
+}
+
+bool SilabsSPI::setFollowerBuffers(const void* tx_buf, void* rx_buf, size_t size)
+{
+  if (!this->follower_mode || size == 0u) {
+    return false;
+  }
+  // Called from the transfer finished callback or another interrupt - the buffers are armed on the next chip select edge
+  if (xPortIsInsideInterrupt()) {
+    size_t descriptor_count = (size + DMADRV_MAX_XFER_COUNT - 1u) / DMADRV_MAX_XFER_COUNT;
+    if (descriptor_count > this->dma_descriptor_capacity) {
+      return false;
+    }
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    this->follower_tx_buf = tx_buf;
+    this->follower_rx_buf = rx_buf;
+    this->follower_size = size;
+    CORE_EXIT_CRITICAL();
+    return true;
+  }
+
+  // Nothing is armed by the chip select edge while the descriptors are being replaced
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  this->follower_size = 0u;
+  this->follower_armed = false;
+  this->dma_stop();
+  CORE_EXIT_CRITICAL();
+  if (!this->dma_reserve_descriptors((size + DMADRV_MAX_XFER_COUNT - 1u) / DMADRV_MAX_XFER_COUNT)) {
+    return false;
+  }
+  CORE_ENTER_CRITICAL();
+  this->follower_tx_buf = tx_buf;
+  this->follower_rx_buf = rx_buf;
+  this->follower_size = size;
+  this->follower_armed = this->dma_start(tx_buf, rx_buf, size);
+  CORE_EXIT_CRITICAL();
+  return this->follower_armed;
+}
+
+void SilabsSPI::onFollowerTransfer(void (*callback)(size_t received_count))
+{
+  this->follower_callback = callback;
+}
+
+void SilabsSPI::follower_cs_handler(uint8_t interrupt_num, void* ctx)
+{
+  (void)interrupt_num;
+  SilabsSPI* spi = (SilabsSPI*)ctx;
+  spi->follower_transfer_finished();
+}
+
+// Called from the GPIO interrupt when the leader deasserts the chip select
+void SilabsSPI::follower_transfer_finished()
+{
+  if (!this->follower_mode) {
+    return;
+  }
+  if (this->follower_armed) {
+    // The received length is where the receive channel got to in the buffer
+    size_t received_count = 0u;
+    uint8_t* rx_buf = (uint8_t*)this->follower_rx_buf;
+    if (rx_buf != nullptr) {
+      uint32_t destination = LDMA->CH[this->sl_spidrv_handle->rxDMACh].DST;
+      if (destination >= (uint32_t)rx_buf) {
+        received_count = destination - (uint32_t)rx_buf;
+      }
+      if (received_count > this->follower_size) {
+        received_count = this->follower_size;
+      }
+    }
+    this->dma_stop();
+    this->follower_armed = false;
+
+    // The callback may swap the buffers - they are armed after it returns
+    if (this->follower_callbacks_enabled && this->follower_callback != nullptr) {
+      this->follower_callback(received_count);
+    }
+  }
+  if (this->follower_size > 0u) {
+    this->follower_armed = this->dma_start(this->follower_tx_buf, this->follower_rx_buf, this->follower_size);
+  }
 }
 
 uint32_t SilabsSPI::getCurrentBusSpeed()
@@ -311,17 +463,457 @@ uint32_t SilabsSPI::getCurrentBusSpeed()
   return bitrate;
 }
 
-size_t SilabsSPI::get_next_dma_transfer_size(size_t transferred, size_t total)
+void SilabsSPI::setDmaThreshold(size_t max_polled_size)
+{
+  this->dma_threshold = max_polled_size;
+}
+
+size_t SilabsSPI::getDmaThreshold()
+{
+  return this->dma_threshold;
+}
+
+void SilabsSPI::apply_settings(const SPISettings& settings)
+{
+  // The follower uses the clock of the leader and the mode it was started with
+  if (this->follower_mode) {
+    return;
+  }
+  if (this->settings_valid && this->settings == settings) {
+    return;
+  }
+
+  // Keep the driver configuration in sync - it's used when the peripheral is initialized again
+  this->sl_spidrv_config->bitRate = settings.getClockFreq();
+  this->setBitOrder(settings.getBitOrder());
+  this->setDataMode(settings.getDataMode());
+  this->sl_spidrv_handle->initData.bitRate = this->sl_spidrv_config->bitRate;
+  this->sl_spidrv_handle->initData.bitOrder = this->sl_spidrv_config->bitOrder;
+  this->sl_spidrv_handle->initData.clockMode = this->sl_spidrv_config->clockMode;
+
+  // Switching to a device which was already used is only a few register writes
+  settings_cache_entry_t* entry = this->settings_cache_find(settings);
+  if (entry != nullptr) {
+    this->settings_cache_write_registers(entry);
+  } else {
+    entry = this->settings_cache_calculate(settings);
+  }
+  entry->last_used = ++this->settings_cache_use_count;
+  this->settings = settings;
+  this->settings_valid = true;
+}
+
+SilabsSPI::settings_cache_entry_t* SilabsSPI::settings_cache_find(const SPISettings& settings)
+{
+  for (uint8_t i = 0u; i < settings_cache_size; i++) {
+    if (this->settings_cache[i].valid && this->settings_cache[i].settings == settings) {
+      return &this->settings_cache[i];
+    }
+  }
+  return nullptr;
+}
+
+SilabsSPI::settings_cache_entry_t* SilabsSPI::settings_cache_calculate(const SPISettings& settings)
+{
+  // Let the driver calculate the clock divider - then store the resulting register values
+  SPIDRV_SetBitrate(this->sl_spidrv_handle, settings.getClockFreq());
+
+  bool msb_first = (settings.getBitOrder() == MSBFIRST);
+  bool clock_polarity = (settings.getDataMode() == SPI_MODE2 || settings.getDataMode() == SPI_MODE3);
+  bool clock_phase = (settings.getDataMode() == SPI_MODE1 || settings.getDataMode() == SPI_MODE3);
+
+  // Replace the least recently used entry
+  settings_cache_entry_t* entry = &this->settings_cache[0];
+  for (uint8_t i = 0u; i < settings_cache_size; i++) {
+    if (!this->settings_cache[i].valid) {
+      entry = &this->settings_cache[i];
+      break;
+    }
+    if (this->settings_cache[i].last_used < entry->last_used) {
+      entry = &this->settings_cache[i];
+    }
+  }
+  entry->settings = settings;
+
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeUsart) {
+    USART_TypeDef* usart = this->sl_spidrv_handle->peripheral.usartPort;
+    uint32_t ctrl = usart->CTRL & ~(USART_CTRL_MSBF | USART_CTRL_CLKPOL | USART_CTRL_CLKPHA);
+    ctrl |= msb_first ? USART_CTRL_MSBF : 0u;
+    ctrl |= clock_polarity ? USART_CTRL_CLKPOL : 0u;
+    ctrl |= clock_phase ? USART_CTRL_CLKPHA : 0u;
+    entry->config0 = ctrl;
+    entry->config1 = usart->CLKDIV;
+  }
+#if defined(EUSART_PRESENT)
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeEusart) {
+    EUSART_TypeDef* eusart = this->sl_spidrv_handle->peripheral.eusartPort;
+    entry->config0 = (eusart->CFG0 & ~EUSART_CFG0_MSBF) | (msb_first ? EUSART_CFG0_MSBF : 0u);
+    uint32_t cfg2 = eusart->CFG2 & ~(EUSART_CFG2_CLKPOL | EUSART_CFG2_CLKPHA);
+    cfg2 |= clock_polarity ? EUSART_CFG2_CLKPOL : 0u;
+    cfg2 |= clock_phase ? EUSART_CFG2_CLKPHA : 0u;
+    entry->config1 = cfg2;
+  }
+#endif // defined(EUSART_PRESENT)
+  entry->valid = true;
+  this->settings_cache_write_registers(entry);
+  return entry;
+}
+
+// Can be called from interrupt context
+void SilabsSPI::settings_cache_write_registers(const settings_cache_entry_t* entry)
+{
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeUsart) {
+    USART_TypeDef* usart = this->sl_spidrv_handle->peripheral.usartPort;
+    usart->CTRL = entry->config0;
+    usart->CLKDIV = entry->config1;
+  }
+#if defined(EUSART_PRESENT)
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeEusart) {
+    // The EUSART configuration registers can only be written while the peripheral is disabled
+    EUSART_TypeDef* eusart = this->sl_spidrv_handle->peripheral.eusartPort;
+    EUSART_Enable(eusart, eusartDisable);
+    eusart->EN_CLR = EUSART_EN_EN;
+    while (eusart->EN & _EUSART_EN_DISABLING_MASK) ;
+    eusart->CFG0 = entry->config0;
+    eusart->CFG2 = entry->config1;
+    EUSART_Enable(eusart, eusartEnable);
+  }
+#endif // defined(EUSART_PRESENT)
+}
+
+void SilabsSPI::async_wait_idle()
 {
-  size_t remaining_bytes = total - transferred;
-  // If the remaining bytes are larger than the max transfer size
-  if (remaining_bytes >= this->DMA_MAX_TRANSFER_SIZE) {
-    // Go with the max transfer size
-    return this->DMA_MAX_TRANSFER_SIZE;
+  if (xPortIsInsideInterrupt()) {
+    return;
+  }
+  while (this->async_current != nullptr) {
+    yield();
+  }
+}
+
+// Claims the bus for a synchronous transfer - called with 'spi_transfer_mutex' taken
+// The claim comes first so no queued transaction can start while waiting for the running one
+void SilabsSPI::sync_claim()
+{
+  this->sync_transfer_active = true;
+  this->async_wait_idle();
+}
+
+void SilabsSPI::sync_release()
+{
+  // Start the transactions which were queued during the transfer
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  this->sync_transfer_active = false;
+  if (this->async_current == nullptr) {
+    this->async_start_next();
+  }
+  CORE_EXIT_CRITICAL();
+}
+
+// Called with interrupts disabled or from the DMA interrupt
+// Nothing is started while a synchronous transfer or a 'beginTransaction()' holder uses the bus
+void SilabsSPI::async_start_next()
+{
+  while (!this->bus_reserved && !this->sync_transfer_active && this->async_queue_head != nullptr) {
+    spi_transaction_t* transaction = this->async_queue_head;
+    this->async_queue_head = transaction->next;
+    if (this->async_queue_head == nullptr) {
+      this->async_queue_tail = nullptr;
+    }
+    this->async_current = transaction;
+    transaction->state = SPI_TRANSACTION_ACTIVE;
+
+    this->apply_settings(transaction->settings);
+    if (transaction->cs_pin != SPI_NO_CS_PIN) {
+      GPIO_PinOutClear(transaction->cs_port, transaction->cs_port_pin);
+    }
+    if (this->dma_start(transaction->tx_buf, transaction->rx_buf, transaction->count)) {
+      return;
+    }
+
+    // The transfer could not be started - report it and go on with the next one
+    if (transaction->cs_pin != SPI_NO_CS_PIN) {
+      GPIO_PinOutSet(transaction->cs_port, transaction->cs_port_pin);
+    }
+    transaction->state = SPI_TRANSACTION_FAILED;
+    if (transaction->callback != nullptr) {
+      transaction->callback(transaction);
+    }
+  }
+  this->async_current = nullptr;
+}
+
+void SilabsSPI::async_transfer_finished()
+{
+  spi_transaction_t* transaction = this->async_current;
+  if (transaction->cs_pin != SPI_NO_CS_PIN) {
+    GPIO_PinOutSet(transaction->cs_port, transaction->cs_port_pin);
+  }
+  transaction->state = SPI_TRANSACTION_DONE;
+  // The callback may queue new transactions - they are started right after
+  if (transaction->callback != nullptr) {
+    transaction->callback(transaction);
+  }
+  this->async_start_next();
+}
+
+void SilabsSPI::buffer_transfer(void* tx_buf, void* rx_buf, size_t count, bool block)
+{
+  if (count == 0u) {
+    return;
+  }
+  xSemaphoreTake(this->spi_transfer_mutex, portMAX_DELAY);
+  this->sync_claim();
+  // Short transfers finish sooner by polling than it takes to set up the DMA
+  if (count > this->dma_threshold) {
+    this->dma_transfer(tx_buf, rx_buf, count, block);
   } else {
-    // If the remaining bytes fit into the MAX_TRANSER_SIZE go with the amount of remaining bytes
-    return remaining_bytes;
+    this->fifo_transfer((const uint8_t*)tx_buf, (uint8_t*)rx_buf, count);
   }
+  this->sync_release();
+  xSemaphoreGive(this->spi_transfer_mutex);
+}
+
+// Transfers the data by polling the peripheral - a missing buffer is replaced by the dummy value or discarded
+void SilabsSPI::fifo_transfer(const uint8_t* tx_buf, uint8_t* rx_buf, size_t count)
+{
+  if (!this->initialized || this->follower_mode) {
+    if (rx_buf != nullptr) {
+      memset(rx_buf, 0, count);
+    }
+    return;
+  }
+  uint8_t tx_dummy = (uint8_t)this->sl_spidrv_config->dummyTxValue;
+  size_t tx_index = 0u;
+  size_t rx_index = 0u;
+  // Two frames are kept in flight - the next one is loaded while the current one is shifted out
+  // so the clock runs back to back without overflowing the receiver
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeUsart) {
+    USART_TypeDef* usart = this->sl_spidrv_handle->peripheral.usartPort;
+    usart->CMD = USART_CMD_CLEARRX;
+    while (rx_index < count) {
+      if (tx_index < count && (tx_index - rx_index) < 2u && (usart->STATUS & USART_STATUS_TXBL)) {
+        usart->TXDATA = (tx_buf != nullptr) ? tx_buf[tx_index] : tx_dummy;
+        tx_index++;
+      }
+      if (usart->STATUS & USART_STATUS_RXDATAV) {
+        uint8_t data = (uint8_t)usart->RXDATA;
+        if (rx_buf != nullptr) {
+          rx_buf[rx_index] = data;
+        }
+        rx_index++;
+      }
+    }
+  }
+#if defined(EUSART_PRESENT)
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeEusart) {
+    EUSART_TypeDef* eusart = this->sl_spidrv_handle->peripheral.eusartPort;
+    while (eusart->STATUS & EUSART_STATUS_RXFL) {
+      (void)eusart->RXDATA;
+    }
+    while (rx_index < count) {
+      if (tx_index < count && (tx_index - rx_index) < 2u && (eusart->STATUS & EUSART_STATUS_TXFL)) {
+        eusart->TXDATA = (tx_buf != nullptr) ? tx_buf[tx_index] : tx_dummy;
+        tx_index++;
+      }
+      if (eusart->STATUS & EUSART_STATUS_RXFL) {
+        uint8_t data = (uint8_t)eusart->RXDATA;
+        if (rx_buf != nullptr) {
+          rx_buf[rx_index] = data;
+        }
+        rx_index++;
+      }
+    }
+  }
+#endif // defined(EUSART_PRESENT)
+}
+
+// Called with the bus claimed by 'sync_claim()'
+void SilabsSPI::dma_transfer(void* tx_buf, void* rx_buf, size_t count, bool block)
+{
+  if (!this->initialized || this->follower_mode || count == 0u) {
+    return;
+  }
+  this->dma_wait_blocking = block;
+  if (this->dma_reserve_descriptors((count + DMADRV_MAX_XFER_COUNT - 1u) / DMADRV_MAX_XFER_COUNT)
+      && this->dma_start(tx_buf, rx_buf, count)) {
+    if (block) {
+      // Busy-wait for the completion
+      while (this->dma_transfer_active) ;
+    } else {
+      // The current task will be blocked here until the transfer finishes
+      xSemaphoreTake(this->spi_dma_done_sem, portMAX_DELAY);
+    }
+  }
+}
+
+// Can be called from interrupt context
+bool SilabsSPI::dma_start(const void* tx_buf, void* rx_buf, size_t count)
+{
+  // One descriptor moves up to DMADRV_MAX_XFER_COUNT bytes - the descriptors are linked into a single chain
+  // The chain is grown beforehand by 'dma_reserve_descriptors()'
+  size_t descriptor_count = (count + DMADRV_MAX_XFER_COUNT - 1u) / DMADRV_MAX_XFER_COUNT;
+  if (descriptor_count > this->dma_descriptor_capacity) {
+    return false;
+  }
+
+  volatile uint32_t* tx_data_register;
+  const volatile uint32_t* rx_data_register;
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeUsart) {
+    USART_TypeDef* usart = this->sl_spidrv_handle->peripheral.usartPort;
+    tx_data_register = &usart->TXDATA;
+    rx_data_register = &usart->RXDATA;
+    // Drop any leftover data from the receive buffer
+    usart->CMD = USART_CMD_CLEARRX;
+  } else {
+#if defined(EUSART_PRESENT)
+    EUSART_TypeDef* eusart = this->sl_spidrv_handle->peripheral.eusartPort;
+    tx_data_register = &eusart->TXDATA;
+    rx_data_register = &eusart->RXDATA;
+    // Drop any leftover data from the receive FIFO
+    while (eusart->STATUS & EUSART_STATUS_RXFL) {
+      (void)eusart->RXDATA;
+    }
+#else
+    return false;
+#endif // defined(EUSART_PRESENT)
+  }
+
+  this->dma_tx_dummy = (uint8_t)this->sl_spidrv_config->dummyTxValue;
+  size_t offset = 0u;
+  for (size_t i = 0u; i < descriptor_count; i++) {
+    size_t chunk_size = count - offset;
+    if (chunk_size > DMADRV_MAX_XFER_COUNT) {
+      chunk_size = DMADRV_MAX_XFER_COUNT;
+    }
+    bool last = (i == descriptor_count - 1u);
+
+    // Without a buffer the same dummy byte is sent or overwritten repeatedly
+    const uint8_t* tx_source = (tx_buf != nullptr) ? (const uint8_t*)tx_buf + offset : &this->dma_tx_dummy;
+    this->dma_tx_descriptors[i] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(tx_source, tx_data_register, chunk_size, 1);
+    this->dma_tx_descriptors[i].xfer.srcInc = (tx_buf != nullptr) ? ldmaCtrlSrcIncOne : ldmaCtrlSrcIncNone;
+    this->dma_tx_descriptors[i].xfer.doneIfs = 0;
+    this->dma_tx_descriptors[i].xfer.link = last ? 0 : 1;
+
+    uint8_t* rx_destination = (rx_buf != nullptr) ? (uint8_t*)rx_buf + offset : &this->dma_rx_dummy;
+    this->dma_rx_descriptors[i] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(rx_data_register, rx_destination, chunk_size, 1);
+    this->dma_rx_descriptors[i].xfer.dstInc = (rx_buf != nullptr) ? ldmaCtrlDstIncOne : ldmaCtrlDstIncNone;
+    // Only the end of the whole chain raises an interrupt - every byte sent has been received by then
+    this->dma_rx_descriptors[i].xfer.doneIfs = last ? 1 : 0;
+    this->dma_rx_descriptors[i].xfer.link = last ? 0 : 1;
+
+    offset += chunk_size;
+  }
+
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  this->dma_transfer_active = true;
+
+  this->dma_rx_config = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL((LDMA_PeripheralSignal_t)this->sl_spidrv_handle->rxDMASignal);
+  this->dma_tx_config = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL((LDMA_PeripheralSignal_t)this->sl_spidrv_handle->txDMASignal);
+  // The receiver has to be ready before the first byte is clocked out
+  Ecode_t result = DMADRV_LdmaStartTransfer((int)this->sl_spidrv_handle->rxDMACh,
+                                            &this->dma_rx_config,
+                                            this->dma_rx_descriptors,
+                                            SilabsSPI::dma_chain_finished_cb,
+                                            this);
+  if (result == ECODE_EMDRV_DMADRV_OK) {
+    result = DMADRV_LdmaStartTransfer((int)this->sl_spidrv_handle->txDMACh,
+                                      &this->dma_tx_config,
+                                      this->dma_tx_descriptors,
+                                      nullptr,
+                                      nullptr);
+    if (result != ECODE_EMDRV_DMADRV_OK) {
+      DMADRV_StopTransfer(this->sl_spidrv_handle->rxDMACh);
+    }
+  }
+  if (result != ECODE_EMDRV_DMADRV_OK) {
+    this->dma_transfer_active = false;
+    #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+    #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+    return false;
+  }
+  return true;
+}
+
+bool SilabsSPI::dma_reserve_descriptors(size_t count)
+{
+  if (count <= this->dma_descriptor_capacity) {
+    return true;
+  }
+  // Transfers longer than what the internal descriptors cover need a larger chain - it's kept for reuse
+  // The old chain is freed, so this is only called while no transfer walks it - with the bus claimed
+  // by 'sync_claim()' or in follower mode with the DMA stopped
+  // Allocation is not possible from interrupt context - queued transactions have to fit what's already available
+  if (xPortIsInsideInterrupt()) {
+    return false;
+  }
+  LDMA_Descriptor_t* descriptors = (LDMA_Descriptor_t*)malloc(2u * count * sizeof(LDMA_Descriptor_t));
+  if (descriptors == nullptr) {
+    return false;
+  }
+  if (this->dma_tx_descriptors != this->dma_descriptors_default) {
+    free(this->dma_tx_descriptors);
+  }
+  this->dma_tx_descriptors = descriptors;
+  this->dma_rx_descriptors = descriptors + count;
+  this->dma_descriptor_capacity = count;
+  return true;
+}
+
+bool SilabsSPI::dma_chain_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+  SilabsSPI* spi = (SilabsSPI*)userParam;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  // A follower transfer could have been stopped by the chip select edge in the meantime
+  bool was_active = spi->dma_transfer_active;
+  spi->dma_transfer_active = false;
+  CORE_EXIT_CRITICAL();
+  if (!was_active) {
+    return true;
+  }
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
+  spi->dma_transfer_finished_callback(spi->sl_spidrv_handle, ECODE_EMDRV_SPIDRV_OK, 0);
+  return true;
+}
+
+// Stops the running descriptor chain and drops the data left in the peripheral
+void SilabsSPI::dma_stop()
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  DMADRV_StopTransfer(this->sl_spidrv_handle->txDMACh);
+  DMADRV_StopTransfer(this->sl_spidrv_handle->rxDMACh);
+  bool was_active = this->dma_transfer_active;
+  this->dma_transfer_active = false;
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeUsart) {
+    this->sl_spidrv_handle->peripheral.usartPort->CMD = USART_CMD_CLEARTX | USART_CMD_CLEARRX;
+  }
+#if defined(EUSART_PRESENT)
+  if (this->sl_spidrv_handle->peripheralType == spidrvPeripheralTypeEusart) {
+    EUSART_TypeDef* eusart = this->sl_spidrv_handle->peripheral.eusartPort;
+    eusart->CMD = EUSART_CMD_CLEARTX;
+    while (eusart->STATUS & EUSART_STATUS_RXFL) {
+      (void)eusart->RXDATA;
+    }
+  }
+#endif // defined(EUSART_PRESENT)
+  CORE_EXIT_CRITICAL();
+  #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  if (was_active) {
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  }
+  #else
+  (void)was_active;
+  #endif // SL_CATALOG_POWER_MANAGER_PRESENT
 }
 
 void SilabsSPI::dma_transfer_finished_cb(struct SPIDRV_HandleData *handle, Ecode_t transferStatus, int itemsTransferred)
@@ -329,8 +921,19 @@ void SilabsSPI::dma_transfer_finished_cb(struct SPIDRV_HandleData *handle, Ecode
   (void)handle;
   (void)transferStatus;
   (void)itemsTransferred;
+  // In follower mode the transfer is finished by the chip select edge - not by the end of the buffers
+  if (this->follower_mode) {
+    return;
+  }
+  if (this->async_current != nullptr) {
+    this->async_transfer_finished();
+    return;
+  }
+  if (this->dma_wait_blocking) {
+    return;
+  }
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-  xSemaphoreGiveFromISR(this->spi_transfer_mutex, &xHigherPriorityTaskWoken);
+  xSemaphoreGiveFromISR(this->spi_dma_done_sem, &xHigherPriorityTaskWoken);
   portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
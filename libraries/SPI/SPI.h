@@ -34,10 +34,43 @@
 #include <inttypes.h>
 #include <cstddef>
 #include "spidrv.h"
+#include "dmadrv.h"
+#include "gpiointerrupt.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
 
+// Buffer transfers up to this length are done by polling the FIFO - longer ones use DMA
+// Can be tuned with the 'spi_transfer_benchmark' example and changed with 'SPI.setDmaThreshold()'
+#ifndef SPI_DMA_THRESHOLD
+#define SPI_DMA_THRESHOLD 16u
+#endif // SPI_DMA_THRESHOLD
+
+#define SPI_NO_CS_PIN ((pin_size_t)0xFFu)
+
 namespace arduino {
+enum spi_transaction_state_t {
+  SPI_TRANSACTION_IDLE = 0,   // Not queued yet
+  SPI_TRANSACTION_QUEUED,     // Waiting in the queue
+  SPI_TRANSACTION_ACTIVE,     // Being transferred
+  SPI_TRANSACTION_DONE,       // Finished successfully
+  SPI_TRANSACTION_FAILED      // The transfer could not be started
+};
+
+typedef struct spi_transaction {
+  pin_size_t cs_pin;          // Chip select pin - driven low for the duration of the transfer, SPI_NO_CS_PIN if not used
+  SPISettings settings;       // Bus settings for the transfer
+  const void* tx_buf;         // Data to be sent, nullptr to send dummy bytes
+  void* rx_buf;               // Buffer for the received data, nullptr to discard it
+  size_t count;               // Number of bytes to be transferred
+  void (*callback)(struct spi_transaction* transaction);   // Called from interrupt context when finished, can be nullptr
+  void* user_data;            // Not used by the driver - can be used to pass data to the callback
+  // Managed by the driver
+  volatile spi_transaction_state_t state;
+  GPIO_Port_TypeDef cs_port;
+  uint8_t cs_port_pin;
+  struct spi_transaction* next;
+} spi_transaction_t;
+
 class SilabsSPI : public SPIClass
 {
 public:
@@ -47,6 +80,16 @@ public:
   virtual uint16_t transfer16(uint16_t data);
   virtual void transfer(void *buf, size_t count);
 
+  /***************************************************************************//**
+   * Transfers four bytes on the SPI bus - the most significant byte first.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] data The data to be transferred
+   *
+   * @return the four bytes of data received on the SPI bus
+   ******************************************************************************/
+  uint32_t transfer32(uint32_t data);
+
   // Transaction Functions
   virtual void usingInterrupt(int interruptNumber);
   virtual void notUsingInterrupt(int interruptNumber);
@@ -54,15 +97,68 @@ public:
   virtual void endTransaction(void);
 
   // SPI Configuration methods
+  /***************************************************************************//**
+   * Enables the transfer finished callbacks in follower mode
+   * Has no effect in leader mode.
+   ******************************************************************************/
   virtual void attachInterrupt();
+
+  /***************************************************************************//**
+   * Disables the transfer finished callbacks in follower mode
+   * The buffers are still rearmed after each transfer. Has no effect in leader mode.
+   ******************************************************************************/
   virtual void detachInterrupt();
 
   virtual void begin();
   virtual void end();
 
+  /***************************************************************************//**
+   * Starts the SPI peripheral in follower (slave) mode
+   * The bus is clocked by an external leader. Data is moved by DMA from and to the
+   * buffers set with 'setFollowerBuffers()'. The transfer ends when the leader
+   * deasserts the chip select - the buffers are rearmed for the next transfer then.
+   * The leader mode functions have no effect until 'end()' is called.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] cs_pin The chip select input pin
+   * @param[in] data_mode The SPI mode (SPI_MODE0..3) used by the leader
+   * @param[in] bit_order The bit order (MSBFIRST or LSBFIRST) used by the leader
+   *
+   * @return true if the follower mode was started, false otherwise
+   ******************************************************************************/
+  bool beginFollower(pin_size_t cs_pin, uint8_t data_mode = SPI_MODE0, uint8_t bit_order = MSBFIRST);
+
+  /***************************************************************************//**
+   * Sets the buffers used in follower mode
+   * The transmit buffer is sent to the leader from the start of each transfer while
+   * the received data is stored in the receive buffer. Data beyond the buffer size is
+   * not stored and the dummy value is sent. From a task the buffers take effect
+   * immediately - call it while the chip select is deasserted. From interrupt context
+   * (including the transfer finished callback) they take effect with the next transfer.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] tx_buf Data to be sent, nullptr to send the dummy value
+   * @param[out] rx_buf Buffer for the received data, nullptr to discard it
+   * @param[in] size Size of the buffers in bytes
+   *
+   * @return true if the buffers were set, false otherwise
+   ******************************************************************************/
+  bool setFollowerBuffers(const void* tx_buf, void* rx_buf, size_t size);
+
+  /***************************************************************************//**
+   * Sets the function called when the leader finishes a transfer in follower mode
+   * The callback is called from interrupt context on the deasserting chip select
+   * edge with the number of bytes received into the receive buffer (zero without one).
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] callback The function to be called, nullptr to remove it
+   ******************************************************************************/
+  void onFollowerTransfer(void (*callback)(size_t received_count));
+
   /***************************************************************************//**
    * Transfers the provided amount of bytes on the SPI bus.
-   * Uses DMA - not recommended for small transactions.
+   * Transfers longer than the DMA threshold use DMA - shorter ones are done
+   * by polling the FIFO and always busy-wait.
    *
    * @param[in] tx_buf Pointer to the data to be transferred
    * @param[in] count Size of the data to be transferred
@@ -74,7 +170,8 @@ public:
   /***************************************************************************//**
    * Transfers the provided amount of bytes while simultaneously receiving
    * the same amount of bytes.
-   * Uses DMA - not recommended for small transactions.
+   * Transfers longer than the DMA threshold use DMA - shorter ones are done
+   * by polling the FIFO and always busy-wait.
    * Silabs specific, non-standard Arduino call.
    *
    * @param[in] tx_buf Pointer to the data to be transferred
@@ -103,7 +200,8 @@ public:
 
   /***************************************************************************//**
    * Receives the provided amount of bytes on the SPI bus.
-   * Uses DMA - not recommended for small transactions.
+   * Transfers longer than the DMA threshold use DMA - shorter ones are done
+   * by polling the FIFO and always busy-wait.
    * Silabs specific, non-standard Arduino call.
    *
    * @param[out] rx_buf Pointer to the array to store the received data
@@ -113,6 +211,42 @@ public:
    ******************************************************************************/
   void receive(void* rx_buf, size_t count, bool block = false);
 
+  /***************************************************************************//**
+   * Adds a transaction to the asynchronous transfer queue and returns immediately
+   * The queued transactions are started back to back from the DMA interrupt - each one
+   * with its own settings and chip select. The transaction structure is used as the
+   * handle of the transfer and has to stay valid until it's finished. The chip select
+   * pin has to be configured as an output by the user. On instances where the peripheral
+   * drives its own chip select (auto CS) that pin is asserted for every transfer as well,
+   * use SPI_NO_CS_PIN for the device connected to it.
+   * Queued transactions wait while a synchronous transfer runs, and while the bus is
+   * reserved with 'beginTransaction()' they wait for 'endTransaction()' - also when
+   * they were queued by the holder itself. Queueing a transaction longer than any
+   * before (over 16 KiB) from a task waits for the running transfer to finish, so the
+   * DMA descriptors can be grown. Such transactions queued from an ISR need an earlier
+   * transfer of at least the same length - otherwise they finish with
+   * SPI_TRANSACTION_FAILED.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] transaction Pointer to the transaction to be queued
+   *
+   * @return true if the transaction was queued, false if the parameters are invalid,
+   *         the transaction is already queued or the DMA descriptors can't be allocated
+   ******************************************************************************/
+  bool queueTransaction(spi_transaction_t* transaction);
+
+  /***************************************************************************//**
+   * Waits for a queued transaction to finish
+   * The task yields while waiting. Use a zero timeout to check the status only.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] transaction Pointer to the queued transaction
+   * @param[in] timeout_ms Maximum time to wait in milliseconds
+   *
+   * @return true if the transaction has finished, false on timeout or failure
+   ******************************************************************************/
+  bool waitTransaction(spi_transaction_t* transaction, uint32_t timeout_ms = 0xFFFFFFFFu);
+
   /***************************************************************************//**
    * Returns the actual clock speed of the SPI bus which can be different
    * than what the user requested. Silabs specific API.
@@ -121,6 +255,24 @@ public:
    ******************************************************************************/
   uint32_t getCurrentBusSpeed();
 
+  /***************************************************************************//**
+   * Sets the length from which buffer transfers use DMA
+   * Transfers up to this length are done by polling the FIFO which avoids the
+   * setup cost of DMA. Zero makes every buffer transfer use DMA.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] max_polled_size The longest transfer done by polling in bytes
+   ******************************************************************************/
+  void setDmaThreshold(size_t max_polled_size);
+
+  /***************************************************************************//**
+   * Returns the length from which buffer transfers use DMA
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @return the longest transfer done by polling in bytes
+   ******************************************************************************/
+  size_t getDmaThreshold();
+
   /***************************************************************************//**
    * Callback function - called from outside when a DMA transfer finishes
    *
@@ -143,26 +295,87 @@ public:
   void setClockDivider(uint8_t clockDiv);
 
 private:
-  void _transfer_block(void* tx_buf, size_t count);
-  void _transfer_nonblock(void* tx_buf, size_t count);
+  // Number of LDMA descriptors per direction available without allocation - covers 16 KiB transfers
+  static const size_t dma_descriptors_internal = 8u;
+
+  void buffer_transfer(void* tx_buf, void* rx_buf, size_t count, bool block);
+  void fifo_transfer(const uint8_t* tx_buf, uint8_t* rx_buf, size_t count);
+  void dma_transfer(void* tx_buf, void* rx_buf, size_t count, bool block);
+  bool dma_start(const void* tx_buf, void* rx_buf, size_t count);
+  bool dma_reserve_descriptors(size_t count);
+  static bool dma_chain_finished_cb(unsigned int channel, unsigned int sequenceNo, void *userParam);
+  void dma_stop();
 
-  void _transfer_block(void* tx_buf, void* rx_buf, size_t count);
-  void _transfer_nonblock(void* tx_buf, void* rx_buf, size_t count);
+  static void follower_cs_handler(uint8_t interrupt_num, void* ctx);
+  void follower_transfer_finished();
 
-  void _receive_block(void* rx_buf, size_t count);
-  void _receive_nonblock(void* rx_buf, size_t count);
+  // Register values of a previously used bus configuration
+  // USART: config0 = CTRL, config1 = CLKDIV - EUSART: config0 = CFG0, config1 = CFG2
+  typedef struct {
+    SPISettings settings;
+    uint32_t config0;
+    uint32_t config1;
+    uint32_t last_used;
+    bool valid;
+  } settings_cache_entry_t;
+  static const uint8_t settings_cache_size = 4u;
 
-  static const int DMA_MAX_TRANSFER_SIZE = 2048;
-  size_t get_next_dma_transfer_size(size_t transferred, size_t total);
+  void apply_settings(const SPISettings& settings);
+  settings_cache_entry_t* settings_cache_find(const SPISettings& settings);
+  settings_cache_entry_t* settings_cache_calculate(const SPISettings& settings);
+  void settings_cache_write_registers(const settings_cache_entry_t* entry);
+  void async_wait_idle();
+  void sync_claim();
+  void sync_release();
+  void async_start_next();
+  void async_transfer_finished();
 
   bool initialized;
+  size_t dma_threshold;
   SPISettings settings = SPISettings(1000000, LSBFIRST, SPI_MODE0);
+  bool settings_valid;
+  settings_cache_entry_t settings_cache[settings_cache_size];
+  uint32_t settings_cache_use_count;
+
+  spi_transaction_t* volatile async_queue_head;
+  spi_transaction_t* async_queue_tail;
+  spi_transaction_t* volatile async_current;
+  // Set between 'beginTransaction()' and 'endTransaction()' and during synchronous transfers
+  // The asynchronous queue only starts transactions while both are clear
+  volatile bool bus_reserved;
+  volatile bool sync_transfer_active;
+
+  // Linked descriptor chains - a transfer of any length raises a single completion interrupt
+  LDMA_Descriptor_t dma_descriptors_default[2u * dma_descriptors_internal];
+  LDMA_Descriptor_t* dma_tx_descriptors;
+  LDMA_Descriptor_t* dma_rx_descriptors;
+  size_t dma_descriptor_capacity;
+  LDMA_TransferCfg_t dma_tx_config;
+  LDMA_TransferCfg_t dma_rx_config;
+  uint8_t dma_tx_dummy;
+  uint8_t dma_rx_dummy;
+  volatile bool dma_transfer_active;
+  bool dma_wait_blocking;
+
+  bool follower_mode;
+  bool follower_callbacks_enabled;
+  SPIDRV_Init_t leader_config;
+  GPIO_Port_TypeDef follower_cs_port;
+  uint8_t follower_cs_port_pin;
+  unsigned int follower_cs_interrupt_num;
+  const void* volatile follower_tx_buf;
+  void* volatile follower_rx_buf;
+  volatile size_t follower_size;
+  volatile bool follower_armed;
+  void (*follower_callback)(size_t received_count);
 
   SPIDRV_Handle_t sl_spidrv_handle;
   SPIDRV_Init_t* sl_spidrv_config;
   SPIDRV_Callback_t dma_transfer_finished_callback;
   SemaphoreHandle_t spi_transfer_mutex;
   StaticSemaphore_t spi_transfer_mutex_buf;
+  SemaphoreHandle_t spi_dma_done_sem;
+  StaticSemaphore_t spi_dma_done_sem_buf;
   SemaphoreHandle_t spi_busy_mutex;
   StaticSemaphore_t spi_busy_mutex_buf;
 };
@@ -0,0 +1,66 @@
+/*
+   ADC window monitor example
+
+   The example shows how to monitor an analog voltage without polling it with analogRead().
+
+   The ADC converts the input periodically in the background - triggered by hardware - and the
+   CPU is only woken up when the measured value leaves the configured window. Between the wakeups
+   the device sleeps in EM2. After each wakeup the window is re-centered around the new value.
+   Connect a potentiometer (or any voltage between GND and VDD) to the monitored pin and turn it
+   to see the wakeups on the Serial Monitor.
+
+   This example is compatible with all Silicon Labs Arduino boards.
+ */
+
+#include "ArduinoLowPower.h"
+
+#define MONITOR_PIN        PA0
+#define MONITOR_PERIOD_MS  100
+#define WINDOW_HALF_WIDTH  200
+
+volatile bool window_left = false;
+volatile uint16_t last_sample = 0;
+
+void on_window_exit(uint16_t sample);
+void set_window_around(uint16_t value);
+
+void setup()
+{
+  Serial.begin(115200);
+  analogReadResolution(12);
+
+  uint16_t initial_value = analogRead(MONITOR_PIN);
+  Serial.printf("Initial value: %u\n", initial_value);
+
+  uint16_t low = (initial_value > WINDOW_HALF_WIDTH) ? initial_value - WINDOW_HALF_WIDTH : 0;
+  uint16_t high = min(initial_value + WINDOW_HALF_WIDTH, 4095);
+  if (!analogMonitorStart(MONITOR_PIN, low, high, MONITOR_PERIOD_MS, on_window_exit)) {
+    Serial.println("Failed to start the analog monitor");
+  }
+}
+
+void loop()
+{
+  // Sleep until the ADC wakes us up
+  LowPower.sleep();
+
+  if (window_left) {
+    window_left = false;
+    Serial.printf("Value left the window: %u\n", last_sample);
+    set_window_around(last_sample);
+  }
+}
+
+void on_window_exit(uint16_t sample)
+{
+  // Called from interrupt context - keep it short
+  last_sample = sample;
+  window_left = true;
+}
+
+void set_window_around(uint16_t value)
+{
+  uint16_t low = (value > WINDOW_HALF_WIDTH) ? value - WINDOW_HALF_WIDTH : 0;
+  uint16_t high = min(value + WINDOW_HALF_WIDTH, 4095);
+  analogMonitorSetWindow(low, high);
+}
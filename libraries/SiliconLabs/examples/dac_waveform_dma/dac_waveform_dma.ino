@@ -0,0 +1,56 @@
+/*
+   DAC DMA waveform generator example
+
+   The example shows how to play a waveform on the DAC (Digital to Analog converter) without CPU involvement.
+
+   The sketch fills a buffer with one period of a sine wave and hands it over to the DAC which plays it
+   in a loop. The samples are moved to the DAC by DMA on each tick of a hardware timer - so the output
+   is free of jitter and the CPU is free to do other things.
+   The DAC outputs on the MG24 based boards are PB00 and PB01 for channel 0 and 1.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#define SINE_TABLE_SIZE  64
+#define SINE_FREQUENCY   1000
+
+uint16_t sine_table[SINE_TABLE_SIZE];
+volatile uint32_t periods_played = 0;
+
+void on_period_finished(uint8_t buffer_index);
+
+void setup()
+{
+  Serial.begin(115200);
+  // Select the 1.25V reference voltage (feel free to change it)
+  analogReferenceDAC(DAC_VREF_1V25);
+
+  // Fill the buffer with one period of a sine wave - the samples are 12 bit
+  for (int i = 0; i < SINE_TABLE_SIZE; i++) {
+    sine_table[i] = (uint16_t)(2047.5f + 2047.5f * sinf(2.0f * PI * i / SINE_TABLE_SIZE));
+  }
+
+  // Play the buffer continuously on DAC channel 0
+  sl_status_t status = DAC_0.waveform_start(0, sine_table, SINE_TABLE_SIZE, SINE_TABLE_SIZE * SINE_FREQUENCY, DAC_WAVEFORM_LOOP, on_period_finished);
+  if (status != SL_STATUS_OK) {
+    Serial.println("Failed to start the waveform playback");
+  }
+}
+
+void loop()
+{
+  Serial.printf("Sine periods played: %lu\n", periods_played);
+  delay(1000);
+}
+
+void on_period_finished(uint8_t buffer_index)
+{
+  (void)buffer_index;
+  periods_played++;
+}
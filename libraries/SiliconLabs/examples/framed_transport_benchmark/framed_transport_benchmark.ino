@@ -0,0 +1,157 @@
+/*
+   Framed transport benchmark example
+
+   The example shows how to exchange binary frames over a serial port with 'FramedStream' and
+   measures how many frames per second get through a 1 Mbaud link.
+
+   Frames of pseudo-random binary data are COBS encoded with a CRC-32 and sent on Serial1. They
+   are received back through a loopback connection and decoded directly from the receive buffer
+   of the port into the frame queue. Several frames are kept in flight, so the link is never idle
+   while a frame is being checked - the result is the throughput of the link, not the round trip
+   time of a single frame. The received frames are fetched with 'peekFrame()', checked in place
+   against their sequence number and released. The results are printed on Serial at 115200 baud
+   next to the limit of the link.
+
+   Connect the TX and RX pins of Serial1 together before running the sketch.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#define LINK_BAUD_RATE      1000000
+#define FRAME_SIZE          200
+#define FRAMES_PER_ROUND    500
+#define FRAMES_IN_FLIGHT    4
+#define RECEIVE_TIMEOUT_MS  1000
+
+// 4 bytes of CRC-32, up to 2 bytes of COBS overhead and the zero delimiter per frame
+#define ENCODED_FRAME_SIZE  (FRAME_SIZE + 4 + 2 + 1)
+
+FramedStream framed_link(Serial1, FRAMING_COBS, FRAMING_CRC32);
+
+uint8_t tx_frame[FRAME_SIZE];
+uint8_t expected_frame[FRAME_SIZE];
+uint32_t frames_received = 0;
+uint32_t frames_mismatched = 0;
+
+void fill_frame(uint8_t* frame, uint32_t sequence);
+void check_received_frames();
+uint32_t frames_lost();
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("Framed transport benchmark");
+
+  // The buffers hold all the frames in flight
+  Serial1.setRxBufferSize(2048);
+  Serial1.setTxBufferSize(1024);
+  Serial1.begin(LINK_BAUD_RATE);
+  if (!framed_link.begin(FRAME_SIZE, FRAMES_IN_FLIGHT)) {
+    Serial.println("Failed to start the framed transport");
+    return;
+  }
+  // No callback - the received frames are queued
+  framed_link.onFrame(nullptr);
+  // 10 bits per byte with 8N1
+  uint32_t link_limit = (LINK_BAUD_RATE / 10) / ENCODED_FRAME_SIZE;
+  Serial.printf("%u byte frames, %u in flight - link limit %lu frames/s, %lu bytes/s\n",
+                FRAME_SIZE,
+                FRAMES_IN_FLIGHT,
+                link_limit,
+                link_limit * FRAME_SIZE);
+}
+
+void loop()
+{
+  frames_received = 0;
+  frames_mismatched = 0;
+  framed_link.clearErrorCounters();
+
+  uint32_t frames_sent = 0;
+  uint32_t progress_millis = millis();
+  uint32_t start = micros();
+  while (frames_received + frames_lost() < FRAMES_PER_ROUND) {
+    // Keep the window full - a new frame goes out as soon as one has come back
+    while (frames_sent < FRAMES_PER_ROUND && frames_sent - frames_received - frames_lost() < FRAMES_IN_FLIGHT) {
+      fill_frame(tx_frame, frames_sent);
+      framed_link.writeFrame(tx_frame, FRAME_SIZE);
+      frames_sent++;
+    }
+    uint32_t frames_done = frames_received + frames_lost();
+    framed_link.poll();
+    check_received_frames();
+    if (frames_received + frames_lost() != frames_done) {
+      progress_millis = millis();
+    } else if ((millis() - progress_millis) >= RECEIVE_TIMEOUT_MS) {
+      break;
+    }
+  }
+  uint32_t elapsed_us = micros() - start;
+
+  uint32_t frames_per_sec = (elapsed_us > 0) ? (uint32_t)((uint64_t)frames_received * 1000000u / elapsed_us) : 0;
+  Serial.printf("%lu/%u frames in %lu us - %lu frames/s, %lu bytes/s - mismatches: %lu, CRC errors: %lu, framing errors: %lu, dropped: %lu\n",
+                frames_received,
+                FRAMES_PER_ROUND,
+                elapsed_us,
+                frames_per_sec,
+                frames_per_sec * FRAME_SIZE,
+                frames_mismatched,
+                framed_link.getCrcErrorCount(),
+                framed_link.getFramingErrorCount(),
+                framed_link.getDroppedFrameCount());
+
+  // Let the frames of a timed out round drain before the next one
+  delay(2000);
+  framed_link.poll();
+  while (framed_link.available() > 0) {
+    framed_link.releaseFrame();
+  }
+}
+
+// Fills a frame with its sequence number followed by data derived from it - the receiver can
+// rebuild the expected frame without keeping a copy of every frame in flight
+void fill_frame(uint8_t* frame, uint32_t sequence)
+{
+  memcpy(frame, &sequence, sizeof(sequence));
+  uint32_t state = sequence * 2654435761u + 1u;
+  for (uint32_t i = sizeof(sequence); i < FRAME_SIZE; i++) {
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    frame[i] = (uint8_t)state;
+  }
+}
+
+// Checks the queued frames in place and releases them
+void check_received_frames()
+{
+  size_t size;
+  const uint8_t* frame;
+  while ((frame = framed_link.peekFrame(&size)) != nullptr) {
+    uint32_t sequence = 0;
+    if (size == FRAME_SIZE) {
+      memcpy(&sequence, frame, sizeof(sequence));
+      fill_frame(expected_frame, sequence);
+    }
+    if (size != FRAME_SIZE || memcmp(frame, expected_frame, FRAME_SIZE) != 0) {
+      frames_mismatched++;
+    }
+    framed_link.releaseFrame();
+    frames_received++;
+  }
+}
+
+// Returns the number of frames which were sent but will never be received
+uint32_t frames_lost()
+{
+  return framed_link.getCrcErrorCount() + framed_link.getFramingErrorCount() + framed_link.getDroppedFrameCount();
+}
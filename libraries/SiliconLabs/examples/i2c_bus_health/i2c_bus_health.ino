@@ -0,0 +1,88 @@
+/*
+   I2C bus health example
+
+   The example shows how to diagnose an I2C bus and let it recover from faults without a reset.
+
+   The bus is scanned at startup and the found followers are read periodically. The driver keeps
+   statistics for each follower - transfers, bytes, NACKs, timeouts, bus errors, lost arbitrations,
+   retries and a latency histogram - which are printed every ten seconds. A transfer which times
+   out or ends with a bus error triggers a bus recovery: SCL is toggled until a stuck follower
+   releases SDA and a STOP condition is sent. Transfers lost to a bus error are repeated.
+   The results are printed on Serial at 115200 baud.
+
+   Connect I2C followers to the SDA and SCL pins.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <Wire.h>
+
+#define MAX_FOLLOWERS   16
+#define READ_SIZE       4
+
+uint8_t followers[MAX_FOLLOWERS];
+size_t follower_count = 0;
+
+void print_stats();
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+  Wire.begin();
+  // Abort the transfers after 10 ms and recover the bus automatically
+  Wire.setWireTimeout(10000, true);
+  Wire.setRetryCount(2);
+
+  uint32_t start = micros();
+  follower_count = Wire.scan(followers, MAX_FOLLOWERS);
+  uint32_t elapsed_us = micros() - start;
+  if (follower_count > MAX_FOLLOWERS) {
+    follower_count = MAX_FOLLOWERS;
+  }
+  Serial.printf("Found %u follower(s) in %lu us:", follower_count, elapsed_us);
+  for (size_t i = 0; i < follower_count; i++) {
+    Serial.printf(" 0x%02x", followers[i]);
+  }
+  Serial.println();
+}
+
+void loop()
+{
+  static uint32_t last_print = 0;
+  uint8_t data[READ_SIZE];
+
+  for (size_t i = 0; i < follower_count; i++) {
+    Wire.requestFrom(followers[i], data, sizeof(data));
+  }
+
+  if (millis() - last_print >= 10000) {
+    last_print = millis();
+    print_stats();
+  }
+  delay(100);
+}
+
+void print_stats()
+{
+  wire_device_stats_t stats;
+  Serial.printf("Bus recoveries: %lu\n", Wire.getBusRecoveryCount());
+  for (size_t i = 0; Wire.getDeviceStatsByIndex(i, &stats); i++) {
+    Serial.printf("0x%02x: %lu transfers, %lu bytes, %lu NACKs, %lu timeouts, %lu bus errors, %lu arbitration lost, %lu retries\n",
+                  stats.address, stats.transactions, stats.bytes, stats.nacks, stats.timeouts,
+                  stats.bus_errors, stats.arbitration_lost, stats.retries);
+    Serial.print("      latency histogram (<100us, <200us, ..., >=6.4ms):");
+    for (uint8_t bucket = 0; bucket < WIRE_LATENCY_BUCKET_COUNT; bucket++) {
+      Serial.printf(" %lu", stats.latency_histogram[bucket]);
+    }
+    Serial.println();
+  }
+}
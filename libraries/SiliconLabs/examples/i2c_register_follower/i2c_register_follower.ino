@@ -0,0 +1,86 @@
+/*
+   I2C register follower example
+
+   The example shows how to emulate an I2C sensor with a register map.
+
+   The board joins the I2C bus as a follower and exposes a small register map like a typical
+   sensor. The leader writes the register address, then reads or writes the registers from
+   there - the address increments after each byte. The bytes are served directly from the
+   I2C interrupt, so the replies don't depend on what the sketch is doing.
+
+   Register map:
+   - 0x00: ID (0xA5) - read-only
+   - 0x01: control - writable, bit 0 switches the built-in LED
+   - 0x02 - 0x05: uptime in milliseconds (little endian) - read-only, updated by the sketch
+
+   Register writes are reported by a callback and printed on Serial at 115200 baud.
+   Connect the SDA and SCL pins to an I2C leader - e.g. another board running a Wire sketch.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <Wire.h>
+
+#define FOLLOWER_ADDRESS  0x42
+#define REG_ID            0x00
+#define REG_CONTROL       0x01
+#define REG_UPTIME        0x02
+#define REGISTER_COUNT    6
+
+volatile uint8_t registers[REGISTER_COUNT] = { 0xA5, 0x00 };
+volatile bool control_written = false;
+
+void on_register_write(size_t start, size_t count);
+
+void setup()
+{
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  Wire.onRegisterWrite(on_register_write);
+  if (!Wire.beginRegisterMap(FOLLOWER_ADDRESS, registers, REGISTER_COUNT)) {
+    Serial.println("Failed to start the I2C follower");
+    return;
+  }
+  // Only the control register can be written by the leader
+  Wire.setRegisterMapWritable(REG_CONTROL, 1);
+}
+
+void loop()
+{
+  // Update the multi-byte value without the interrupt reading it halfway
+  uint32_t uptime = millis();
+  noInterrupts();
+  for (uint8_t i = 0; i < 4; i++) {
+    registers[REG_UPTIME + i] = (uint8_t)(uptime >> (8 * i));
+  }
+  interrupts();
+
+  if (control_written) {
+    control_written = false;
+    uint8_t control = registers[REG_CONTROL];
+    if (control & 0x01) {
+      digitalWrite(LED_BUILTIN, LED_BUILTIN_ACTIVE);
+    } else {
+      digitalWrite(LED_BUILTIN, LED_BUILTIN_INACTIVE);
+    }
+    Serial.printf("Control register written: 0x%02x\n", control);
+  }
+  delay(10);
+}
+
+void on_register_write(size_t start, size_t count)
+{
+  (void)count;
+  if (start == REG_CONTROL) {
+    control_written = true;
+  }
+}
@@ -0,0 +1,102 @@
+/*
+   I2C throughput benchmark example
+
+   The example measures the effective I2C throughput in bytes per second for each bus speed
+   with interrupt driven and DMA transfers.
+
+   Reads are done from an I2C EEPROM (24xx series) with one sequential read per block - the
+   memory address is written first, then the data is read after a repeated start. Writes are
+   done to an SSD1306 OLED display as a stream of display data - the control byte is sent from
+   a separate buffer followed by the data, like a framebuffer update. The transfers go directly
+   from and to the sketch's buffers with 'Wire.requestFrom()' and 'Wire.writeTo()'.
+   Short transfers run byte by byte from the I2C interrupt, long ones are moved by DMA - the limit
+   is set with 'Wire.setDmaThreshold()'. The results are printed on Serial at 115200 baud next
+   to the bus limit - nine clocks per byte. A block takes about 92 ms at 100 kHz, the wire
+   timeout only limits how long a transfer may stall so it doesn't need to be raised.
+
+   Connect an I2C EEPROM and/or an SSD1306 display to the SDA and SCL pins. Fast-mode Plus (1 MHz)
+   needs followers supporting it and stronger pull-up resistors (around 1 kOhm) - the 1 MHz
+   results are invalid if the transfers fail.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <Wire.h>
+
+#define EEPROM_ADDRESS    0x50
+#define DISPLAY_ADDRESS   0x3C
+#define BLOCK_SIZE        1024
+#define REPEAT_COUNT      10
+
+const uint32_t bus_speeds[] = { 100000, 400000, 1000000 };
+const uint8_t bus_speed_count = sizeof(bus_speeds) / sizeof(bus_speeds[0]);
+
+uint8_t buffer[BLOCK_SIZE];
+
+uint32_t measure_read(size_t dma_threshold);
+uint32_t measure_write(size_t dma_threshold);
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+  Serial.printf("I2C throughput benchmark with %u byte blocks\n", BLOCK_SIZE);
+
+  Wire.begin();
+  for (uint8_t i = 0; i < bus_speed_count; i++) {
+    Wire.setClock(bus_speeds[i]);
+    Serial.printf("%lu Hz - bus limit %lu B/s\n", bus_speeds[i], bus_speeds[i] / 9);
+    // A threshold over the transfer size runs everything from the interrupt, zero uses DMA for everything
+    uint32_t read_interrupt = measure_read(2 * BLOCK_SIZE);
+    uint32_t read_dma = measure_read(0);
+    uint32_t write_interrupt = measure_write(2 * BLOCK_SIZE);
+    uint32_t write_dma = measure_write(0);
+    Serial.printf(" EEPROM read:   interrupt %6lu B/s, DMA %6lu B/s\n", read_interrupt, read_dma);
+    Serial.printf(" display write: interrupt %6lu B/s, DMA %6lu B/s\n", write_interrupt, write_dma);
+  }
+  Wire.setDmaThreshold(WIRE_DMA_THRESHOLD);
+  Serial.println("Done - zero means the follower did not respond");
+}
+
+void loop()
+{
+}
+
+// Returns the bytes per second of reading blocks from the EEPROM
+uint32_t measure_read(size_t dma_threshold)
+{
+  const uint8_t memory_address[2] = { 0x00, 0x00 };
+  Wire.setDmaThreshold(dma_threshold);
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < REPEAT_COUNT; i++) {
+    if (Wire.requestFrom(EEPROM_ADDRESS, memory_address, sizeof(memory_address), buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+      return 0;
+    }
+  }
+  uint32_t elapsed_us = micros() - start;
+  return (uint32_t)((uint64_t)BLOCK_SIZE * REPEAT_COUNT * 1000000u / elapsed_us);
+}
+
+// Returns the bytes per second of writing blocks of display data
+uint32_t measure_write(size_t dma_threshold)
+{
+  // Co = 0, D/C# = 1 - all the following bytes are display data
+  const uint8_t control_byte = 0x40;
+  Wire.setDmaThreshold(dma_threshold);
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < REPEAT_COUNT; i++) {
+    if (Wire.writeTo(DISPLAY_ADDRESS, &control_byte, 1, buffer, BLOCK_SIZE) != TwoWire::SUCCESS) {
+      return 0;
+    }
+  }
+  uint32_t elapsed_us = micros() - start;
+  return (uint32_t)((uint64_t)BLOCK_SIZE * REPEAT_COUNT * 1000000u / elapsed_us);
+}
@@ -0,0 +1,103 @@
+/*
+   I2C transaction list example
+
+   The example shows how to poll multiple I2C sensors in the background with a transaction list.
+
+   All the register reads of a polling round are described as steps of a single transaction list.
+   The list is queued with 'Wire.queueTransaction()' and the steps run back to back from the I2C
+   interrupt - the sketch doesn't wait for the bus at all. A delay step gives the sensors time to
+   finish a triggered measurement. When the list finishes, the callback marks the results ready and
+   every step has its own status - so a missing sensor doesn't hide the results of the others.
+   The sensors are polled at 100 Hz and the results are printed on Serial at 115200 baud once a second.
+
+   Connect I2C sensors to the SDA and SCL pins and set their addresses and registers below.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <Wire.h>
+
+#define SENSOR_COUNT    4
+#define POLL_PERIOD_MS  10
+
+// Follower address and data register of each sensor
+const uint8_t sensor_addresses[SENSOR_COUNT] = { 0x18, 0x19, 0x44, 0x45 };
+const uint8_t sensor_registers[SENSOR_COUNT] = { 0x28, 0x28, 0x00, 0x00 };
+// Register and value which trigger a measurement on each sensor
+const uint8_t trigger_command[2] = { 0x01, 0x01 };
+
+uint8_t sensor_data[SENSOR_COUNT][6];
+// A trigger write for all the sensors, a delay for the measurement and a register read for each sensor
+wire_step_t steps[SENSOR_COUNT * 2 + 1];
+wire_transaction_t poll_round;
+
+volatile bool round_finished = false;
+uint32_t rounds = 0;
+uint32_t failed_reads[SENSOR_COUNT];
+
+void on_round_finished(wire_transaction_t* transaction);
+
+void setup()
+{
+  Serial.begin(115200);
+  Wire.begin();
+  Wire.setClock(400000);
+
+  uint8_t step = 0;
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    steps[step++] = wire_step_write(sensor_addresses[i], trigger_command, sizeof(trigger_command));
+  }
+  steps[step++] = wire_step_delay(2000);
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    steps[step++] = wire_step_write_read(sensor_addresses[i], &sensor_registers[i], 1, sensor_data[i], sizeof(sensor_data[i]));
+  }
+  poll_round.steps = steps;
+  poll_round.step_count = step;
+  poll_round.callback = on_round_finished;
+}
+
+void loop()
+{
+  static uint32_t last_poll = 0;
+  static uint32_t last_print = 0;
+
+  if (millis() - last_poll >= POLL_PERIOD_MS) {
+    last_poll = millis();
+    Wire.queueTransaction(&poll_round);
+  }
+
+  if (round_finished) {
+    round_finished = false;
+    rounds++;
+    // The read steps are after the trigger writes and the delay
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+      if (steps[SENSOR_COUNT + 1 + i].status != TwoWire::SUCCESS) {
+        failed_reads[i]++;
+      }
+    }
+  }
+
+  if (millis() - last_print >= 1000) {
+    last_print = millis();
+    Serial.printf("Rounds: %lu\n", rounds);
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+      Serial.printf(" 0x%02x: %02x %02x %02x %02x %02x %02x failed: %lu\n", sensor_addresses[i],
+                    sensor_data[i][0], sensor_data[i][1], sensor_data[i][2],
+                    sensor_data[i][3], sensor_data[i][4], sensor_data[i][5], failed_reads[i]);
+    }
+  }
+}
+
+void on_round_finished(wire_transaction_t* transaction)
+{
+  (void)transaction;
+  round_finished = true;
+}
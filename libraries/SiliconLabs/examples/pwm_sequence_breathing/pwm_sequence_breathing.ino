@@ -0,0 +1,65 @@
+/*
+   PWM sequence breathing LED example
+
+   The example shows how to animate a PWM output without CPU involvement.
+
+   The sketch fills a buffer with one period of a breathing curve and hands it over to the PWM which
+   plays it in a loop. A new compare value is moved to the timer by DMA at the end of every PWM period -
+   so the animation is perfectly smooth and the CPU is free to do other things (or to sleep).
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#define PWM_FREQUENCY     200
+#define BREATHING_PERIOD  2   // seconds
+#define SEQUENCE_SIZE     (PWM_FREQUENCY * BREATHING_PERIOD)
+
+uint32_t breathing_sequence[SEQUENCE_SIZE];
+volatile uint32_t breaths = 0;
+
+void on_breath_finished(PinName pin, uint8_t buffer_index);
+
+void setup()
+{
+  Serial.begin(115200);
+  // Use 16 bit duty cycle values and start the LED pin with the sequence frequency
+  analogWriteResolution(16);
+  if (!analogWriteFrequency(LED_BUILTIN, PWM_FREQUENCY)) {
+    Serial.println("Failed to start the PWM");
+    return;
+  }
+
+  // Fill the buffer with one period of a breathing curve - the compare values are valid for the current frequency
+  PinName led_pin = pinToPinName(LED_BUILTIN);
+  for (int i = 0; i < SEQUENCE_SIZE; i++) {
+    float level = 0.5f - 0.5f * cosf(2.0f * PI * i / SEQUENCE_SIZE);
+    breathing_sequence[i] = PWM.duty_cycle_to_compare_value(led_pin, (uint32_t)(level * level * 65535.0f));
+  }
+
+  // Play the buffer continuously on the LED
+  sl_status_t status = PWM.sequence_start(led_pin, breathing_sequence, SEQUENCE_SIZE, PWM_SEQUENCE_LOOP, on_breath_finished);
+  if (status != SL_STATUS_OK) {
+    Serial.println("Failed to start the PWM sequence");
+  }
+}
+
+void loop()
+{
+  Serial.printf("Breaths: %lu\n", breaths);
+  delay(1000);
+}
+
+void on_breath_finished(PinName pin, uint8_t buffer_index)
+{
+  (void)pin;
+  (void)buffer_index;
+  breaths++;
+}
@@ -0,0 +1,59 @@
+/*
+   PWM smooth fade example
+
+   The example shows how to fade multiple LEDs smoothly with high resolution PWM.
+
+   The PWM duty cycles are written with 16 bit resolution directly to the timer - so even the
+   lowest brightness levels have fine steps. The three pins are updated together with
+   'analogWriteBatch()' - the new duty cycles take effect in the same PWM period, so the
+   channels never drift apart.
+   Connect LEDs (with a current limiting resistor) to D0, D1 and D2.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#define FADE_STEPS      256
+#define PWM_FREQUENCY   2000
+
+const pin_size_t led_pins[] = { D0, D1, D2 };
+const uint8_t led_count = sizeof(led_pins) / sizeof(led_pins[0]);
+
+void setup()
+{
+  Serial.begin(115200);
+  // Use 16 bit duty cycle values
+  analogWriteResolution(16);
+  // Run the PWM above the visible flicker range
+  // Pins with the same frequency share a timer - so their updates land in the same period
+  for (uint8_t i = 0; i < led_count; i++) {
+    if (!analogWriteFrequency(led_pins[i], PWM_FREQUENCY)) {
+      Serial.println("Failed to set the PWM frequency");
+    }
+  }
+}
+
+void loop()
+{
+  static uint32_t step = 0;
+  int duty_cycles[led_count];
+
+  // Calculate a phase shifted breathing curve for each LED
+  // Squaring the sine compensates for the non-linear brightness perception of the eye
+  for (uint8_t i = 0; i < led_count; i++) {
+    float phase = 2.0f * PI * (float)((step + i * FADE_STEPS / led_count) % FADE_STEPS) / FADE_STEPS;
+    float level = 0.5f + 0.5f * sinf(phase);
+    duty_cycles[i] = (int)(level * level * 65535.0f);
+  }
+
+  analogWriteBatch(led_pins, duty_cycles, led_count);
+  step = (step + 1) % FADE_STEPS;
+  delay(10);
+}
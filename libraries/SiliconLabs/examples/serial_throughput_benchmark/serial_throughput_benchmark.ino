@@ -0,0 +1,156 @@
+/*
+   Serial throughput benchmark example
+
+   The example measures the throughput of a serial port at different baud rates - from the
+   default 115200 up to 4 Mbaud.
+
+   A block of data is sent on Serial1 and received back through a loopback connection. The
+   transmission runs from DMA in the background while the received data is collected by DMA
+   into a large receive buffer. Each received byte is checked against the sent pattern and
+   the error counters of the port are reported - so the sketch also validates that the link
+   is reliable at the given baud rate. The results are printed on Serial at 115200 baud.
+
+   Before the benchmark a few frame configs are checked - 'Serial1.getConfig()' shows whether
+   the peripheral applied the requested config or fell back to 8N1 (the EUSART has no 5 and 6
+   data bit frames). The applied configs are verified with a short loopback transfer.
+
+   Connect the TX and RX pins of Serial1 together before running the sketch.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#define BLOCK_SIZE          4096
+#define RECEIVE_TIMEOUT_MS  3000
+#define FRAME_CHECK_SIZE    64
+
+typedef struct {
+  uint16_t config;
+  const char* name;
+  uint8_t data_mask;
+} frame_config_t;
+
+const frame_config_t frame_configs[] = {
+  { SERIAL_8N1, "8N1", 0xFF },
+  { SERIAL_8E1, "8E1", 0xFF },
+  { SERIAL_8O2, "8O2", 0xFF },
+  { SERIAL_7E1, "7E1", 0x7F },
+  { SERIAL_5N1, "5N1", 0x1F },
+};
+const uint8_t frame_config_count = sizeof(frame_configs) / sizeof(frame_configs[0]);
+
+const unsigned long baud_rates[] = { 115200, 460800, 921600, 2000000, 3000000, 4000000 };
+const uint8_t baud_rate_count = sizeof(baud_rates) / sizeof(baud_rates[0]);
+
+uint8_t tx_block[BLOCK_SIZE];
+
+void check_frame_config(const frame_config_t* frame_config);
+void run_benchmark(unsigned long baud_rate);
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("Serial throughput benchmark");
+
+  for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+    tx_block[i] = (uint8_t)(i * 7 + (i >> 8));
+  }
+
+  // The whole block fits in the receive buffer - no data is lost while we're busy sending
+  if (!Serial1.setRxBufferSize(BLOCK_SIZE) || !Serial1.setTxBufferSize(1024)) {
+    Serial.println("Failed to set the buffer sizes");
+    return;
+  }
+
+  for (uint8_t i = 0; i < frame_config_count; i++) {
+    check_frame_config(&frame_configs[i]);
+  }
+  for (uint8_t i = 0; i < baud_rate_count; i++) {
+    run_benchmark(baud_rates[i]);
+  }
+  Serial.println("Done");
+}
+
+void loop()
+{
+}
+
+void check_frame_config(const frame_config_t* frame_config)
+{
+  Serial1.begin(115200, frame_config->config);
+  if (Serial1.getConfig() != frame_config->config) {
+    Serial.printf("%s: not supported by the peripheral - running at 8N1\n", frame_config->name);
+    Serial1.end();
+    return;
+  }
+  Serial1.clearErrorCounters();
+  // Only the bits which fit the frame are sent back
+  Serial1.write(tx_block, FRAME_CHECK_SIZE);
+  uint32_t received = 0;
+  uint32_t mismatches = 0;
+  uint32_t timeout_start = millis();
+  while (received < FRAME_CHECK_SIZE && (millis() - timeout_start) < RECEIVE_TIMEOUT_MS) {
+    int data = Serial1.read();
+    if (data < 0) {
+      continue;
+    }
+    if (((uint8_t)data & frame_config->data_mask) != (tx_block[received] & frame_config->data_mask)) {
+      mismatches++;
+    }
+    received++;
+  }
+  bool passed = (received == FRAME_CHECK_SIZE && mismatches == 0 && Serial1.getFramingErrorCount() == 0 && Serial1.getParityErrorCount() == 0);
+  Serial.printf("%s: applied - loopback %s (%lu/%u bytes, mismatches: %lu, framing: %lu, parity: %lu)\n",
+                frame_config->name,
+                passed ? "OK" : "FAILED",
+                received,
+                FRAME_CHECK_SIZE,
+                mismatches,
+                Serial1.getFramingErrorCount(),
+                Serial1.getParityErrorCount());
+  Serial1.end();
+}
+
+void run_benchmark(unsigned long baud_rate)
+{
+  Serial1.begin(baud_rate, SERIAL_8N1);
+  Serial1.clearErrorCounters();
+
+  uint32_t start = micros();
+  Serial1.write(tx_block, BLOCK_SIZE);
+
+  uint32_t received = 0;
+  uint32_t mismatches = 0;
+  uint32_t timeout_start = millis();
+  while (received < BLOCK_SIZE && (millis() - timeout_start) < RECEIVE_TIMEOUT_MS) {
+    int data = Serial1.read();
+    if (data < 0) {
+      continue;
+    }
+    if ((uint8_t)data != tx_block[received]) {
+      mismatches++;
+    }
+    received++;
+  }
+  uint32_t elapsed_us = micros() - start;
+
+  uint32_t bytes_per_sec = (elapsed_us > 0) ? (uint32_t)((uint64_t)received * 1000000u / elapsed_us) : 0;
+  Serial.printf("%7lu baud: %4lu/%u bytes in %6lu us - %6lu bytes/s - mismatches: %lu, overrun: %lu, framing: %lu, overflow: %lu\n",
+                baud_rate,
+                received,
+                BLOCK_SIZE,
+                elapsed_us,
+                bytes_per_sec,
+                mismatches,
+                Serial1.getOverrunErrorCount(),
+                Serial1.getFramingErrorCount(),
+                Serial1.getRxOverflowCount());
+  Serial1.end();
+}
@@ -0,0 +1,67 @@
+/*
+   SPI follower example
+
+   The example shows how to use the board as an SPI follower (slave) device - e.g. as a
+   co-processor behind a Linux host.
+
+   The host (leader) clocks the bus and selects the board with the chip select pin. The
+   received data is collected by DMA into a buffer while the response is sent from another
+   one - the CPU is not involved in the transfer. When the host deasserts the chip select the
+   callback gets the number of received bytes and the buffers are rearmed for the next transfer.
+   Each transfer answers with the data received in the previous one. The number of transfers
+   and the last received length are printed on Serial at 115200 baud.
+
+   Connect the SPI pins (SCK, MOSI, MISO and SS) of the board to the SPI leader.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <SPI.h>
+
+#define BUFFER_SIZE   256
+
+uint8_t buffers[2][BUFFER_SIZE];
+volatile uint8_t rx_index = 0;
+volatile uint32_t transfer_count = 0;
+volatile size_t last_received = 0;
+
+void on_transfer_finished(size_t received_count);
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("SPI follower example");
+
+  if (!SPI.beginFollower(SS, SPI_MODE0, MSBFIRST)) {
+    Serial.println("Failed to start the SPI follower");
+    return;
+  }
+  SPI.onFollowerTransfer(on_transfer_finished);
+  // Receive into the first buffer and send the (empty) second one
+  SPI.setFollowerBuffers(buffers[1], buffers[0], BUFFER_SIZE);
+}
+
+void loop()
+{
+  Serial.printf("Transfers: %lu, last received: %u bytes\n", transfer_count, last_received);
+  delay(1000);
+}
+
+// Called from interrupt context when the host deasserts the chip select
+void on_transfer_finished(size_t received_count)
+{
+  last_received = received_count;
+  transfer_count++;
+  // Send back what was just received and receive into the other buffer
+  uint8_t tx_index = rx_index;
+  rx_index ^= 1;
+  SPI.setFollowerBuffers(buffers[tx_index], buffers[rx_index], BUFFER_SIZE);
+}
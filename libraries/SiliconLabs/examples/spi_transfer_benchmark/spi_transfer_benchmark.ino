@@ -0,0 +1,88 @@
+/*
+   SPI transfer benchmark example
+
+   The example measures how long SPI buffer transfers take with FIFO polling and with DMA
+   and finds the length from which DMA pays off.
+
+   Polling has no setup cost but keeps the CPU busy for the whole transfer. DMA needs some time
+   to set up and to signal the completion - but the task can sleep while the data is moving.
+   Each length is transferred with both methods and the smallest length where DMA is at most
+   10% slower than polling is reported. The result is applied with 'SPI.setDmaThreshold()' -
+   the same value can be set at startup in other sketches or with the 'SPI_DMA_THRESHOLD' define.
+   The results are printed on Serial at 115200 baud.
+
+   Nothing has to be connected to the SPI pins - the received data is not checked.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <SPI.h>
+
+#define SPI_CLOCK       8000000
+#define REPEAT_COUNT    200
+#define MAX_LENGTH      256
+
+const size_t lengths[] = { 1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256 };
+const uint8_t length_count = sizeof(lengths) / sizeof(lengths[0]);
+
+uint8_t tx_buffer[MAX_LENGTH];
+uint8_t rx_buffer[MAX_LENGTH];
+
+uint32_t measure_transfer(size_t length, size_t dma_threshold);
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+  Serial.printf("SPI transfer benchmark at %lu Hz\n", (unsigned long)SPI_CLOCK);
+
+  for (uint32_t i = 0; i < MAX_LENGTH; i++) {
+    tx_buffer[i] = (uint8_t)i;
+  }
+
+  SPI.begin();
+  SPI.beginTransaction(SPISettings(SPI_CLOCK, MSBFIRST, SPI_MODE0));
+  Serial.printf("Actual bus speed: %lu Hz\n", SPI.getCurrentBusSpeed());
+
+  size_t recommended_threshold = lengths[length_count - 1];
+  bool dma_pays_off = false;
+  for (uint8_t i = 0; i < length_count; i++) {
+    // Polling for every length, then DMA for every length
+    uint32_t polled_ns = measure_transfer(lengths[i], MAX_LENGTH);
+    uint32_t dma_ns = measure_transfer(lengths[i], 0);
+    Serial.printf("%3u bytes: polling %7lu ns, DMA %7lu ns\n", lengths[i], polled_ns, dma_ns);
+    if (!dma_pays_off && dma_ns * 10 <= polled_ns * 11) {
+      dma_pays_off = true;
+      recommended_threshold = (i > 0) ? lengths[i - 1] : 0;
+    }
+  }
+  SPI.endTransaction();
+
+  SPI.setDmaThreshold(recommended_threshold);
+  Serial.printf("Recommended DMA threshold: %u bytes\n", recommended_threshold);
+  Serial.println("Done");
+}
+
+void loop()
+{
+}
+
+// Returns the average time of one transfer in nanoseconds
+uint32_t measure_transfer(size_t length, size_t dma_threshold)
+{
+  SPI.setDmaThreshold(dma_threshold);
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < REPEAT_COUNT; i++) {
+    SPI.transfer(tx_buffer, rx_buffer, length, false);
+  }
+  uint32_t elapsed_us = micros() - start;
+  return (uint32_t)((uint64_t)elapsed_us * 1000u / REPEAT_COUNT);
+}
@@ -0,0 +1,119 @@
+/*
+   SPI NOR flash benchmark example
+
+   The example measures the erase, program and read throughput of an external SPI NOR flash memory.
+
+   The memory is probed with its JEDEC ID. A few sectors are erased and programmed with a test
+   pattern - the page programs are queued and run by a background task while the sketch measures
+   how long queueing took and how long the memory needed to finish. The data is read back with
+   large streaming reads (DMA) and with small reads which are served from the read cache, and it's
+   verified against the pattern. The results are printed on Serial at 115200 baud.
+
+   Connect the memory to the SPI pins of the board and its chip select to the SS pin. Set
+   USE_MOCK_FLASH to 1 to run the benchmark on a RAM based mock memory without any hardware.
+
+   Compatible boards:
+   - Arduino Nano Matter
+   - SparkFun Thing Plus MGM240P
+   - xG27 Dev Kit
+   - xG24 Explorer Kit
+   - xG24 Dev Kit
+   - BGM220 Explorer Kit
+   - Ezurio Lyra 24P 20dBm Dev Kit
+   - Seeed Studio XIAO MG24 (Sense)
+ */
+
+#include <SpiNorFlash.h>
+
+#define USE_MOCK_FLASH    0
+#define TEST_SIZE         16384
+#define SMALL_READ_SIZE   4
+
+#if USE_MOCK_FLASH
+uint8_t mock_storage[65536];
+SpiNorFlashMock flash_bus(mock_storage, sizeof(mock_storage));
+#else
+SpiNorFlashSpiBus flash_bus(SPI, SS, 20000000);
+#endif
+SpiNorFlash flash(flash_bus);
+
+uint8_t buffer[TEST_SIZE];
+
+uint8_t pattern(uint32_t address);
+void print_throughput(const char* name, uint32_t bytes, uint32_t elapsed_us);
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("SPI NOR flash benchmark");
+
+  if (!flash.begin()) {
+    Serial.println("No flash memory found");
+    return;
+  }
+  Serial.printf("JEDEC ID: 0x%06lx, capacity: %lu bytes\n", flash.getJedecId(), flash.getCapacity());
+
+  // Erase
+  uint32_t start = micros();
+  for (uint32_t address = 0; address < TEST_SIZE; address += SPI_NOR_FLASH_SECTOR_SIZE) {
+    flash.eraseSector(address);
+  }
+  flash.waitIdle();
+  print_throughput("Sector erase", TEST_SIZE, micros() - start);
+
+  // Program - queueing returns as soon as the pages are copied
+  for (uint32_t i = 0; i < TEST_SIZE; i++) {
+    buffer[i] = pattern(i);
+  }
+  start = micros();
+  flash.program(0, buffer, TEST_SIZE);
+  uint32_t queued_us = micros() - start;
+  flash.waitIdle();
+  print_throughput("Page program", TEST_SIZE, micros() - start);
+  Serial.printf("  queueing the pages took %lu us\n", queued_us);
+
+  // Streaming read
+  memset(buffer, 0, sizeof(buffer));
+  start = micros();
+  flash.read(0, buffer, TEST_SIZE);
+  print_throughput("Streaming read", TEST_SIZE, micros() - start);
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < TEST_SIZE; i++) {
+    if (buffer[i] != pattern(i)) {
+      errors++;
+    }
+  }
+
+  // Small sequential reads - most of them hit the read cache
+  start = micros();
+  for (uint32_t address = 0; address < TEST_SIZE; address += SMALL_READ_SIZE) {
+    uint8_t data[SMALL_READ_SIZE];
+    flash.read(address, data, SMALL_READ_SIZE);
+    for (uint32_t i = 0; i < SMALL_READ_SIZE; i++) {
+      if (data[i] != pattern(address + i)) {
+        errors++;
+      }
+    }
+  }
+  print_throughput("Cached small reads", TEST_SIZE, micros() - start);
+  Serial.printf("  cache hits: %lu, misses: %lu\n", flash.getCacheHitCount(), flash.getCacheMissCount());
+
+  Serial.printf("Verify errors: %lu, failed operations: %lu\n", errors, flash.getFailedOperationCount());
+  Serial.println("Done");
+}
+
+void loop()
+{
+}
+
+uint8_t pattern(uint32_t address)
+{
+  return (uint8_t)(address * 7 + (address >> 8));
+}
+
+void print_throughput(const char* name, uint32_t bytes, uint32_t elapsed_us)
+{
+  uint32_t bytes_per_sec = (elapsed_us > 0) ? (uint32_t)((uint64_t)bytes * 1000000u / elapsed_us) : 0;
+  Serial.printf("%-20s %6lu bytes in %8lu us - %7lu bytes/s\n", name, bytes, elapsed_us, bytes_per_sec);
+}
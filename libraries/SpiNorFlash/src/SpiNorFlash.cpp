@@ -0,0 +1,470 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "SpiNorFlash.h"
+
+// Maximum durations of the write operations and the polling interval of the busy flag
+static const uint32_t program_timeout_ms = 10u;
+static const uint32_t sector_erase_timeout_ms = 1000u;
+static const uint32_t sector_erase_poll_interval_ms = 2u;
+static const uint32_t chip_erase_timeout_ms = 400000u;
+static const uint32_t chip_erase_poll_interval_ms = 100u;
+static const uint32_t worker_task_priority = 1u;
+
+SpiNorFlashSpiBus::SpiNorFlashSpiBus(SilabsSPI& spi, pin_size_t cs_pin, uint32_t clock_freq) :
+  spi(spi),
+  cs_pin(cs_pin),
+  settings(clock_freq, MSBFIRST, SPI_MODE0)
+{
+  ;
+}
+
+bool SpiNorFlashSpiBus::begin()
+{
+  pinMode(this->cs_pin, OUTPUT);
+  digitalWrite(this->cs_pin, HIGH);
+  this->spi.begin();
+  return true;
+}
+
+void SpiNorFlashSpiBus::end()
+{
+  // The SPI peripheral can be shared with other devices - it's left running
+  digitalWrite(this->cs_pin, HIGH);
+}
+
+void SpiNorFlashSpiBus::command(const uint8_t* header, size_t header_size, const uint8_t* tx_data, uint8_t* rx_data, size_t data_size)
+{
+  this->spi.beginTransaction(this->settings);
+  digitalWrite(this->cs_pin, LOW);
+  // The header is short - it's sent by polling
+  this->spi.transfer((void*)header, header_size, true);
+  // Long data phases go through DMA while the task sleeps
+  if (data_size > 0u) {
+    if (rx_data != nullptr) {
+      this->spi.receive(rx_data, data_size, false);
+    } else if (tx_data != nullptr) {
+      this->spi.transfer((void*)tx_data, data_size, false);
+    }
+  }
+  digitalWrite(this->cs_pin, HIGH);
+  this->spi.endTransaction();
+}
+
+SpiNorFlash::SpiNorFlash(SpiNorFlashBus& bus) :
+  bus(bus),
+  initialized(false),
+  jedec_id(0u),
+  capacity(0u),
+  address_4b(false),
+  pending_operations(0u),
+  failed_operations(0u),
+  cache_hits(0u),
+  cache_misses(0u),
+  cache_use_count(0u),
+  cache(),
+  worker_task_handle(nullptr)
+{
+  this->flash_mutex = xSemaphoreCreateMutexStatic(&this->flash_mutex_buf);
+  configASSERT(this->flash_mutex);
+  this->worker_stopped = xSemaphoreCreateBinaryStatic(&this->worker_stopped_buf);
+  configASSERT(this->worker_stopped);
+  this->operation_queue = xQueueCreateStatic(SPI_NOR_FLASH_QUEUE_DEPTH,
+                                             sizeof(operation_t),
+                                             this->operation_queue_storage,
+                                             &this->operation_queue_buf);
+  configASSERT(this->operation_queue);
+}
+
+bool SpiNorFlash::begin()
+{
+  if (this->initialized) {
+    return true;
+  }
+  if (!this->bus.begin()) {
+    return false;
+  }
+
+  // Wake the memory in case it was left in deep power-down
+  uint8_t header = SPI_NOR_CMD_RELEASE_POWER_DOWN;
+  this->bus.command(&header, 1u, nullptr, nullptr, 0u);
+  delayMicroseconds(50);
+
+  uint8_t id[3];
+  header = SPI_NOR_CMD_READ_JEDEC_ID;
+  this->bus.command(&header, 1u, nullptr, id, sizeof(id));
+  this->jedec_id = ((uint32_t)id[0] << 16) | ((uint32_t)id[1] << 8) | id[2];
+  // A missing memory reads as all zeros or all ones
+  if (this->jedec_id == 0u || this->jedec_id == 0xFFFFFFu) {
+    return false;
+  }
+  // The capacity code is the base two logarithm of the size
+  if (id[2] < 0x0Fu || id[2] > 0x1Fu) {
+    return false;
+  }
+  this->capacity = 1u << id[2];
+  this->address_4b = (this->capacity > 0x1000000u);
+
+  for (uint8_t i = 0u; i < SPI_NOR_FLASH_CACHE_LINE_COUNT; i++) {
+    this->cache[i].valid = false;
+  }
+  // Operations queued while the previous run was stopping are dropped
+  xQueueReset(this->operation_queue);
+  this->pending_operations = 0u;
+  this->failed_operations = 0u;
+
+  this->worker_task_handle = xTaskCreateStatic(SpiNorFlash::worker_task,
+                                               "spi_nor_flash",
+                                               worker_task_stack_size,
+                                               this,
+                                               worker_task_priority,
+                                               this->worker_task_stack,
+                                               &this->worker_task_buf);
+  if (this->worker_task_handle == nullptr) {
+    return false;
+  }
+  this->initialized = true;
+  return true;
+}
+
+void SpiNorFlash::end()
+{
+  if (!this->initialized) {
+    return;
+  }
+  this->waitIdle();
+  // New operations are refused from here on - the ones queued meanwhile run before the stop request
+  this->initialized = false;
+  this->stop_worker();
+  this->bus.end();
+}
+
+uint32_t SpiNorFlash::getJedecId()
+{
+  return this->jedec_id;
+}
+
+uint32_t SpiNorFlash::getCapacity()
+{
+  return this->capacity;
+}
+
+bool SpiNorFlash::read(uint32_t address, void* buffer, size_t size)
+{
+  if (!this->initialized || buffer == nullptr || address >= this->capacity || size > this->capacity - address) {
+    return false;
+  }
+  if (size == 0u) {
+    return true;
+  }
+  // Reads have to see the data of the queued writes
+  this->waitIdle();
+
+  xSemaphoreTake(this->flash_mutex, portMAX_DELAY);
+  if (size > SPI_NOR_FLASH_CACHE_LINE_SIZE) {
+    this->read_direct(address, (uint8_t*)buffer, size);
+  } else {
+    // A small read touches one or two cache lines
+    uint8_t* destination = (uint8_t*)buffer;
+    while (size > 0u) {
+      uint32_t line_address = address - (address % SPI_NOR_FLASH_CACHE_LINE_SIZE);
+      uint32_t offset = address - line_address;
+      size_t chunk_size = SPI_NOR_FLASH_CACHE_LINE_SIZE - offset;
+      if (chunk_size > size) {
+        chunk_size = size;
+      }
+      const uint8_t* line = this->cache_get_line(line_address);
+      memcpy(destination, line + offset, chunk_size);
+      destination += chunk_size;
+      address += chunk_size;
+      size -= chunk_size;
+    }
+  }
+  xSemaphoreGive(this->flash_mutex);
+  return true;
+}
+
+bool SpiNorFlash::program(uint32_t address, const void* data, size_t size)
+{
+  if (!this->initialized || data == nullptr || address >= this->capacity || size > this->capacity - address) {
+    return false;
+  }
+  // Page programs can't cross page boundaries - the data is split along them
+  const uint8_t* source = (const uint8_t*)data;
+  operation_t operation;
+  operation.type = OPERATION_PROGRAM;
+  while (size > 0u) {
+    size_t chunk_size = SPI_NOR_FLASH_PAGE_SIZE - (address % SPI_NOR_FLASH_PAGE_SIZE);
+    if (chunk_size > size) {
+      chunk_size = size;
+    }
+    operation.address = address;
+    operation.size = (uint16_t)chunk_size;
+    memcpy(operation.data, source, chunk_size);
+    this->enqueue(&operation);
+    source += chunk_size;
+    address += chunk_size;
+    size -= chunk_size;
+  }
+  return true;
+}
+
+bool SpiNorFlash::eraseSector(uint32_t address)
+{
+  if (!this->initialized || address >= this->capacity) {
+    return false;
+  }
+  operation_t operation;
+  operation.type = OPERATION_ERASE_SECTOR;
+  operation.address = address - (address % SPI_NOR_FLASH_SECTOR_SIZE);
+  operation.size = 0u;
+  return this->enqueue(&operation);
+}
+
+bool SpiNorFlash::eraseChip()
+{
+  if (!this->initialized) {
+    return false;
+  }
+  operation_t operation;
+  operation.type = OPERATION_ERASE_CHIP;
+  operation.address = 0u;
+  operation.size = 0u;
+  return this->enqueue(&operation);
+}
+
+bool SpiNorFlash::waitIdle(uint32_t timeout_ms)
+{
+  uint32_t start = millis();
+  while (this->pending_operations > 0u) {
+    if ((millis() - start) >= timeout_ms) {
+      return false;
+    }
+    delay(1);
+  }
+  return true;
+}
+
+bool SpiNorFlash::isBusy()
+{
+  return this->pending_operations > 0u;
+}
+
+uint32_t SpiNorFlash::getFailedOperationCount()
+{
+  return this->failed_operations;
+}
+
+uint32_t SpiNorFlash::getCacheHitCount()
+{
+  return this->cache_hits;
+}
+
+uint32_t SpiNorFlash::getCacheMissCount()
+{
+  return this->cache_misses;
+}
+
+void SpiNorFlash::worker_task(void* param)
+{
+  SpiNorFlash* flash = (SpiNorFlash*)param;
+  operation_t operation;
+  while (1) {
+    xQueueReceive(flash->operation_queue, &operation, portMAX_DELAY);
+    if (operation.type == OPERATION_STOP) {
+      break;
+    }
+    // The memory can't be read while it's busy - reads wait until the operation finishes
+    xSemaphoreTake(flash->flash_mutex, portMAX_DELAY);
+    flash->run_operation(&operation);
+    xSemaphoreGive(flash->flash_mutex);
+    taskENTER_CRITICAL();
+    flash->pending_operations--;
+    taskEXIT_CRITICAL();
+  }
+  // Nothing is held here - the task waits to be deleted by 'stop_worker()'
+  xSemaphoreGive(flash->worker_stopped);
+  vTaskSuspend(nullptr);
+}
+
+void SpiNorFlash::run_operation(const operation_t* operation)
+{
+  uint8_t header[5];
+  size_t header_size;
+  bool finished = false;
+
+  this->write_enable();
+  switch (operation->type) {
+    case OPERATION_PROGRAM:
+      header_size = this->build_header(header, SPI_NOR_CMD_PAGE_PROGRAM, SPI_NOR_CMD_PAGE_PROGRAM_4B, operation->address);
+      this->bus.command(header, header_size, operation->data, nullptr, operation->size);
+      // A page takes well below a millisecond - the busy flag is polled without sleeping
+      finished = this->wait_ready(program_timeout_ms, 0u);
+      this->cache_invalidate(operation->address, operation->size);
+      break;
+
+    case OPERATION_ERASE_SECTOR:
+      header_size = this->build_header(header, SPI_NOR_CMD_SECTOR_ERASE, SPI_NOR_CMD_SECTOR_ERASE_4B, operation->address);
+      this->bus.command(header, header_size, nullptr, nullptr, 0u);
+      finished = this->wait_ready(sector_erase_timeout_ms, sector_erase_poll_interval_ms);
+      this->cache_invalidate(operation->address, SPI_NOR_FLASH_SECTOR_SIZE);
+      break;
+
+    case OPERATION_ERASE_CHIP:
+      header[0] = SPI_NOR_CMD_CHIP_ERASE;
+      this->bus.command(header, 1u, nullptr, nullptr, 0u);
+      finished = this->wait_ready(chip_erase_timeout_ms, chip_erase_poll_interval_ms);
+      this->cache_invalidate(0u, this->capacity);
+      break;
+
+    default:
+      finished = true;
+      break;
+  }
+  if (!finished) {
+    this->failed_operations++;
+  }
+}
+
+bool SpiNorFlash::enqueue(const operation_t* operation)
+{
+  taskENTER_CRITICAL();
+  this->pending_operations++;
+  taskEXIT_CRITICAL();
+  // Only waits if the queue is full
+  xQueueSend(this->operation_queue, operation, portMAX_DELAY);
+  return true;
+}
+
+void SpiNorFlash::stop_worker()
+{
+  // The stop request goes through the queue so the task finishes the operations ahead of it
+  // and only exits between two operations - it isn't counted as a pending operation
+  operation_t operation;
+  operation.type = OPERATION_STOP;
+  operation.address = 0u;
+  operation.size = 0u;
+  xQueueSend(this->operation_queue, &operation, portMAX_DELAY);
+  xSemaphoreTake(this->worker_stopped, portMAX_DELAY);
+  vTaskDelete(this->worker_task_handle);
+  this->worker_task_handle = nullptr;
+}
+
+bool SpiNorFlash::wait_ready(uint32_t timeout_ms, uint32_t poll_interval_ms)
+{
+  uint32_t start = millis();
+  while (this->read_status() & SPI_NOR_STATUS_BUSY) {
+    if ((millis() - start) >= timeout_ms) {
+      return false;
+    }
+    if (poll_interval_ms == 0u) {
+      taskYIELD();
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(poll_interval_ms));
+    }
+  }
+  return true;
+}
+
+uint8_t SpiNorFlash::read_status()
+{
+  uint8_t header = SPI_NOR_CMD_READ_STATUS;
+  uint8_t status = 0u;
+  this->bus.command(&header, 1u, nullptr, &status, 1u);
+  return status;
+}
+
+void SpiNorFlash::write_enable()
+{
+  uint8_t header = SPI_NOR_CMD_WRITE_ENABLE;
+  this->bus.command(&header, 1u, nullptr, nullptr, 0u);
+}
+
+size_t SpiNorFlash::build_header(uint8_t* header, uint8_t opcode, uint8_t opcode_4b, uint32_t address)
+{
+  size_t header_size = 0u;
+  if (this->address_4b) {
+    header[header_size++] = opcode_4b;
+    header[header_size++] = (uint8_t)(address >> 24);
+  } else {
+    header[header_size++] = opcode;
+  }
+  header[header_size++] = (uint8_t)(address >> 16);
+  header[header_size++] = (uint8_t)(address >> 8);
+  header[header_size++] = (uint8_t)address;
+  return header_size;
+}
+
+void SpiNorFlash::read_direct(uint32_t address, uint8_t* buffer, size_t size)
+{
+  // Fast read needs one dummy byte after the address but works at the full clock speed of the memory
+  uint8_t header[6];
+  size_t header_size = this->build_header(header, SPI_NOR_CMD_FAST_READ, SPI_NOR_CMD_FAST_READ_4B, address);
+  header[header_size++] = 0u;
+  this->bus.command(header, header_size, nullptr, buffer, size);
+}
+
+const uint8_t* SpiNorFlash::cache_get_line(uint32_t line_address)
+{
+  cache_line_t* line = nullptr;
+  for (uint8_t i = 0u; i < SPI_NOR_FLASH_CACHE_LINE_COUNT; i++) {
+    if (this->cache[i].valid && this->cache[i].address == line_address) {
+      line = &this->cache[i];
+      break;
+    }
+  }
+  if (line != nullptr) {
+    this->cache_hits++;
+  } else {
+    // Reuse an empty line or the least recently used one
+    line = &this->cache[0];
+    for (uint8_t i = 0u; i < SPI_NOR_FLASH_CACHE_LINE_COUNT; i++) {
+      if (!this->cache[i].valid) {
+        line = &this->cache[i];
+        break;
+      }
+      if (this->cache[i].last_used < line->last_used) {
+        line = &this->cache[i];
+      }
+    }
+    this->read_direct(line_address, line->data, SPI_NOR_FLASH_CACHE_LINE_SIZE);
+    line->address = line_address;
+    line->valid = true;
+    this->cache_misses++;
+  }
+  line->last_used = ++this->cache_use_count;
+  return line->data;
+}
+
+void SpiNorFlash::cache_invalidate(uint32_t address, uint32_t size)
+{
+  for (uint8_t i = 0u; i < SPI_NOR_FLASH_CACHE_LINE_COUNT; i++) {
+    uint32_t line_address = this->cache[i].address;
+    if (line_address < address + size && address < line_address + SPI_NOR_FLASH_CACHE_LINE_SIZE) {
+      this->cache[i].valid = false;
+    }
+  }
+}
@@ -0,0 +1,253 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SPI_NOR_FLASH_H
+#define SPI_NOR_FLASH_H
+
+#include "Arduino.h"
+#include "SPI.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "queue.h"
+#include "task.h"
+#include "SpiNorFlashBus.h"
+#include "SpiNorFlashMock.h"
+
+#define SPI_NOR_FLASH_PAGE_SIZE    256u
+#define SPI_NOR_FLASH_SECTOR_SIZE  4096u
+
+// Small reads are served from a set of cached lines - larger ones are streamed directly into the buffer
+#ifndef SPI_NOR_FLASH_CACHE_LINE_SIZE
+#define SPI_NOR_FLASH_CACHE_LINE_SIZE 64u
+#endif // SPI_NOR_FLASH_CACHE_LINE_SIZE
+
+#ifndef SPI_NOR_FLASH_CACHE_LINE_COUNT
+#define SPI_NOR_FLASH_CACHE_LINE_COUNT 4u
+#endif // SPI_NOR_FLASH_CACHE_LINE_COUNT
+
+// Number of page programs and erases which can wait for the background task
+#ifndef SPI_NOR_FLASH_QUEUE_DEPTH
+#define SPI_NOR_FLASH_QUEUE_DEPTH 4u
+#endif // SPI_NOR_FLASH_QUEUE_DEPTH
+
+// Connects the driver to a flash memory on one of the SPI peripherals
+class SpiNorFlashSpiBus : public SpiNorFlashBus {
+public:
+  /***************************************************************************//**
+   * Constructor for the SpiNorFlashSpiBus
+   *
+   * @param[in] spi The SPI peripheral the memory is connected to
+   * @param[in] cs_pin The chip select pin of the memory
+   * @param[in] clock_freq The SPI clock frequency in Hz
+   ******************************************************************************/
+  SpiNorFlashSpiBus(SilabsSPI& spi, pin_size_t cs_pin, uint32_t clock_freq = 20000000u);
+
+  bool begin() override;
+  void end() override;
+  void command(const uint8_t* header, size_t header_size, const uint8_t* tx_data, uint8_t* rx_data, size_t data_size) override;
+
+private:
+  SilabsSPI& spi;
+  pin_size_t cs_pin;
+  SPISettings settings;
+};
+
+class SpiNorFlash {
+public:
+  /***************************************************************************//**
+   * Constructor for the SpiNorFlash
+   *
+   * @param[in] bus The bus the memory is connected to
+   ******************************************************************************/
+  SpiNorFlash(SpiNorFlashBus& bus);
+
+  /***************************************************************************//**
+   * Probes the memory and starts the background task
+   * The size of the memory is taken from the JEDEC ID.
+   *
+   * @return true if a memory was found, false otherwise
+   ******************************************************************************/
+  bool begin();
+
+  /***************************************************************************//**
+   * Finishes the queued operations and stops the background task
+   ******************************************************************************/
+  void end();
+
+  /***************************************************************************//**
+   * Returns the JEDEC ID of the memory
+   *
+   * @return the manufacturer ID, memory type and capacity code in the lower three bytes
+   ******************************************************************************/
+  uint32_t getJedecId();
+
+  /***************************************************************************//**
+   * Returns the size of the memory
+   *
+   * @return the size of the memory in bytes, zero if no memory was found
+   ******************************************************************************/
+  uint32_t getCapacity();
+
+  /***************************************************************************//**
+   * Reads data from the memory
+   * Waits until the queued writes are finished. Reads up to the cache line size are
+   * served from the read cache, longer ones are streamed directly into the buffer
+   * with DMA while the task sleeps.
+   *
+   * @param[in] address The address to read from
+   * @param[out] buffer Buffer for the data
+   * @param[in] size Number of bytes to read
+   *
+   * @return true on success, false if the range is outside of the memory
+   ******************************************************************************/
+  bool read(uint32_t address, void* buffer, size_t size);
+
+  /***************************************************************************//**
+   * Programs data into the memory in the background
+   * The data is split into pages and copied into the queue - the function only
+   * waits if the queue is full. The target area has to be erased first.
+   *
+   * @param[in] address The address to program
+   * @param[in] data The data to be programmed
+   * @param[in] size Number of bytes to program
+   *
+   * @return true if the data was queued, false if the range is outside of the memory
+   ******************************************************************************/
+  bool program(uint32_t address, const void* data, size_t size);
+
+  /***************************************************************************//**
+   * Erases a 4 KiB sector in the background
+   *
+   * @param[in] address Any address within the sector
+   *
+   * @return true if the erase was queued, false if the address is outside of the memory
+   ******************************************************************************/
+  bool eraseSector(uint32_t address);
+
+  /***************************************************************************//**
+   * Erases the whole memory in the background - can take minutes on large memories
+   *
+   * @return true if the erase was queued, false otherwise
+   ******************************************************************************/
+  bool eraseChip();
+
+  /***************************************************************************//**
+   * Waits until all queued operations are finished
+   *
+   * @param[in] timeout_ms Maximum time to wait in milliseconds
+   *
+   * @return true if the memory is idle, false on timeout
+   ******************************************************************************/
+  bool waitIdle(uint32_t timeout_ms = 0xFFFFFFFFu);
+
+  /***************************************************************************//**
+   * Checks whether there are queued or running operations
+   *
+   * @return true if an operation is pending, false otherwise
+   ******************************************************************************/
+  bool isBusy();
+
+  /***************************************************************************//**
+   * Returns the number of operations which didn't finish in time
+   *
+   * @return the number of failed operations
+   ******************************************************************************/
+  uint32_t getFailedOperationCount();
+
+  /***************************************************************************//**
+   * Returns the number of reads served from the read cache
+   *
+   * @return the number of cache hits
+   ******************************************************************************/
+  uint32_t getCacheHitCount();
+
+  /***************************************************************************//**
+   * Returns the number of cache lines loaded from the memory
+   *
+   * @return the number of cache misses
+   ******************************************************************************/
+  uint32_t getCacheMissCount();
+
+private:
+  typedef enum {
+    OPERATION_PROGRAM,
+    OPERATION_ERASE_SECTOR,
+    OPERATION_ERASE_CHIP,
+    OPERATION_STOP
+  } operation_type_t;
+
+  typedef struct {
+    operation_type_t type;
+    uint32_t address;
+    uint16_t size;
+    uint8_t data[SPI_NOR_FLASH_PAGE_SIZE];
+  } operation_t;
+
+  typedef struct {
+    uint32_t address;
+    uint32_t last_used;
+    bool valid;
+    uint8_t data[SPI_NOR_FLASH_CACHE_LINE_SIZE];
+  } cache_line_t;
+
+  static void worker_task(void* param);
+  void run_operation(const operation_t* operation);
+  bool enqueue(const operation_t* operation);
+  void stop_worker();
+  bool wait_ready(uint32_t timeout_ms, uint32_t poll_interval_ms);
+  uint8_t read_status();
+  void write_enable();
+  size_t build_header(uint8_t* header, uint8_t opcode, uint8_t opcode_4b, uint32_t address);
+  void read_direct(uint32_t address, uint8_t* buffer, size_t size);
+  const uint8_t* cache_get_line(uint32_t line_address);
+  void cache_invalidate(uint32_t address, uint32_t size);
+
+  SpiNorFlashBus& bus;
+  bool initialized;
+  uint32_t jedec_id;
+  uint32_t capacity;
+  bool address_4b;
+  volatile uint32_t pending_operations;
+  volatile uint32_t failed_operations;
+  uint32_t cache_hits;
+  uint32_t cache_misses;
+  uint32_t cache_use_count;
+  cache_line_t cache[SPI_NOR_FLASH_CACHE_LINE_COUNT];
+
+  SemaphoreHandle_t flash_mutex;
+  StaticSemaphore_t flash_mutex_buf;
+  SemaphoreHandle_t worker_stopped;
+  StaticSemaphore_t worker_stopped_buf;
+  QueueHandle_t operation_queue;
+  StaticQueue_t operation_queue_buf;
+  uint8_t operation_queue_storage[SPI_NOR_FLASH_QUEUE_DEPTH * sizeof(operation_t)];
+  TaskHandle_t worker_task_handle;
+  StaticTask_t worker_task_buf;
+  static const uint32_t worker_task_stack_size = 384u;
+  StackType_t worker_task_stack[worker_task_stack_size];
+};
+
+#endif // SPI_NOR_FLASH_H
@@ -0,0 +1,94 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SPI_NOR_FLASH_BUS_H
+#define SPI_NOR_FLASH_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Commands shared by the common SPI NOR flash memories
+enum {
+  SPI_NOR_CMD_WRITE_ENABLE = 0x06,
+  SPI_NOR_CMD_WRITE_DISABLE = 0x04,
+  SPI_NOR_CMD_READ_STATUS = 0x05,
+  SPI_NOR_CMD_READ_JEDEC_ID = 0x9F,
+  SPI_NOR_CMD_RELEASE_POWER_DOWN = 0xAB,
+  SPI_NOR_CMD_READ = 0x03,
+  SPI_NOR_CMD_FAST_READ = 0x0B,
+  SPI_NOR_CMD_PAGE_PROGRAM = 0x02,
+  SPI_NOR_CMD_SECTOR_ERASE = 0x20,
+  SPI_NOR_CMD_BLOCK_ERASE = 0xD8,
+  SPI_NOR_CMD_CHIP_ERASE = 0xC7,
+  SPI_NOR_CMD_CHIP_ERASE_ALT = 0x60,
+  // Variants with a 4 byte address for memories larger than 16 MiB
+  SPI_NOR_CMD_READ_4B = 0x13,
+  SPI_NOR_CMD_FAST_READ_4B = 0x0C,
+  SPI_NOR_CMD_PAGE_PROGRAM_4B = 0x12,
+  SPI_NOR_CMD_SECTOR_ERASE_4B = 0x21,
+  SPI_NOR_CMD_BLOCK_ERASE_4B = 0xDC
+};
+
+// Status register bits
+#define SPI_NOR_STATUS_BUSY           0x01u
+#define SPI_NOR_STATUS_WRITE_ENABLED  0x02u
+
+// Connects the SPI NOR flash driver to a flash memory
+// Kept free of any Arduino dependency so the implementations (like the mock flash) can also be built on a host
+class SpiNorFlashBus {
+public:
+  virtual ~SpiNorFlashBus()
+  {
+    ;
+  }
+
+  /***************************************************************************//**
+   * Initializes the bus
+   *
+   * @return true if the bus is ready, false otherwise
+   ******************************************************************************/
+  virtual bool begin() = 0;
+
+  /***************************************************************************//**
+   * Deinitializes the bus
+   ******************************************************************************/
+  virtual void end() = 0;
+
+  /***************************************************************************//**
+   * Runs one flash command with the chip select asserted
+   * The header (opcode, address and dummy bytes) is sent first, followed by either
+   * sending 'tx_data' or receiving into 'rx_data'.
+   *
+   * @param[in] header The opcode and the following address/dummy bytes
+   * @param[in] header_size Number of bytes in the header
+   * @param[in] tx_data Data sent after the header, nullptr if nothing is sent
+   * @param[out] rx_data Buffer for the data received after the header, nullptr if nothing is received
+   * @param[in] data_size Number of bytes sent or received after the header
+   ******************************************************************************/
+  virtual void command(const uint8_t* header, size_t header_size, const uint8_t* tx_data, uint8_t* rx_data, size_t data_size) = 0;
+};
+
+#endif // SPI_NOR_FLASH_BUS_H
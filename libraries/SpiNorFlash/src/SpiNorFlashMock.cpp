@@ -0,0 +1,193 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "SpiNorFlashMock.h"
+#include <string.h>
+
+// Reported as a Winbond memory with the capacity of the storage
+static const uint8_t mock_manufacturer_id = 0xEFu;
+static const uint8_t mock_memory_type = 0x40u;
+
+SpiNorFlashMock::SpiNorFlashMock(uint8_t* storage, size_t size) :
+  storage(storage),
+  size(size),
+  capacity_code(0u),
+  write_enabled(false),
+  busy_polls_remaining(0u),
+  program_polls(1u),
+  erase_polls(10u),
+  rejected_commands(0u)
+{
+  while (((size_t)1u << this->capacity_code) < size) {
+    this->capacity_code++;
+  }
+}
+
+bool SpiNorFlashMock::begin()
+{
+  memset(this->storage, 0xFF, this->size);
+  this->write_enabled = false;
+  this->busy_polls_remaining = 0u;
+  return true;
+}
+
+void SpiNorFlashMock::end()
+{
+  ;
+}
+
+void SpiNorFlashMock::setBusyPolls(uint32_t program_polls, uint32_t erase_polls)
+{
+  this->program_polls = program_polls;
+  this->erase_polls = erase_polls;
+}
+
+uint32_t SpiNorFlashMock::getRejectedCommandCount()
+{
+  return this->rejected_commands;
+}
+
+void SpiNorFlashMock::command(const uint8_t* header, size_t header_size, const uint8_t* tx_data, uint8_t* rx_data, size_t data_size)
+{
+  if (header == nullptr || header_size == 0u) {
+    return;
+  }
+  uint8_t opcode = header[0];
+
+  // Only the status can be read while a write is in progress
+  if (opcode == SPI_NOR_CMD_READ_STATUS) {
+    uint8_t status = 0u;
+    if (this->busy_polls_remaining > 0u) {
+      this->busy_polls_remaining--;
+      status |= SPI_NOR_STATUS_BUSY;
+    }
+    if (this->write_enabled) {
+      status |= SPI_NOR_STATUS_WRITE_ENABLED;
+    }
+    for (size_t i = 0u; rx_data != nullptr && i < data_size; i++) {
+      rx_data[i] = status;
+    }
+    return;
+  }
+  if (this->busy_polls_remaining > 0u) {
+    this->rejected_commands++;
+    return;
+  }
+
+  switch (opcode) {
+    case SPI_NOR_CMD_READ_JEDEC_ID: {
+      // JEDEC ID
+      const uint8_t id[3] = { mock_manufacturer_id, mock_memory_type, this->capacity_code };
+      for (size_t i = 0u; rx_data != nullptr && i < data_size; i++) {
+        rx_data[i] = (i < sizeof(id)) ? id[i] : 0xFFu;
+      }
+      break;
+    }
+
+    case SPI_NOR_CMD_WRITE_ENABLE:
+      this->write_enabled = true;
+      break;
+
+    case SPI_NOR_CMD_WRITE_DISABLE:
+      this->write_enabled = false;
+      break;
+
+    case SPI_NOR_CMD_READ:
+    case SPI_NOR_CMD_FAST_READ:
+    case SPI_NOR_CMD_READ_4B:
+    case SPI_NOR_CMD_FAST_READ_4B: {
+      // Read and fast read with 3 and 4 byte addresses - the address wraps around at the end of the array
+      uint32_t address = this->get_address(header, header_size);
+      for (size_t i = 0u; rx_data != nullptr && i < data_size; i++) {
+        rx_data[i] = this->storage[(address + i) & (this->size - 1u)];
+      }
+      break;
+    }
+
+    case SPI_NOR_CMD_PAGE_PROGRAM:
+    case SPI_NOR_CMD_PAGE_PROGRAM_4B: {
+      // Page program - the address wraps around within the page and bits can only be cleared
+      if (!this->write_enabled) {
+        this->rejected_commands++;
+        break;
+      }
+      uint32_t address = this->get_address(header, header_size);
+      uint32_t page_start = address & ~0xFFu;
+      for (size_t i = 0u; tx_data != nullptr && i < data_size; i++) {
+        this->storage[page_start + ((address + i) & 0xFFu)] &= tx_data[i];
+      }
+      this->write_enabled = false;
+      this->busy_polls_remaining = this->program_polls;
+      break;
+    }
+
+    case SPI_NOR_CMD_SECTOR_ERASE:
+    case SPI_NOR_CMD_SECTOR_ERASE_4B:
+      this->erase(this->get_address(header, header_size), 0x1000u);
+      break;
+
+    case SPI_NOR_CMD_BLOCK_ERASE:
+    case SPI_NOR_CMD_BLOCK_ERASE_4B:
+      this->erase(this->get_address(header, header_size), 0x10000u);
+      break;
+
+    case SPI_NOR_CMD_CHIP_ERASE:
+    case SPI_NOR_CMD_CHIP_ERASE_ALT:
+      this->erase(0u, (uint32_t)this->size);
+      break;
+
+    default:
+      // Other commands (like the release from power-down) have no effect
+      break;
+  }
+}
+
+uint32_t SpiNorFlashMock::get_address(const uint8_t* header, size_t header_size)
+{
+  // Opcodes with a 4 byte address are followed by one more address byte
+  uint8_t opcode = header[0];
+  size_t address_size = (opcode == SPI_NOR_CMD_READ_4B || opcode == SPI_NOR_CMD_FAST_READ_4B || opcode == SPI_NOR_CMD_PAGE_PROGRAM_4B
+                         || opcode == SPI_NOR_CMD_SECTOR_ERASE_4B || opcode == SPI_NOR_CMD_BLOCK_ERASE_4B) ? 4u : 3u;
+  uint32_t address = 0u;
+  for (size_t i = 1u; i <= address_size && i < header_size; i++) {
+    address = (address << 8) | header[i];
+  }
+  return address & (uint32_t)(this->size - 1u);
+}
+
+void SpiNorFlashMock::erase(uint32_t address, uint32_t erase_size)
+{
+  if (!this->write_enabled) {
+    this->rejected_commands++;
+    return;
+  }
+  if (erase_size > this->size) {
+    erase_size = (uint32_t)this->size;
+  }
+  memset(this->storage + (address & ~(erase_size - 1u)), 0xFF, erase_size);
+  this->write_enabled = false;
+  this->busy_polls_remaining = this->erase_polls;
+}
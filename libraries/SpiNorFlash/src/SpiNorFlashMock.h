@@ -0,0 +1,87 @@
+/*
+ * This file is part of the Silicon Labs Arduino Core
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright 2025 Silicon Laboratories Inc. www.silabs.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SPI_NOR_FLASH_MOCK_H
+#define SPI_NOR_FLASH_MOCK_H
+
+#include "SpiNorFlashBus.h"
+
+// RAM based model of an SPI NOR flash memory
+// Follows the behavior of a real device: programming can only clear bits, erasing sets them,
+// writes need a write enable and the memory is busy for a while after them. Busy time is counted
+// in status register reads so the model doesn't depend on a time source and also runs on a host.
+class SpiNorFlashMock : public SpiNorFlashBus {
+public:
+  /***************************************************************************//**
+   * Constructor for the SpiNorFlashMock
+   *
+   * @param[in] storage Memory used as the flash array
+   * @param[in] size Size of the memory in bytes - a power of two, at least 64 KiB
+   ******************************************************************************/
+  SpiNorFlashMock(uint8_t* storage, size_t size);
+
+  /***************************************************************************//**
+   * Erases the whole flash array (fills it with 0xFF)
+   *
+   * @return always true
+   ******************************************************************************/
+  bool begin() override;
+
+  void end() override;
+
+  void command(const uint8_t* header, size_t header_size, const uint8_t* tx_data, uint8_t* rx_data, size_t data_size) override;
+
+  /***************************************************************************//**
+   * Sets how long the memory stays busy after a write
+   *
+   * @param[in] program_polls Number of status reads returning busy after a page program
+   * @param[in] erase_polls Number of status reads returning busy after an erase
+   ******************************************************************************/
+  void setBusyPolls(uint32_t program_polls, uint32_t erase_polls);
+
+  /***************************************************************************//**
+   * Returns the number of commands ignored because of a missing write enable or
+   * because the memory was busy
+   *
+   * @return the number of rejected commands
+   ******************************************************************************/
+  uint32_t getRejectedCommandCount();
+
+private:
+  uint32_t get_address(const uint8_t* header, size_t header_size);
+  void erase(uint32_t address, uint32_t erase_size);
+
+  uint8_t* storage;
+  size_t size;
+  uint8_t capacity_code;
+  bool write_enabled;
+  uint32_t busy_polls_remaining;
+  uint32_t program_polls;
+  uint32_t erase_polls;
+  uint32_t rejected_commands;
+};
+
+#endif // SPI_NOR_FLASH_MOCK_H
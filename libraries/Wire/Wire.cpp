@@ -25,9 +25,23 @@
  */
 
 #include "Wire.h"
+#include "em_core.h"
 
 using namespace arduino;
 
+static uint8_t transfer_result_to_status(I2C_TransferReturn_TypeDef result)
+{
+  if (result == i2cTransferDone) {
+    return TwoWire::SUCCESS;
+  } else if (result == i2cTransferNack) {
+    return TwoWire::NACK_ADDRESS;
+  } else if (result == i2cTransferSwFault) {
+    // The transfers aborted by the transfer timer end with a software fault
+    return TwoWire::TIMEOUT;
+  }
+  return TwoWire::OTHER_ERROR;
+}
+
 TwoWire::TwoWire(I2C_TypeDef* i2c_peripheral,
                  uint8_t i2c_peripheral_num,
                  GPIO_Port_TypeDef i2c_scl_port,
@@ -37,6 +51,37 @@ TwoWire::TwoWire(I2C_TypeDef* i2c_peripheral,
                  I2CSPM_Init_TypeDef* i2c_config) :
   role(wire_role_t::NOT_INITIALIZED),
   timeout_flag(false),
+  reset_on_timeout(false),
+  timeout_us(25000u),
+  transfer_seq(),
+  transfer_active(false),
+  transfer_result(i2cTransferDone),
+  transfer_callback(nullptr),
+  transfer_timer(),
+  bus_clock(0u),
+  job_queue_head(nullptr),
+  job_queue_tail(nullptr),
+  job_current(nullptr),
+  dma_channel(0u),
+  dma_available(false),
+  dma_threshold(WIRE_DMA_THRESHOLD),
+  dma_state(dma_state_t::DMA_IDLE),
+  dma_result(i2cTransferDone),
+  fast_slewrate_set(false),
+  scl_port_slewrate(0u),
+  sda_port_slewrate(0u),
+  device_stats(),
+  device_stats_count(0u),
+  bus_recovery_count(0u),
+  retry_count(0u),
+  transfer_start_us(0u),
+  transfer_untracked(false),
+  scan_in_progress(false),
+  tx_buffer(tx_buffer_default),
+  rx_buffer(rx_buffer_default),
+  tx_buffer_size(default_buffer_size),
+  rx_buffer_size(default_buffer_size),
+  buffers_allocated(false),
   follower_address(0u),
   transmission_in_progress(false),
   tx_buf_write_idx(0u),
@@ -44,6 +89,16 @@ TwoWire::TwoWire(I2C_TypeDef* i2c_peripheral,
   rx_buf_available(0u),
   follower_mode_address(0u),
   follower_transaction_in_progress(false),
+  register_map(nullptr),
+  register_map_size(0u),
+  register_address_size(1u),
+  register_writable_start(0u),
+  register_writable_count(0u),
+  register_pointer(0u),
+  register_address_bytes_received(0u),
+  register_write_start(0u),
+  register_write_count(0u),
+  register_write_cb(nullptr),
   user_onreceive_cb(nullptr),
   user_onrequest_cb(nullptr),
   wire_mutex(nullptr),
@@ -55,10 +110,12 @@ TwoWire::TwoWire(I2C_TypeDef* i2c_peripheral,
   i2c_sda_pin(i2c_sda_pin),
   i2c_config(i2c_config)
 {
-  memset(this->rx_buffer, 0x00, sizeof(this->rx_buffer));
-  memset(this->tx_buffer, 0x00, sizeof(this->tx_buffer));
+  memset(this->rx_buffer_default, 0x00, sizeof(this->rx_buffer_default));
+  memset(this->tx_buffer_default, 0x00, sizeof(this->tx_buffer_default));
   this->wire_mutex = xSemaphoreCreateMutexStatic(&this->wire_mutex_buf);
   configASSERT(this->wire_mutex);
+  this->transfer_done_sem = xSemaphoreCreateBinaryStatic(&this->transfer_done_sem_buf);
+  configASSERT(this->transfer_done_sem);
 }
 
 void TwoWire::begin()
@@ -68,6 +125,10 @@ void TwoWire::begin()
   }
   this->role = wire_role_t::LEADER;
   I2CSPM_Init(this->i2c_config);
+  this->bus_clock = I2C_BusFreqGet(this->i2c_peripheral);
+  // Transfers are driven by the I2C interrupt
+  this->irq_enable(true);
+  this->dma_init();
 }
 
 void TwoWire::begin(uint8_t follower_mode_address)
@@ -125,25 +186,56 @@ void TwoWire::begin(uint8_t follower_mode_address)
   I2C_IntClear(this->i2c_peripheral, _I2C_IF_MASK);
   I2C_IntEnable(this->i2c_peripheral, I2C_IEN_ADDR | I2C_IEN_RXDATAV | I2C_IEN_ACK | I2C_IEN_SSTOP | I2C_IEN_BUSERR | I2C_IEN_ARBLOST);
 
-  #if defined(I2C0)
-  if (this->i2c_peripheral == I2C0) {
-    NVIC_EnableIRQ(I2C0_IRQn);
+  this->irq_enable(true);
+}
+
+bool TwoWire::beginRegisterMap(uint8_t follower_mode_address, volatile uint8_t* registers, size_t size, uint8_t register_address_size)
+{
+  if (this->role != wire_role_t::NOT_INITIALIZED || registers == nullptr || size == 0u) {
+    return false;
   }
-  #endif
-  #if defined(I2C1)
-  if (this->i2c_peripheral == I2C1) {
-    NVIC_EnableIRQ(I2C1_IRQn);
+  if (register_address_size != 1u && register_address_size != 2u) {
+    return false;
   }
-  #endif
-  #if defined(I2C2)
-  if (this->i2c_peripheral == I2C2) {
-    NVIC_EnableIRQ(I2C2_IRQn);
+  this->register_map = registers;
+  this->register_map_size = size;
+  this->register_address_size = register_address_size;
+  this->register_writable_start = 0u;
+  this->register_writable_count = size;
+  this->register_pointer = 0u;
+  this->register_address_bytes_received = 0u;
+  this->register_write_count = 0u;
+  this->begin(follower_mode_address);
+  return true;
+}
+
+void TwoWire::setRegisterMapWritable(size_t start, size_t count)
+{
+  if (start >= this->register_map_size) {
+    count = 0u;
+  } else if (count > this->register_map_size - start) {
+    count = this->register_map_size - start;
   }
-  #endif
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  this->register_writable_start = start;
+  this->register_writable_count = count;
+  CORE_EXIT_CRITICAL();
+}
+
+void TwoWire::onRegisterWrite(void (*callback)(size_t start, size_t count))
+{
+  this->register_write_cb = callback;
 }
 
 void TwoWire::end()
 {
+  if (this->role == wire_role_t::LEADER) {
+    this->jobs_cancel();
+    this->abort_transfer();
+    this->dma_deinit();
+    this->set_fast_slewrate(false);
+  }
   this->role = wire_role_t::NOT_INITIALIZED;
   this->timeout_flag = false;
   this->follower_address = 0u;
@@ -151,11 +243,13 @@ void TwoWire::end()
   this->tx_buf_write_idx = 0u;
   this->rx_buf_read_idx = 0u;
   this->rx_buf_available = 0u;
-  memset(this->rx_buffer, 0x00, sizeof(this->rx_buffer));
-  memset(this->tx_buffer, 0x00, sizeof(this->tx_buffer));
+  memset(this->rx_buffer, 0x00, this->rx_buffer_size);
+  memset(this->tx_buffer, 0x00, this->tx_buffer_size);
 
   this->follower_transaction_in_progress = false;
   this->follower_mode_rx_buffer.clear();
+  this->register_map = nullptr;
+  this->register_map_size = 0u;
 
   I2C_Deinit(this->i2c_peripheral);
 }
@@ -175,14 +269,14 @@ size_t TwoWire::requestFrom(uint8_t follower_address, size_t number_of_bytes)
   }
 
   // Send out the Tx buffer and get the incoming bytes
-  uint32_t ret = this->i2c_leader_read(this->tx_buffer, this->tx_buf_write_idx, this->rx_buffer, number_of_bytes, follower_address);
+  int32_t ret = this->i2c_leader_read(this->tx_buffer, this->tx_buf_write_idx, this->rx_buffer, number_of_bytes, follower_address);
 
   this->tx_buf_write_idx = 0u;
   this->rx_buf_read_idx = 0u;
   this->rx_buf_available = 0u;
 
   // If the I2C operation was successful
-  if (ret == 0) {
+  if (ret == WireStatus::SUCCESS) {
     this->rx_buf_available = number_of_bytes;
     if (this->user_onreceive_cb) {
       this->user_onreceive_cb(this->rx_buf_available);
@@ -190,11 +284,6 @@ size_t TwoWire::requestFrom(uint8_t follower_address, size_t number_of_bytes)
     return this->rx_buf_available;
   }
 
-  // End the transmission if configured and it has run to a timeout
-  if (this->reset_on_timeout && this->timeout_flag && ret != 0) {
-    this->endTransmission(true);
-  }
-
   return 0;
 }
 
@@ -212,6 +301,81 @@ size_t TwoWire::requestFrom(uint8_t address, size_t number_of_bytes, bool stop)
   return result;
 }
 
+size_t TwoWire::requestFrom(uint8_t address, uint8_t* buffer, size_t size)
+{
+  return this->requestFrom(address, nullptr, 0u, buffer, size);
+}
+
+size_t TwoWire::requestFrom(uint8_t address, const uint8_t* command, size_t command_size, uint8_t* buffer, size_t size)
+{
+  if (this->role != wire_role_t::LEADER || buffer == nullptr || size == 0u || size > max_buffer_size) {
+    return 0;
+  }
+  if (command_size > max_buffer_size || (command_size > 0u && command == nullptr)) {
+    return 0;
+  }
+  if (this->i2c_leader_read((uint8_t*)command, command_size, buffer, size, address) != WireStatus::SUCCESS) {
+    return 0;
+  }
+  return size;
+}
+
+uint8_t TwoWire::writeTo(uint8_t address, const uint8_t* data, size_t size)
+{
+  return this->writeTo(address, data, size, nullptr, 0u);
+}
+
+uint8_t TwoWire::writeTo(uint8_t address, const uint8_t* header, size_t header_size, const uint8_t* data, size_t size)
+{
+  if (this->role != wire_role_t::LEADER) {
+    return WireStatus::OTHER_ERROR;
+  }
+  if (header_size > max_buffer_size || size > max_buffer_size) {
+    return WireStatus::DATA_TOO_LONG;
+  }
+  if ((header_size > 0u && header == nullptr) || (size > 0u && data == nullptr)) {
+    return WireStatus::OTHER_ERROR;
+  }
+  return (uint8_t)this->i2c_leader_write((uint8_t*)header, header_size, (uint8_t*)data, size, address);
+}
+
+bool TwoWire::setBufferSize(size_t size)
+{
+  if (this->role != wire_role_t::NOT_INITIALIZED || size == 0u || size > max_buffer_size) {
+    return false;
+  }
+
+  uint8_t* new_tx_buffer = this->tx_buffer_default;
+  uint8_t* new_rx_buffer = this->rx_buffer_default;
+  if (size > default_buffer_size) {
+    new_tx_buffer = (uint8_t*)malloc(size);
+    new_rx_buffer = (uint8_t*)malloc(size);
+    if (new_tx_buffer == nullptr || new_rx_buffer == nullptr) {
+      free(new_tx_buffer);
+      free(new_rx_buffer);
+      return false;
+    }
+    memset(new_tx_buffer, 0x00, size);
+    memset(new_rx_buffer, 0x00, size);
+  }
+
+  if (this->buffers_allocated) {
+    free(this->tx_buffer);
+    free(this->rx_buffer);
+  }
+  this->tx_buffer = new_tx_buffer;
+  this->rx_buffer = new_rx_buffer;
+  this->tx_buffer_size = size;
+  this->rx_buffer_size = size;
+  this->buffers_allocated = (new_tx_buffer != this->tx_buffer_default);
+  return true;
+}
+
+size_t TwoWire::getBufferSize()
+{
+  return this->rx_buffer_size;
+}
+
 void TwoWire::beginTransmission(uint8_t follower_address)
 {
   if (this->role == wire_role_t::NOT_INITIALIZED || this->role == wire_role_t::FOLLOWER) {
@@ -244,13 +408,7 @@ uint8_t TwoWire::endTransmission(bool stop)
 
   xSemaphoreGive(this->wire_mutex);
 
-  if (ret == 0) {
-    return WireStatus::SUCCESS;
-  } else if (ret == i2cTransferNack) {
-    return WireStatus::NACK_ADDRESS;
-  }
-
-  return WireStatus::OTHER_ERROR;
+  return (uint8_t)ret;
 }
 
 size_t TwoWire::write(uint8_t value)
@@ -293,13 +451,19 @@ size_t TwoWire::write(const uint8_t* data, size_t size)
   if (!data || size == 0) {
     return 0;
   }
-  size_t bytes_written = 0;
-  for (size_t i = 0; i < size; i++) {
-    size_t res = this->write(data[i]);
-    if (res == 0) {
-      return bytes_written;
-    }
-    bytes_written += res;
+  if (!this->transmission_in_progress) {
+    return -1;
+  }
+
+  // Copy as much as fits - on overflow the buffer is discarded like in 'write(uint8_t)'
+  size_t bytes_written = this->tx_buffer_size - this->tx_buf_write_idx;
+  if (bytes_written > size) {
+    bytes_written = size;
+  }
+  memcpy(this->tx_buffer + this->tx_buf_write_idx, data, bytes_written);
+  this->tx_buf_write_idx += bytes_written;
+  if (bytes_written < size) {
+    this->tx_buf_write_idx = 0u;
   }
   return bytes_written;
 }
@@ -341,12 +505,85 @@ int TwoWire::read()
   return data;
 }
 
+size_t TwoWire::read(uint8_t* buffer, size_t size)
+{
+  if (this->role == wire_role_t::NOT_INITIALIZED || buffer == nullptr) {
+    return 0u;
+  }
+
+  size_t count = 0u;
+  if (this->role == wire_role_t::FOLLOWER) {
+    while (count < size && this->follower_mode_rx_buffer.available()) {
+      buffer[count++] = (uint8_t)this->follower_mode_rx_buffer.read_char();
+    }
+    return count;
+  }
+
+  count = this->rx_buf_available - this->rx_buf_read_idx;
+  if (count > size) {
+    count = size;
+  }
+  memcpy(buffer, this->rx_buffer + this->rx_buf_read_idx, count);
+  this->rx_buf_read_idx += count;
+
+  return count;
+}
+
 void TwoWire::setClock(const uint32_t clock)
 {
   if (this->role == wire_role_t::NOT_INITIALIZED) {
     return;
   }
-  I2C_BusFreqSet(this->i2c_peripheral, 0, clock, i2cClockHLRStandard);
+  // Use the low/high ratio which meets the bus timing of the speed mode
+  I2C_ClockHLR_TypeDef clock_hlr = i2cClockHLRStandard;
+  if (clock > I2C_FREQ_FAST_MAX) {
+    clock_hlr = i2cClockHLRFast;
+  } else if (clock > I2C_FREQ_STANDARD_MAX) {
+    clock_hlr = i2cClockHLRAsymetric;
+  }
+  I2C_BusFreqSet(this->i2c_peripheral, 0, clock, clock_hlr);
+  this->bus_clock = I2C_BusFreqGet(this->i2c_peripheral);
+  // Keep the clock when the peripheral is initialized again by a bus recovery
+  this->i2c_config->i2cMaxFreq = clock;
+  this->i2c_config->i2cClhr = clock_hlr;
+
+  // Fast-mode Plus needs steeper falling edges
+  this->set_fast_slewrate(clock > I2C_FREQ_FAST_MAX);
+}
+
+// The slew rate is set for the whole port - the previous setting of the ports is restored afterwards
+void TwoWire::set_fast_slewrate(bool enable)
+{
+  if (enable == this->fast_slewrate_set) {
+    return;
+  }
+  const uint32_t slewrate_mask = _GPIO_P_CTRL_SLEWRATE_MASK | _GPIO_P_CTRL_SLEWRATEALT_MASK;
+  if (enable) {
+    // Both are saved first - SCL and SDA can be on the same port
+    this->scl_port_slewrate = GPIO->P[this->i2c_scl_port].CTRL & slewrate_mask;
+    this->sda_port_slewrate = GPIO->P[this->i2c_sda_port].CTRL & slewrate_mask;
+    uint32_t slewrate_max = _GPIO_P_CTRL_SLEWRATE_MASK >> _GPIO_P_CTRL_SLEWRATE_SHIFT;
+    GPIO_SlewrateSet(this->i2c_scl_port, slewrate_max, slewrate_max);
+    GPIO_SlewrateSet(this->i2c_sda_port, slewrate_max, slewrate_max);
+  } else {
+    GPIO_SlewrateSet(this->i2c_sda_port,
+                     (this->sda_port_slewrate & _GPIO_P_CTRL_SLEWRATE_MASK) >> _GPIO_P_CTRL_SLEWRATE_SHIFT,
+                     (this->sda_port_slewrate & _GPIO_P_CTRL_SLEWRATEALT_MASK) >> _GPIO_P_CTRL_SLEWRATEALT_SHIFT);
+    GPIO_SlewrateSet(this->i2c_scl_port,
+                     (this->scl_port_slewrate & _GPIO_P_CTRL_SLEWRATE_MASK) >> _GPIO_P_CTRL_SLEWRATE_SHIFT,
+                     (this->scl_port_slewrate & _GPIO_P_CTRL_SLEWRATEALT_MASK) >> _GPIO_P_CTRL_SLEWRATEALT_SHIFT);
+  }
+  this->fast_slewrate_set = enable;
+}
+
+void TwoWire::setDmaThreshold(size_t max_interrupt_size)
+{
+  this->dma_threshold = max_interrupt_size;
+}
+
+size_t TwoWire::getDmaThreshold()
+{
+  return this->dma_threshold;
 }
 
 void TwoWire::onReceive(void (*user_onreceive_cb)(int))
@@ -361,8 +598,7 @@ void TwoWire::onRequest(void (*user_onrequest_cb)(void))
 
 void TwoWire::setWireTimeout(int timeout, bool reset_on_timeout)
 {
-  // The I2CSPM driver doesn't allow us to configure the timeout value
-  (void)timeout;
+  this->timeout_us = (timeout > 0) ? (uint32_t)timeout : 0u;
   this->reset_on_timeout = reset_on_timeout;
 }
 
@@ -378,71 +614,1043 @@ bool TwoWire::getWireTimeoutFlag()
 
 int32_t TwoWire::i2c_leader_read(uint8_t *cmd, size_t cmdLen, uint8_t *result, size_t resultLen, uint16_t i2c_address)
 {
-  I2C_TransferSeq_TypeDef seq;
-  I2C_TransferReturn_TypeDef ret;
+  if (cmdLen > 0) {
+    return this->i2c_leader_transfer(i2c_address, I2C_FLAG_WRITE_READ, cmd, cmdLen, result, resultLen);
+  }
+  return this->i2c_leader_transfer(i2c_address, I2C_FLAG_READ, result, resultLen, nullptr, 0u);
+}
+
+int32_t TwoWire::i2c_leader_write(uint8_t *cmd, size_t cmdLen, uint8_t *data, size_t dataLen, uint16_t i2c_address)
+{
+  if (dataLen > 0) {
+    return this->i2c_leader_transfer(i2c_address, I2C_FLAG_WRITE_WRITE, cmd, cmdLen, data, dataLen);
+  }
+  return this->i2c_leader_transfer(i2c_address, I2C_FLAG_WRITE, cmd, cmdLen, nullptr, 0u);
+}
+
+// Runs a transfer from the I2C interrupt while the calling task is blocked
+uint8_t TwoWire::i2c_leader_transfer(uint16_t i2c_address, uint16_t flags, uint8_t* data0, size_t len0, uint8_t* data1, size_t len1)
+{
+  uint8_t attempt = 0u;
+  while (true) {
+    // Let a background transfer or transaction list finish first - its completion belongs
+    // to its owner, the transfer timer ends it if it stalls
+    while (!this->start_transfer(i2c_address, flags, data0, len0, data1, len1, nullptr)) {
+      yield();
+    }
+    uint8_t status = this->waitTransfer();
+    // Collisions and bus errors are worth another try, a NACK or a timeout isn't
+    I2C_TransferReturn_TypeDef result = this->transfer_result;
+    if (status == WireStatus::TIMEOUT || (result != i2cTransferBusErr && result != i2cTransferArbLost) || attempt >= this->retry_count) {
+      return status;
+    }
+    attempt++;
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    wire_device_stats_t* stats = this->stats_find((uint8_t)i2c_address);
+    if (stats != nullptr) {
+      stats->retries++;
+    }
+    CORE_EXIT_CRITICAL();
+  }
+}
+
+bool TwoWire::transferAsync(uint8_t address,
+                            const uint8_t* tx_data,
+                            size_t tx_size,
+                            uint8_t* rx_data,
+                            size_t rx_size,
+                            void (*callback)(uint8_t status))
+{
+  if ((tx_size > 0u && tx_data == nullptr) || (rx_size > 0u && rx_data == nullptr)) {
+    return false;
+  }
+  if (tx_size > 0u && rx_size > 0u) {
+    return this->start_transfer(address, I2C_FLAG_WRITE_READ, (uint8_t*)tx_data, tx_size, rx_data, rx_size, callback);
+  } else if (rx_size > 0u) {
+    return this->start_transfer(address, I2C_FLAG_READ, rx_data, rx_size, nullptr, 0u, callback);
+  }
+  // Without data only the address is sent - can be used to probe a follower
+  return this->start_transfer(address, I2C_FLAG_WRITE, (uint8_t*)tx_data, tx_size, nullptr, 0u, callback);
+}
+
+uint8_t TwoWire::waitTransfer()
+{
+  if (this->role != wire_role_t::LEADER) {
+    return WireStatus::OTHER_ERROR;
+  }
+  // The semaphore is given by the interrupt when the transfer finishes or the transfer timer aborts it
+  // Transfers of a transaction list are not waited for here
+  if (this->transfer_active && this->job_current == nullptr) {
+    xSemaphoreTake(this->transfer_done_sem, portMAX_DELAY);
+  }
 
-  seq.addr = i2c_address << 1;
+  I2C_TransferReturn_TypeDef result = this->transfer_result;
+  // A stalled transfer, a follower holding the bus or a collision - clock the bus free if configured
+  if ((result == i2cTransferSwFault || result == i2cTransferBusErr || result == i2cTransferArbLost) && this->reset_on_timeout) {
+    this->recover_bus();
+  }
+  return transfer_result_to_status(result);
+}
 
-  if (cmdLen > 0) {
-    seq.flags = I2C_FLAG_WRITE_READ;
+bool TwoWire::isTransferInProgress()
+{
+  return this->transfer_active;
+}
+
+bool TwoWire::start_transfer(uint16_t i2c_address, uint16_t flags, uint8_t* data0, size_t len0, uint8_t* data1, size_t len1, void (*callback)(uint8_t status))
+{
+  if (this->role != wire_role_t::LEADER) {
+    return false;
+  }
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (this->transfer_active || this->job_current != nullptr) {
+    CORE_EXIT_CRITICAL();
+    return false;
+  }
+  this->transfer_active = true;
+  CORE_EXIT_CRITICAL();
+
+  // Drop the completion of a previous transfer nobody waited for
+  xSemaphoreTake(this->transfer_done_sem, 0u);
+  this->transfer_callback = callback;
+  // The probes of a bus scan would fill the statistics with absent followers
+  this->transfer_untracked = this->scan_in_progress;
+
+  // The rest of the transfer continues from the interrupt
+  CORE_ENTER_CRITICAL();
+  // The timer aborts the transfer if the follower holds the bus
+  uint32_t timeout = this->transfer_timeout(len0 + len1);
+  if (timeout > 0u) {
+    this->transfer_timer_start(timeout);
+  }
+  I2C_TransferReturn_TypeDef result = this->begin_transfer(i2c_address, flags, data0, len0, data1, len1);
+  if (result != i2cTransferInProgress) {
+    this->finish_transfer(result);
+  }
+  CORE_EXIT_CRITICAL();
+  return true;
+}
+
+I2C_TransferReturn_TypeDef TwoWire::begin_transfer(uint16_t i2c_address, uint16_t flags, uint8_t* data0, size_t len0, uint8_t* data1, size_t len1)
+{
+  this->transfer_seq.addr = i2c_address << 1;
+  this->transfer_seq.flags = flags;
+  this->transfer_seq.buf[0].data = data0;
+  this->transfer_seq.buf[0].len = (uint16_t)len0;
+  this->transfer_seq.buf[1].data = data1;
+  this->transfer_seq.buf[1].len = (uint16_t)len1;
+  this->transfer_start_us = micros();
+  // Long transfers are moved by DMA, the short ones byte by byte from the interrupt
+  if (this->dma_transfer_init()) {
+    return i2cTransferInProgress;
+  }
+  return I2C_TransferInit(this->i2c_peripheral, &this->transfer_seq);
+}
+
+void TwoWire::leader_irq_handler()
+{
+  if (!this->transfer_active) {
+    I2C_IntDisable(this->i2c_peripheral, _I2C_IEN_MASK);
+    I2C_IntClear(this->i2c_peripheral, _I2C_IF_MASK);
+    return;
+  }
+  I2C_TransferReturn_TypeDef result;
+  if (this->dma_state != dma_state_t::DMA_IDLE) {
+    result = this->dma_irq_handler();
+  } else {
+    result = I2C_Transfer(this->i2c_peripheral);
+  }
+  if (result == i2cTransferInProgress) {
+    return;
+  }
+  if (this->job_current != nullptr) {
+    this->job_transfer_finished(result);
+  } else {
+    this->finish_transfer(result);
+  }
+}
+
+// Called from interrupt context or with interrupts disabled
+void TwoWire::finish_transfer(I2C_TransferReturn_TypeDef result)
+{
+  sl_sleeptimer_stop_timer(&this->transfer_timer);
+  I2C_IntDisable(this->i2c_peripheral, _I2C_IEN_MASK);
+  this->transfer_result = result;
+  if (result != i2cTransferDone && result != i2cTransferNack) {
+    this->timeout_flag = true;
+  }
+  this->transfer_active = false;
+  if (!this->transfer_untracked) {
+    this->stats_record(result);
+  }
+  if (this->transfer_callback != nullptr) {
+    this->transfer_callback(transfer_result_to_status(result));
+  }
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  xSemaphoreGiveFromISR(this->transfer_done_sem, &xHigherPriorityTaskWoken);
+  // Start the transaction lists which were queued during the transfer
+  this->job_start_next();
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void TwoWire::abort_transfer()
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (!this->transfer_active || this->job_current != nullptr) {
+    CORE_EXIT_CRITICAL();
+    return;
+  }
+  this->transfer_stop_hw();
+  this->finish_transfer(i2cTransferSwFault);
+  CORE_EXIT_CRITICAL();
+}
 
-    seq.buf[0].data = cmd;
-    seq.buf[0].len  = cmdLen;
-    seq.buf[1].data = result;
-    seq.buf[1].len  = resultLen;
+bool TwoWire::queueTransaction(wire_transaction_t* transaction)
+{
+  if (this->role != wire_role_t::LEADER || transaction == nullptr || transaction->steps == nullptr || transaction->step_count == 0u) {
+    return false;
+  }
+  if (transaction->state == WIRE_TRANSACTION_QUEUED || transaction->state == WIRE_TRANSACTION_ACTIVE) {
+    return false;
+  }
+  for (size_t i = 0u; i < transaction->step_count; i++) {
+    wire_step_t* step = &transaction->steps[i];
+    if (step->type == WIRE_STEP_DELAY) {
+      continue;
+    }
+    if ((step->tx_size > 0u && step->tx_data == nullptr) || (step->rx_size > 0u && step->rx_data == nullptr)) {
+      return false;
+    }
+    if (step->tx_size > UINT16_MAX || step->rx_size > UINT16_MAX) {
+      return false;
+    }
+    if ((step->type == WIRE_STEP_READ || step->type == WIRE_STEP_WRITE_READ) && step->rx_size == 0u) {
+      return false;
+    }
+    if (step->type == WIRE_STEP_WRITE_READ && step->tx_size == 0u) {
+      return false;
+    }
+  }
+  for (size_t i = 0u; i < transaction->step_count; i++) {
+    transaction->steps[i].status = WireStatus::OTHER_ERROR;
+  }
+  transaction->current_step = 0u;
+  transaction->next = nullptr;
+  transaction->state = WIRE_TRANSACTION_QUEUED;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (this->job_queue_head == nullptr) {
+    this->job_queue_head = transaction;
   } else {
-    seq.flags = I2C_FLAG_READ;
+    this->job_queue_tail->next = transaction;
+  }
+  this->job_queue_tail = transaction;
+  // Otherwise it's started from the interrupt when the bus becomes free
+  this->job_start_next();
+  CORE_EXIT_CRITICAL();
+  return true;
+}
 
-    seq.buf[0].data = result;
-    seq.buf[0].len  = resultLen;
+bool TwoWire::waitTransaction(wire_transaction_t* transaction, uint32_t timeout_ms)
+{
+  if (transaction == nullptr) {
+    return false;
   }
+  uint32_t start_millis = millis();
+  while (transaction->state == WIRE_TRANSACTION_QUEUED || transaction->state == WIRE_TRANSACTION_ACTIVE) {
+    if (millis() - start_millis >= timeout_ms) {
+      return false;
+    }
+    yield();
+  }
+  return transaction->state == WIRE_TRANSACTION_DONE;
+}
 
-  ret = I2CSPM_Transfer(this->i2c_peripheral, &seq);
+// Called with interrupts disabled or from interrupt context
+void TwoWire::job_start_next()
+{
+  while (!this->transfer_active && this->job_current == nullptr && this->job_queue_head != nullptr) {
+    wire_transaction_t* transaction = this->job_queue_head;
+    this->job_queue_head = transaction->next;
+    if (this->job_queue_head == nullptr) {
+      this->job_queue_tail = nullptr;
+    }
+    this->job_current = transaction;
+    transaction->state = WIRE_TRANSACTION_ACTIVE;
+    if (this->job_run_steps()) {
+      return;
+    }
+    this->job_complete();
+  }
+}
 
-  if (ret == i2cTransferNack) {
-    return ret;
-  } else if (ret != i2cTransferDone) {
+// Starts the steps of the current transaction list until one has to be waited for
+// Returns false when all the steps are finished
+bool TwoWire::job_run_steps()
+{
+  wire_transaction_t* transaction = this->job_current;
+  while (transaction->current_step < transaction->step_count) {
+    wire_step_t* step = &transaction->steps[transaction->current_step];
+    if (step->type == WIRE_STEP_DELAY) {
+      if (step->delay_us > 0u && this->transfer_timer_start(step->delay_us)) {
+        return true;
+      }
+      step->status = WireStatus::SUCCESS;
+      transaction->current_step++;
+      continue;
+    }
+
+    uint16_t flags = I2C_FLAG_WRITE;
+    uint8_t* data0 = (uint8_t*)step->tx_data;
+    size_t len0 = step->tx_size;
+    uint8_t* data1 = nullptr;
+    size_t len1 = 0u;
+    if (step->type == WIRE_STEP_READ) {
+      flags = I2C_FLAG_READ;
+      data0 = step->rx_data;
+      len0 = step->rx_size;
+    } else if (step->type == WIRE_STEP_WRITE_READ) {
+      flags = I2C_FLAG_WRITE_READ;
+      data1 = step->rx_data;
+      len1 = step->rx_size;
+    }
+    this->transfer_active = true;
+    this->transfer_untracked = false;
+    // The timer aborts the step if the follower holds the bus
+    uint32_t timeout = this->transfer_timeout(len0 + len1);
+    if (timeout > 0u) {
+      this->transfer_timer_start(timeout);
+    }
+    I2C_TransferReturn_TypeDef result = this->begin_transfer(step->address, flags, data0, len0, data1, len1);
+    if (result == i2cTransferInProgress) {
+      return true;
+    }
+    sl_sleeptimer_stop_timer(&this->transfer_timer);
+    I2C_IntDisable(this->i2c_peripheral, _I2C_IEN_MASK);
+    this->transfer_active = false;
+    this->stats_record(result);
+    step->status = transfer_result_to_status(result);
+    transaction->current_step++;
+  }
+  return false;
+}
+
+void TwoWire::job_complete()
+{
+  wire_transaction_t* transaction = this->job_current;
+  transaction->state = WIRE_TRANSACTION_DONE;
+  for (size_t i = 0u; i < transaction->step_count; i++) {
+    if (transaction->steps[i].status != WireStatus::SUCCESS) {
+      transaction->state = WIRE_TRANSACTION_FAILED;
+      break;
+    }
+  }
+  this->job_current = nullptr;
+  // The callback may queue new transactions - they are started right after
+  if (transaction->callback != nullptr) {
+    transaction->callback(transaction);
+  }
+}
+
+void TwoWire::job_step_finished(uint8_t status)
+{
+  wire_transaction_t* transaction = this->job_current;
+  transaction->steps[transaction->current_step].status = status;
+  transaction->current_step++;
+  if (this->job_run_steps()) {
+    return;
+  }
+  this->job_complete();
+  this->job_start_next();
+}
+
+// Called from the I2C interrupt
+void TwoWire::job_transfer_finished(I2C_TransferReturn_TypeDef result)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  sl_sleeptimer_stop_timer(&this->transfer_timer);
+  I2C_IntDisable(this->i2c_peripheral, _I2C_IEN_MASK);
+  this->transfer_active = false;
+  if (result != i2cTransferDone && result != i2cTransferNack) {
     this->timeout_flag = true;
-    return ret;
   }
+  this->stats_record(result);
+  this->job_step_finished(transfer_result_to_status(result));
+  CORE_EXIT_CRITICAL();
+}
+
+// The wire timeout is how long a transfer may stall - the time its bytes take on the bus is added to it
+uint32_t TwoWire::transfer_timeout(size_t size)
+{
+  if (this->timeout_us == 0u) {
+    return 0u;
+  }
+  uint32_t clock = (this->bus_clock > 0u) ? this->bus_clock : I2C_FREQ_STANDARD_MAX;
+  // Nine clocks per byte, including the address of the write and the read part
+  uint64_t timeout = this->timeout_us + ((uint64_t)(size + 2u) * 9u * 1000000u + clock - 1u) / clock;
+  if (timeout > UINT32_MAX) {
+    timeout = UINT32_MAX;
+  }
+  return (uint32_t)timeout;
+}
 
-  return ret;
+bool TwoWire::transfer_timer_start(uint32_t timeout_us)
+{
+  uint64_t ticks = ((uint64_t)timeout_us * sl_sleeptimer_get_timer_frequency() + 999999u) / 1000000u;
+  if (ticks == 0u) {
+    ticks = 1u;
+  }
+  if (ticks > UINT32_MAX) {
+    ticks = UINT32_MAX;
+  }
+  return sl_sleeptimer_restart_timer(&this->transfer_timer, (uint32_t)ticks, TwoWire::transfer_timer_callback, this, 0u, 0u) == SL_STATUS_OK;
 }
 
-int32_t TwoWire::i2c_leader_write(uint8_t *cmd, size_t cmdLen, uint8_t *data, size_t dataLen, uint16_t i2c_address)
+// Called from the sleeptimer interrupt when a transfer times out or at the end of a delay step
+void TwoWire::transfer_timer_callback(sl_sleeptimer_timer_handle_t* handle, void* data)
 {
-  I2C_TransferSeq_TypeDef seq;
-  I2C_TransferReturn_TypeDef ret;
+  (void)handle;
+  TwoWire* wire = (TwoWire*)data;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (wire->job_current == nullptr) {
+    if (wire->transfer_active) {
+      wire->transfer_stop_hw();
+      wire->finish_transfer(i2cTransferSwFault);
+    }
+    CORE_EXIT_CRITICAL();
+    return;
+  }
+  uint8_t status = WireStatus::SUCCESS;
+  if (wire->transfer_active) {
+    wire->transfer_stop_hw();
+    wire->transfer_active = false;
+    wire->stats_record(i2cTransferSwFault);
+    wire->timeout_flag = true;
+    status = WireStatus::TIMEOUT;
+  }
+  wire->job_step_finished(status);
+  CORE_EXIT_CRITICAL();
+}
 
-  seq.addr = i2c_address << 1;
-  seq.buf[0].data = cmd;
-  seq.buf[0].len = cmdLen;
+void TwoWire::jobs_cancel()
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  sl_sleeptimer_stop_timer(&this->transfer_timer);
+  wire_transaction_t* cancelled = this->job_queue_head;
+  if (this->job_current != nullptr) {
+    if (this->transfer_active) {
+      this->transfer_stop_hw();
+      this->transfer_active = false;
+    }
+    this->job_current->next = cancelled;
+    cancelled = this->job_current;
+  }
+  this->job_current = nullptr;
+  this->job_queue_head = nullptr;
+  this->job_queue_tail = nullptr;
+  CORE_EXIT_CRITICAL();
+
+  // Steps which did not run keep their OTHER_ERROR status
+  while (cancelled != nullptr) {
+    wire_transaction_t* transaction = cancelled;
+    cancelled = transaction->next;
+    transaction->state = WIRE_TRANSACTION_FAILED;
+    if (transaction->callback != nullptr) {
+      transaction->callback(transaction);
+    }
+  }
+}
 
-  if (dataLen > 0) {
-    seq.flags = I2C_FLAG_WRITE_WRITE;
-    seq.buf[1].data = data;
-    seq.buf[1].len = dataLen;
+void TwoWire::dma_init()
+{
+  DMADRV_PeripheralSignal_t tx_signal;
+  DMADRV_PeripheralSignal_t rx_signal;
+  #if defined(I2C0)
+  if (this->i2c_peripheral == I2C0) {
+    tx_signal = dmadrvPeripheralSignal_I2C0_TXBL;
+    rx_signal = dmadrvPeripheralSignal_I2C0_RXDATAV;
+  }
+  #endif
+  #if defined(I2C1)
+  if (this->i2c_peripheral == I2C1) {
+    tx_signal = dmadrvPeripheralSignal_I2C1_TXBL;
+    rx_signal = dmadrvPeripheralSignal_I2C1_RXDATAV;
+  }
+  #endif
+  #if defined(I2C2)
+  if (this->i2c_peripheral == I2C2) {
+    return;
+  }
+  #endif
+
+  // Without a DMA channel all the transfers are done from the interrupt
+  DMADRV_Init();
+  if (DMADRV_AllocateChannel(&this->dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK) {
+    return;
+  }
+  this->dma_tx_config = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL((LDMA_PeripheralSignal_t)tx_signal);
+  this->dma_rx_config = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL((LDMA_PeripheralSignal_t)rx_signal);
+  this->dma_available = true;
+}
+
+void TwoWire::dma_deinit()
+{
+  if (!this->dma_available) {
+    return;
+  }
+  DMADRV_StopTransfer(this->dma_channel);
+  DMADRV_FreeChannel(this->dma_channel);
+  this->dma_available = false;
+}
+
+static uint8_t dma_chunk_count(size_t size)
+{
+  return (uint8_t)((size + DMADRV_MAX_XFER_COUNT - 1u) / DMADRV_MAX_XFER_COUNT);
+}
+
+// Starts the transfer in 'transfer_seq' if it's long enough for DMA
+// The address and the repeated start are handled from the interrupt, the data bytes by DMA
+bool TwoWire::dma_transfer_init()
+{
+  if (!this->dma_available) {
+    return false;
+  }
+  uint16_t flags = this->transfer_seq.flags;
+  size_t tx_size = 0u;
+  size_t rx_size = 0u;
+  if (flags & I2C_FLAG_WRITE) {
+    tx_size = this->transfer_seq.buf[0].len;
+  } else if (flags & I2C_FLAG_WRITE_WRITE) {
+    tx_size = this->transfer_seq.buf[0].len + this->transfer_seq.buf[1].len;
+  } else if (flags & I2C_FLAG_READ) {
+    rx_size = this->transfer_seq.buf[0].len;
+  } else if (flags & I2C_FLAG_WRITE_READ) {
+    tx_size = this->transfer_seq.buf[0].len;
+    rx_size = this->transfer_seq.buf[1].len;
+    // The repeated start needs the write part to finish first
+    if (tx_size == 0u || rx_size == 0u) {
+      return false;
+    }
   } else {
-    seq.flags = I2C_FLAG_WRITE;
+    return false;
+  }
+  if (tx_size + rx_size <= this->dma_threshold) {
+    return false;
+  }
+  // Each buffer is split to the maximal DMA transfer size, plus the descriptors controlling the peripheral
+  uint8_t tx_descriptors = dma_chunk_count(this->transfer_seq.buf[0].len) + 2u;
+  if (flags & I2C_FLAG_WRITE_WRITE) {
+    tx_descriptors += dma_chunk_count(this->transfer_seq.buf[1].len);
+  }
+  uint8_t rx_descriptors = (rx_size > 0u) ? dma_chunk_count(rx_size - 1u) + 3u : 0u;
+  if ((tx_size > 0u && tx_descriptors > dma_descriptor_count) || rx_descriptors > dma_descriptor_count) {
+    return false;
   }
 
-  ret = I2CSPM_Transfer(this->i2c_peripheral, &seq);
+  // Prepare the peripheral the same way as 'I2C_TransferInit()'
+  I2C_TypeDef* i2c = this->i2c_peripheral;
+  if (i2c->STATE & I2C_STATE_BUSY) {
+    i2c->CMD = I2C_CMD_ABORT;
+  }
+  i2c->CMD = I2C_CMD_CLEARPC | I2C_CMD_CLEARTX;
+  while (i2c->STATUS & I2C_STATUS_RXDATAV) {
+    (void)i2c->RXDATA;
+  }
+  I2C_IntClear(i2c, _I2C_IF_MASK);
+  I2C_IntEnable(i2c, I2C_IEN_ACK | I2C_IEN_NACK | I2C_IEN_MSTOP | I2C_IEN_BUSERR | I2C_IEN_ARBLOST);
+  this->dma_result = i2cTransferDone;
+  this->dma_start_address((flags & I2C_FLAG_READ) != 0u);
+  return true;
+}
 
-  if (ret == i2cTransferNack) {
-    return ret;
-  } else if (ret != i2cTransferDone) {
-    this->timeout_flag = true;
-    return ret;
+void TwoWire::dma_start_address(bool read)
+{
+  I2C_TypeDef* i2c = this->i2c_peripheral;
+  if (read) {
+    // The data bytes are acknowledged by the hardware until the last one
+    size_t rx_size = (this->transfer_seq.flags & I2C_FLAG_READ) ? this->transfer_seq.buf[0].len : this->transfer_seq.buf[1].len;
+    if (rx_size > 1u) {
+      i2c->CTRL_SET = I2C_CTRL_AUTOACK;
+    }
+    this->dma_state = dma_state_t::DMA_ADDRESS_RX;
+  } else {
+    this->dma_state = dma_state_t::DMA_ADDRESS_TX;
+  }
+  I2C_IntEnable(i2c, I2C_IEN_ACK | I2C_IEN_NACK);
+  i2c->CMD = I2C_CMD_START;
+  i2c->TXDATA = (this->transfer_seq.addr & 0xFEu) | (read ? 1u : 0u);
+}
+
+uint8_t TwoWire::dma_add_data_descriptors(uint8_t index, uint8_t* data, size_t size, bool tx)
+{
+  for (size_t offset = 0u; offset < size; offset += DMADRV_MAX_XFER_COUNT) {
+    size_t chunk_size = size - offset;
+    if (chunk_size > DMADRV_MAX_XFER_COUNT) {
+      chunk_size = DMADRV_MAX_XFER_COUNT;
+    }
+    if (tx) {
+      this->dma_descriptors[index] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(data + offset, &this->i2c_peripheral->TXDATA, chunk_size, 1);
+    } else {
+      this->dma_descriptors[index] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(&this->i2c_peripheral->RXDATA, data + offset, chunk_size, 1);
+    }
+    this->dma_descriptors[index].xfer.doneIfs = 0;
+    index++;
+  }
+  return index;
+}
+
+void TwoWire::dma_start_data_tx()
+{
+  uint8_t index = this->dma_add_data_descriptors(0u, this->transfer_seq.buf[0].data, this->transfer_seq.buf[0].len, true);
+  if (this->transfer_seq.flags & I2C_FLAG_WRITE_WRITE) {
+    index = this->dma_add_data_descriptors(index, this->transfer_seq.buf[1].data, this->transfer_seq.buf[1].len, true);
+  }
+  // When the last byte is in the buffer the interrupt is armed for the end of its transmission
+  this->dma_descriptors[index++] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_WRITE(I2C_IF_TXC, &this->i2c_peripheral->IF_CLR, 1);
+  this->dma_descriptors[index] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_WRITE(I2C_IEN_TXC, &this->i2c_peripheral->IEN_SET);
+  this->dma_descriptors[index].wri.doneIfs = 0;
+  this->dma_state = dma_state_t::DMA_DATA_TX;
+  if (DMADRV_LdmaStartTransfer((int)this->dma_channel, &this->dma_tx_config, this->dma_descriptors, nullptr, nullptr) != ECODE_EMDRV_DMADRV_OK) {
+    this->dma_result = i2cTransferUsageFault;
+    this->dma_send_stop();
+  }
+}
+
+void TwoWire::dma_start_data_rx()
+{
+  uint8_t* rx_data = this->transfer_seq.buf[0].data;
+  size_t rx_size = this->transfer_seq.buf[0].len;
+  if (this->transfer_seq.flags & I2C_FLAG_WRITE_READ) {
+    rx_data = this->transfer_seq.buf[1].data;
+    rx_size = this->transfer_seq.buf[1].len;
+  }
+  // The automatic acknowledge is turned off before the last byte arrives - the peripheral
+  // holds the clock until the last byte is read and the NACK and STOP are written
+  uint8_t index = this->dma_add_data_descriptors(0u, rx_data, rx_size - 1u, false);
+  this->dma_descriptors[index++] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_WRITE(I2C_CTRL_AUTOACK, &this->i2c_peripheral->CTRL_CLR, 1);
+  index = this->dma_add_data_descriptors(index, rx_data + rx_size - 1u, 1u, false);
+  this->dma_descriptors[index] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_WRITE(I2C_CMD_NACK | I2C_CMD_STOP, &this->i2c_peripheral->CMD);
+  this->dma_descriptors[index].wri.doneIfs = 0;
+  this->dma_state = dma_state_t::DMA_DATA_RX;
+  // A NACK can only come from the follower during the address
+  I2C_IntDisable(this->i2c_peripheral, I2C_IEN_NACK);
+  if (DMADRV_LdmaStartTransfer((int)this->dma_channel, &this->dma_rx_config, this->dma_descriptors, nullptr, nullptr) != ECODE_EMDRV_DMADRV_OK) {
+    this->i2c_peripheral->CTRL_CLR = I2C_CTRL_AUTOACK;
+    this->dma_result = i2cTransferUsageFault;
+    this->dma_send_stop();
+  }
+}
+
+void TwoWire::dma_send_stop()
+{
+  I2C_IntDisable(this->i2c_peripheral, I2C_IEN_ACK | I2C_IEN_NACK | I2C_IEN_TXC);
+  this->i2c_peripheral->CMD = I2C_CMD_STOP;
+  this->dma_state = dma_state_t::DMA_STOP;
+}
+
+// Called from the I2C interrupt while a DMA transfer is running
+I2C_TransferReturn_TypeDef TwoWire::dma_irq_handler()
+{
+  I2C_TypeDef* i2c = this->i2c_peripheral;
+  uint32_t pending = I2C_IntGetEnabled(i2c);
+  I2C_IntClear(i2c, pending);
+
+  if (pending & (I2C_IF_BUSERR | I2C_IF_ARBLOST)) {
+    this->transfer_stop_hw();
+    return (pending & I2C_IF_BUSERR) ? i2cTransferBusErr : i2cTransferArbLost;
+  }
+  if (pending & I2C_IF_MSTOP) {
+    I2C_IntDisable(i2c, _I2C_IEN_MASK);
+    i2c->CTRL_CLR = I2C_CTRL_AUTOACK;
+    this->dma_state = dma_state_t::DMA_IDLE;
+    return this->dma_result;
+  }
+  if ((pending & I2C_IF_NACK) && this->dma_state != dma_state_t::DMA_STOP) {
+    // The follower refused the address or a data byte
+    DMADRV_StopTransfer(this->dma_channel);
+    i2c->CTRL_CLR = I2C_CTRL_AUTOACK;
+    i2c->CMD = I2C_CMD_CLEARTX;
+    this->dma_result = i2cTransferNack;
+    this->dma_send_stop();
+    return i2cTransferInProgress;
+  }
+
+  switch (this->dma_state) {
+    case dma_state_t::DMA_ADDRESS_TX:
+      if (pending & I2C_IF_ACK) {
+        // The ACKs of the data bytes are not needed - a NACK stops the transfer
+        I2C_IntDisable(i2c, I2C_IEN_ACK);
+        this->dma_start_data_tx();
+      }
+      break;
+    case dma_state_t::DMA_DATA_TX:
+      if (pending & I2C_IF_TXC) {
+        I2C_IntDisable(i2c, I2C_IEN_TXC);
+        if (this->transfer_seq.flags & I2C_FLAG_WRITE_READ) {
+          this->dma_start_address(true);
+        } else {
+          this->dma_send_stop();
+        }
+      }
+      break;
+    case dma_state_t::DMA_ADDRESS_RX:
+      if (pending & I2C_IF_ACK) {
+        I2C_IntDisable(i2c, I2C_IEN_ACK);
+        this->dma_start_data_rx();
+      }
+      break;
+    default:
+      break;
+  }
+  return i2cTransferInProgress;
+}
+
+// Stops the transfer on the bus - called with interrupts disabled or from interrupt context
+void TwoWire::transfer_stop_hw()
+{
+  I2C_IntDisable(this->i2c_peripheral, _I2C_IEN_MASK);
+  if (this->dma_state != dma_state_t::DMA_IDLE) {
+    DMADRV_StopTransfer(this->dma_channel);
+    this->i2c_peripheral->CTRL_CLR = I2C_CTRL_AUTOACK;
+    this->dma_state = dma_state_t::DMA_IDLE;
+  }
+  this->i2c_peripheral->CMD = I2C_CMD_ABORT;
+}
+
+// Serves the register map - called from the I2C interrupt in follower mode
+void TwoWire::register_map_irq_handler()
+{
+  I2C_TypeDef* i2c = this->i2c_peripheral;
+  uint32_t pending = I2C_IntGetEnabled(i2c);
+  I2C_IntClear(i2c, pending);
+
+  if (pending & (I2C_IF_BUSERR | I2C_IF_ARBLOST)) {
+    this->register_map_write_finished();
+    this->register_address_bytes_received = 0u;
+    return;
+  }
+
+  if (pending & I2C_IF_ADDR) {
+    // A repeated start ends the write of the register address or the registers
+    this->register_map_write_finished();
+    uint32_t address_byte = i2c->RXDATA;
+    if (address_byte & 0x1u) {
+      // Leader read - the first byte has to be in the buffer before the address is acknowledged
+      i2c->CMD = I2C_CMD_CLEARTX;
+      i2c->TXDATA = this->register_map[this->register_pointer];
+      this->register_pointer = (this->register_pointer + 1u) % this->register_map_size;
+    } else {
+      this->register_address_bytes_received = 0u;
+    }
+    i2c->CMD = I2C_CMD_ACK;
+  } else if (pending & I2C_IF_RXDATAV) {
+    uint32_t rx_data = i2c->RXDATA;
+    if (this->register_address_bytes_received < this->register_address_size) {
+      // The register address is sent first - most significant byte first
+      if (this->register_address_bytes_received == 0u) {
+        this->register_pointer = 0u;
+      }
+      this->register_pointer = (this->register_pointer << 8) | rx_data;
+      this->register_address_bytes_received++;
+      if (this->register_address_bytes_received == this->register_address_size) {
+        this->register_pointer %= this->register_map_size;
+      }
+    } else {
+      size_t offset = this->register_pointer - this->register_writable_start;
+      if (this->register_pointer >= this->register_writable_start && offset < this->register_writable_count) {
+        this->register_map[this->register_pointer] = (uint8_t)rx_data;
+        if (this->register_write_count == 0u) {
+          this->register_write_start = this->register_pointer;
+        }
+        if (this->register_write_count < this->register_map_size) {
+          this->register_write_count++;
+        }
+      }
+      this->register_pointer = (this->register_pointer + 1u) % this->register_map_size;
+    }
+    i2c->CMD = I2C_CMD_ACK;
+  }
+
+  // The leader acknowledged the previous byte and wants the next one
+  if ((pending & I2C_IF_ACK) && (i2c->STATE & I2C_STATE_TRANSMITTER)) {
+    i2c->TXDATA = this->register_map[this->register_pointer];
+    this->register_pointer = (this->register_pointer + 1u) % this->register_map_size;
+  }
+
+  if (pending & I2C_IF_SSTOP) {
+    this->register_map_write_finished();
+  }
+}
+
+void TwoWire::register_map_write_finished()
+{
+  if (this->register_write_count == 0u) {
+    return;
+  }
+  size_t start = this->register_write_start;
+  size_t count = this->register_write_count;
+  this->register_write_count = 0u;
+  if (this->register_write_cb != nullptr) {
+    this->register_write_cb(start, count);
+  }
+}
+
+void TwoWire::recover_bus()
+{
+  (void)this->recoverBus();
+}
+
+bool TwoWire::recoverBus()
+{
+  if (this->role != wire_role_t::LEADER || xPortIsInsideInterrupt()) {
+    return false;
+  }
+  // Refuse while a transfer or transaction list uses the bus - it would wait for an interrupt forever
+  // Otherwise the bus is claimed like for a transfer so none can start during the recovery
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (this->transfer_active || this->job_current != nullptr) {
+    CORE_EXIT_CRITICAL();
+    return false;
+  }
+  this->transfer_active = true;
+  CORE_EXIT_CRITICAL();
+
+  this->irq_enable(false);
+  // Take the pins from the peripheral and drive them as open drain outputs
+  GPIO->I2CROUTE[this->i2c_peripheral_num].ROUTEEN = 0u;
+  GPIO_PinModeSet(this->i2c_scl_port, this->i2c_scl_pin, gpioModeWiredAndPullUp, 1);
+  GPIO_PinModeSet(this->i2c_sda_port, this->i2c_sda_pin, gpioModeWiredAndPullUp, 1);
+
+  // Nothing can be done if a follower holds the clock low
+  bool scl_released = this->wait_scl_released();
+  if (scl_released) {
+    // Clock out the byte a follower is stuck in until it releases SDA
+    for (uint8_t i = 0u; i < 9u && GPIO_PinInGet(this->i2c_sda_port, this->i2c_sda_pin) == 0u; i++) {
+      GPIO_PinOutClear(this->i2c_scl_port, this->i2c_scl_pin);
+      delayMicroseconds(recovery_half_period_us);
+      GPIO_PinOutSet(this->i2c_scl_port, this->i2c_scl_pin);
+      scl_released = this->wait_scl_released();
+      delayMicroseconds(recovery_half_period_us);
+    }
+    // Finish with a STOP condition - SDA rising while SCL is high
+    GPIO_PinOutClear(this->i2c_scl_port, this->i2c_scl_pin);
+    delayMicroseconds(recovery_half_period_us);
+    GPIO_PinOutClear(this->i2c_sda_port, this->i2c_sda_pin);
+    delayMicroseconds(recovery_half_period_us);
+    GPIO_PinOutSet(this->i2c_scl_port, this->i2c_scl_pin);
+    scl_released = this->wait_scl_released();
+    delayMicroseconds(recovery_half_period_us);
+    GPIO_PinOutSet(this->i2c_sda_port, this->i2c_sda_pin);
+    delayMicroseconds(recovery_half_period_us);
+  }
+  bool bus_free = scl_released && GPIO_PinInGet(this->i2c_sda_port, this->i2c_sda_pin) != 0u;
+
+  // Initialize the peripheral and its pins again
+  I2CSPM_Init(this->i2c_config);
+  this->irq_enable(true);
+  this->bus_recovery_count++;
+
+  // Start the transaction lists which were queued during the recovery
+  CORE_ENTER_CRITICAL();
+  this->transfer_active = false;
+  this->job_start_next();
+  CORE_EXIT_CRITICAL();
+  return bus_free;
+}
+
+bool TwoWire::wait_scl_released()
+{
+  uint32_t start_us = micros();
+  while (GPIO_PinInGet(this->i2c_scl_port, this->i2c_scl_pin) == 0u) {
+    if (micros() - start_us >= recovery_scl_timeout_us) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t TwoWire::scan(uint8_t* addresses, size_t max_count, uint8_t first_address, uint8_t last_address)
+{
+  if (this->role != wire_role_t::LEADER || (addresses == nullptr && max_count > 0u)) {
+    return 0u;
+  }
+  size_t found = 0u;
+  this->scan_in_progress = true;
+  for (uint16_t address = first_address; address <= last_address && address <= 0x7Fu; address++) {
+    // Only the address is sent - a follower is present if it acknowledges it
+    if (this->i2c_leader_transfer(address, I2C_FLAG_WRITE, nullptr, 0u, nullptr, 0u) == WireStatus::SUCCESS) {
+      if (found < max_count) {
+        addresses[found] = (uint8_t)address;
+      }
+      found++;
+    }
+  }
+  this->scan_in_progress = false;
+  return found;
+}
+
+void TwoWire::setRetryCount(uint8_t retries)
+{
+  this->retry_count = retries;
+}
+
+bool TwoWire::getDeviceStats(uint8_t address, wire_device_stats_t* stats)
+{
+  if (stats == nullptr) {
+    return false;
   }
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  for (uint8_t i = 0u; i < this->device_stats_count; i++) {
+    if (this->device_stats[i].address == address) {
+      *stats = this->device_stats[i];
+      CORE_EXIT_CRITICAL();
+      return true;
+    }
+  }
+  CORE_EXIT_CRITICAL();
+  return false;
+}
+
+bool TwoWire::getDeviceStatsByIndex(size_t index, wire_device_stats_t* stats)
+{
+  if (stats == nullptr) {
+    return false;
+  }
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  if (index >= this->device_stats_count) {
+    CORE_EXIT_CRITICAL();
+    return false;
+  }
+  *stats = this->device_stats[index];
+  CORE_EXIT_CRITICAL();
+  return true;
+}
+
+size_t TwoWire::getDeviceStatsCount()
+{
+  return this->device_stats_count;
+}
+
+void TwoWire::resetStats()
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  memset(this->device_stats, 0x00, sizeof(this->device_stats));
+  this->device_stats_count = 0u;
+  this->bus_recovery_count = 0u;
+  CORE_EXIT_CRITICAL();
+}
 
-  return ret;
+uint32_t TwoWire::getBusRecoveryCount()
+{
+  return this->bus_recovery_count;
+}
+
+// Returns the statistics entry of a follower - a new one is taken if there's room
+// Called with interrupts disabled or from interrupt context
+wire_device_stats_t* TwoWire::stats_find(uint8_t address)
+{
+  for (uint8_t i = 0u; i < this->device_stats_count; i++) {
+    if (this->device_stats[i].address == address) {
+      return &this->device_stats[i];
+    }
+  }
+  if (this->device_stats_count >= WIRE_STATS_DEVICE_COUNT) {
+    return nullptr;
+  }
+  wire_device_stats_t* stats = &this->device_stats[this->device_stats_count++];
+  memset(stats, 0x00, sizeof(wire_device_stats_t));
+  stats->address = address;
+  return stats;
+}
+
+// Records the result of the transfer in 'transfer_seq'
+// Called with interrupts disabled or from interrupt context
+void TwoWire::stats_record(I2C_TransferReturn_TypeDef result)
+{
+  wire_device_stats_t* stats = this->stats_find((uint8_t)(this->transfer_seq.addr >> 1));
+  if (stats == nullptr) {
+    return;
+  }
+  stats->transactions++;
+  switch (result) {
+    case i2cTransferDone:
+      stats->bytes += this->transfer_seq.buf[0].len;
+      if (this->transfer_seq.flags & (I2C_FLAG_WRITE_READ | I2C_FLAG_WRITE_WRITE)) {
+        stats->bytes += this->transfer_seq.buf[1].len;
+      }
+      break;
+    case i2cTransferNack:
+      stats->nacks++;
+      break;
+    case i2cTransferArbLost:
+      stats->arbitration_lost++;
+      break;
+    case i2cTransferSwFault:
+      stats->timeouts++;
+      break;
+    default:
+      stats->bus_errors++;
+      break;
+  }
+  // Bucket n holds the latencies below 100 us * 2^n, the last one all the longer ones
+  uint32_t latency_us = micros() - this->transfer_start_us;
+  uint8_t bucket = 0u;
+  while (bucket < WIRE_LATENCY_BUCKET_COUNT - 1u && latency_us >= (100u << bucket)) {
+    bucket++;
+  }
+  stats->latency_histogram[bucket]++;
+}
+
+void TwoWire::irq_enable(bool enable)
+{
+  IRQn_Type irq = (IRQn_Type)0;
+  #if defined(I2C0)
+  if (this->i2c_peripheral == I2C0) {
+    irq = I2C0_IRQn;
+  }
+  #endif
+  #if defined(I2C1)
+  if (this->i2c_peripheral == I2C1) {
+    irq = I2C1_IRQn;
+  }
+  #endif
+  #if defined(I2C2)
+  if (this->i2c_peripheral == I2C2) {
+    irq = I2C2_IRQn;
+  }
+  #endif
+  if (enable) {
+    NVIC_ClearPendingIRQ(irq);
+    NVIC_EnableIRQ(irq);
+  } else {
+    NVIC_DisableIRQ(irq);
+  }
 }
 
 void TwoWire::_wire_irq_handler()
 {
+  if (this->role == wire_role_t::LEADER) {
+    this->leader_irq_handler();
+    return;
+  }
   if (this->role != wire_role_t::FOLLOWER) {
     return;
   }
+  if (this->register_map != nullptr) {
+    this->register_map_irq_handler();
+    return;
+  }
 
   uint32_t i2c_int_flags = this->i2c_peripheral->IF;
   uint32_t rx_data;
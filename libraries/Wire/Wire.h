@@ -38,11 +38,100 @@
 #include <cstring>
 #include "em_gpio.h"
 #include "sl_i2cspm.h"
+#include "sl_sleeptimer.h"
+#include "dmadrv.h"
 #include "arduino_i2c_config.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
 
+// Size of the internal transmit and receive buffers - 'setBufferSize()' can change it at runtime
+#ifndef WIRE_BUFFER_SIZE
+#define WIRE_BUFFER_SIZE 64u
+#endif // WIRE_BUFFER_SIZE
+
+// Transfers longer than this are moved by DMA - 'setDmaThreshold()' can change it at runtime
+#ifndef WIRE_DMA_THRESHOLD
+#define WIRE_DMA_THRESHOLD 16u
+#endif // WIRE_DMA_THRESHOLD
+
+// Number of followers with their own transfer statistics
+#ifndef WIRE_STATS_DEVICE_COUNT
+#define WIRE_STATS_DEVICE_COUNT 8u
+#endif // WIRE_STATS_DEVICE_COUNT
+
+// Number of buckets in the transfer latency histogram
+#define WIRE_LATENCY_BUCKET_COUNT 8u
+
 namespace arduino {
+enum wire_step_type_t {
+  WIRE_STEP_WRITE = 0,        // Writes 'tx_data' to the follower
+  WIRE_STEP_READ,             // Reads 'rx_size' bytes from the follower
+  WIRE_STEP_WRITE_READ,       // Writes 'tx_data', then reads after a repeated start
+  WIRE_STEP_DELAY             // Waits 'delay_us' microseconds before the next step
+};
+
+typedef struct {
+  wire_step_type_t type;
+  uint8_t address;            // Address of the follower
+  const uint8_t* tx_data;     // Data to be sent
+  size_t tx_size;             // Number of bytes to be sent
+  uint8_t* rx_data;           // Buffer for the received data
+  size_t rx_size;             // Number of bytes to be received
+  uint32_t delay_us;          // Length of a delay step in microseconds
+  volatile uint8_t status;    // WireStatus of the step - set by the driver
+} wire_step_t;
+
+enum wire_transaction_state_t {
+  WIRE_TRANSACTION_IDLE = 0,  // Not queued yet
+  WIRE_TRANSACTION_QUEUED,    // Waiting in the queue
+  WIRE_TRANSACTION_ACTIVE,    // The steps are running
+  WIRE_TRANSACTION_DONE,      // All the steps finished successfully
+  WIRE_TRANSACTION_FAILED     // At least one step failed - see the status of the steps
+};
+
+typedef struct wire_transaction {
+  wire_step_t* steps;         // The steps to be run back to back
+  size_t step_count;          // Number of the steps
+  void (*callback)(struct wire_transaction* transaction);   // Called from interrupt context when finished, can be nullptr
+  void* user_data;            // Not used by the driver - can be used to pass data to the callback
+  // Managed by the driver
+  volatile wire_transaction_state_t state;
+  size_t current_step;
+  struct wire_transaction* next;
+} wire_transaction_t;
+
+inline wire_step_t wire_step_write(uint8_t address, const uint8_t* tx_data, size_t tx_size)
+{
+  return { WIRE_STEP_WRITE, address, tx_data, tx_size, nullptr, 0u, 0u, 0u };
+}
+
+inline wire_step_t wire_step_read(uint8_t address, uint8_t* rx_data, size_t rx_size)
+{
+  return { WIRE_STEP_READ, address, nullptr, 0u, rx_data, rx_size, 0u, 0u };
+}
+
+inline wire_step_t wire_step_write_read(uint8_t address, const uint8_t* tx_data, size_t tx_size, uint8_t* rx_data, size_t rx_size)
+{
+  return { WIRE_STEP_WRITE_READ, address, tx_data, tx_size, rx_data, rx_size, 0u, 0u };
+}
+
+inline wire_step_t wire_step_delay(uint32_t delay_us)
+{
+  return { WIRE_STEP_DELAY, 0u, nullptr, 0u, nullptr, 0u, delay_us, 0u };
+}
+
+typedef struct {
+  uint8_t address;            // Address of the follower
+  uint32_t transactions;      // Number of finished transfers
+  uint32_t bytes;             // Number of data bytes in the successful transfers
+  uint32_t nacks;             // Transfers not acknowledged by the follower
+  uint32_t timeouts;          // Transfers aborted by the wire timeout
+  uint32_t bus_errors;        // Transfers which ended with a misplaced START or STOP
+  uint32_t arbitration_lost;  // Transfers lost to another leader
+  uint32_t retries;           // Transfers repeated after a bus error or lost arbitration
+  uint32_t latency_histogram[WIRE_LATENCY_BUCKET_COUNT];  // Bucket n counts transfers shorter than 100 us * 2^n, the last one all the longer ones
+} wire_device_stats_t;
+
 class TwoWire : public HardwareI2C
 {
 public:
@@ -77,6 +166,51 @@ public:
    ******************************************************************************/
   void begin(uint8_t follower_mode_address);
 
+  /***************************************************************************//**
+   * Starts the I2C peripheral in follower mode serving a register map
+   * The follower behaves like a typical sensor or EEPROM - the leader writes the
+   * register address first, then reads or writes the registers from there. The
+   * address auto-increments and wraps around at the end of the map. All the bytes
+   * are served directly from the I2C interrupt without involving the sketch - the
+   * onReceive / onRequest callbacks are not called. The register map memory has to
+   * stay valid until 'end()'.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] follower_mode_address I2C follower address to join the bus with
+   * @param[in] registers Pointer to the register map
+   * @param[in] size Size of the register map in bytes
+   * @param[in] register_address_size Size of the register address sent by the
+   *                                  leader in bytes (1 or 2) - big endian
+   *
+   * @return true if the follower was started, false if the parameters are invalid
+   *         or Wire is already running
+   ******************************************************************************/
+  bool beginRegisterMap(uint8_t follower_mode_address, volatile uint8_t* registers, size_t size, uint8_t register_address_size = 1);
+
+  /***************************************************************************//**
+   * Sets which registers of the register map the leader can write
+   * Writes outside of the range are acknowledged but ignored. The whole map is
+   * writable by default.
+   * Silabs specific, non-standard Arduino call.
+   * (follower mode only)
+   *
+   * @param[in] start The first writable register
+   * @param[in] count The number of writable registers, zero makes the map read-only
+   ******************************************************************************/
+  void setRegisterMapWritable(size_t start, size_t count);
+
+  /***************************************************************************//**
+   * Sets the function which should be called when the leader wrote registers
+   * Called from interrupt context at the end of each write transaction with the
+   * first written register and the number of written registers - the written range
+   * wraps around at the end of the register map.
+   * Silabs specific, non-standard Arduino call.
+   * (follower mode only)
+   *
+   * @param[in] callback Pointer to the register write callback function
+   ******************************************************************************/
+  void onRegisterWrite(void (*callback)(size_t start, size_t count));
+
   /***************************************************************************//**
    * Deinitializes the I2C peripheral
    ******************************************************************************/
@@ -85,6 +219,7 @@ public:
   /***************************************************************************//**
    * Requests bytes from an I2C follower
    * Discards any unread data from the receive buffer before reading.
+   * Nothing is read if more bytes are requested than the size of the receive buffer.
    * (leader mode only)
    *
    * @param[in] address The address of the I2C follower
@@ -108,6 +243,91 @@ public:
    ******************************************************************************/
   size_t requestFrom(uint8_t address, size_t number_of_bytes, bool stop);
 
+  /***************************************************************************//**
+   * Reads bytes from an I2C follower directly into the provided buffer
+   * The data is not copied through the receive buffer - so there's no limit on the
+   * length besides 65535 bytes and 'read()' / 'available()' are not affected.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] address The address of the I2C follower
+   * @param[out] buffer Buffer for the received data
+   * @param[in] size The number of bytes to be read
+   *
+   * @return Returns the number of bytes received
+   ******************************************************************************/
+  size_t requestFrom(uint8_t address, uint8_t* buffer, size_t size);
+
+  /***************************************************************************//**
+   * Writes a command (e.g. a register or memory address) to an I2C follower, then
+   * reads bytes directly into the provided buffer after a repeated start
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] address The address of the I2C follower
+   * @param[in] command The bytes to be written before the read
+   * @param[in] command_size The number of bytes to be written
+   * @param[out] buffer Buffer for the received data
+   * @param[in] size The number of bytes to be read
+   *
+   * @return Returns the number of bytes received
+   ******************************************************************************/
+  size_t requestFrom(uint8_t address, const uint8_t* command, size_t command_size, uint8_t* buffer, size_t size);
+
+  /***************************************************************************//**
+   * Writes bytes to an I2C follower directly from the provided buffer
+   * The data is not copied through the transmit buffer and no 'beginTransmission()'
+   * is needed. The length is only limited to 65535 bytes.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] address The address of the I2C follower
+   * @param[in] data The data to be sent
+   * @param[in] size The number of bytes to be sent
+   *
+   * @return Returns a WireStatus indicating the result of the operation
+   ******************************************************************************/
+  uint8_t writeTo(uint8_t address, const uint8_t* data, size_t size);
+
+  /***************************************************************************//**
+   * Writes a header (e.g. a memory address) and data to an I2C follower in one
+   * transfer directly from two separate buffers
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] address The address of the I2C follower
+   * @param[in] header The bytes to be sent first
+   * @param[in] header_size The number of header bytes
+   * @param[in] data The data to be sent after the header
+   * @param[in] size The number of data bytes
+   *
+   * @return Returns a WireStatus indicating the result of the operation
+   ******************************************************************************/
+  uint8_t writeTo(uint8_t address, const uint8_t* header, size_t header_size, const uint8_t* data, size_t size);
+
+  /***************************************************************************//**
+   * Sets the size of the transmit and receive buffers
+   * Limits how many bytes can be written between 'beginTransmission()' and
+   * 'endTransmission()' and how many can be requested with 'requestFrom()'.
+   * Has to be called before 'begin()'. The buffers are allocated on the heap, sizes up
+   * to 'WIRE_BUFFER_SIZE' use the internal buffers.
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @param[in] size the size of the buffers in bytes (1 - 'max_buffer_size')
+   *
+   * @return true if the buffer size was set, false if the size is invalid,
+   *         Wire is already running or the allocation failed
+   ******************************************************************************/
+  bool setBufferSize(size_t size);
+
+  /***************************************************************************//**
+   * Returns the size of the transmit and receive buffers
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @return the size of the buffers in bytes
+   ******************************************************************************/
+  size_t getBufferSize();
+
   /***************************************************************************//**
    * Starts an I2C transmission with a follower device
    * (leader mode only)
@@ -168,6 +388,31 @@ public:
    ******************************************************************************/
   int read();
 
+  /***************************************************************************//**
+   * Moves the received bytes to the provided buffer
+   * (leader/follower mode)
+   *
+   * @param[out] buffer Pointer to the destination buffer
+   * @param[in] size Size of the destination buffer
+   *
+   * @return Returns the number of bytes copied to the buffer
+   ******************************************************************************/
+  size_t read(uint8_t* buffer, size_t size);
+
+  /***************************************************************************//**
+   * Moves the received bytes to the provided buffer
+   * The received data is already complete when 'requestFrom()' returns, so unlike
+   * 'Stream::readBytes()' this does not wait for more data.
+   * (leader/follower mode)
+   *
+   * @param[out] buffer Pointer to the destination buffer
+   * @param[in] length Size of the destination buffer
+   *
+   * @return Returns the number of bytes copied to the buffer
+   ******************************************************************************/
+  size_t readBytes(uint8_t* buffer, size_t length) { return this->read(buffer, length); }
+  size_t readBytes(char* buffer, size_t length) { return this->read((uint8_t*)buffer, length); }
+
   /***************************************************************************//**
    * Returns the next byte from the receive buffer if available without removing it
    * (leader/follower mode)
@@ -179,12 +424,39 @@ public:
 
   /***************************************************************************//**
    * Sets the bus clock speed
+   * Standard mode (100 kHz), Fast mode (400 kHz) and Fast-mode Plus (1 MHz) are
+   * supported - the clock low/high ratio is selected for the speed. Fast-mode Plus
+   * needs stronger pull-ups and raises the slew rate of the GPIO ports of SDA and SCL,
+   * which affects every pin on those ports. The previous slew rate of the ports is
+   * restored when the clock is lowered again or on 'end()'.
+   * The actual clock can be lower than requested, followers may stretch the clock.
    * (leader/follower mode)
    *
    * @param[in] clock The requested bus clock speed in hertz
    ******************************************************************************/
   void setClock(const uint32_t clock);
 
+  /***************************************************************************//**
+   * Sets the length from which leader transfers use DMA
+   * Transfers up to this length are run byte by byte from the I2C interrupt, the
+   * data of longer ones is moved by DMA with only a few interrupts per transfer.
+   * Zero makes every transfer with data use DMA.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] max_interrupt_size The longest transfer run from the interrupt in bytes
+   ******************************************************************************/
+  void setDmaThreshold(size_t max_interrupt_size);
+
+  /***************************************************************************//**
+   * Returns the length from which leader transfers use DMA
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @return the longest transfer run from the interrupt in bytes
+   ******************************************************************************/
+  size_t getDmaThreshold();
+
   /***************************************************************************//**
    * Sets the function which should be called on reception
    * (leader/follower mode)
@@ -203,14 +475,18 @@ public:
 
   /***************************************************************************//**
    * Sets the timeout and whether a reset should occur on timeout
-   * Note: setting the timeout amount has no effect, only the timeout behaviour
-   * (leader/follower mode)
+   * The timeout is how long a transfer may stall - the time its bytes take on the
+   * bus at the set clock is added to it, so long transfers are not cut short.
+   * Stalled transfers are aborted with TIMEOUT. The reset releases a stuck bus by
+   * clocking out the follower and initializing the peripheral again.
+   * The default is 25 ms without reset.
+   * (leader mode only)
    *
-   * @param[in] timeout The requested timeout amount in microseconds
+   * @param[in] timeout The requested timeout amount in microseconds, zero to wait forever
    * @param[in] reset_on_timeout Indicates whether a communication reset
-   *                             should be performed on timeout
+   *                             should be performed on timeout or bus error
    ******************************************************************************/
-  void setWireTimeout(int timeout, bool reset_on_timeout);
+  void setWireTimeout(int timeout = 25000, bool reset_on_timeout = false);
 
   /***************************************************************************//**
    * Clears the communication timeout flag
@@ -226,10 +502,175 @@ public:
    ******************************************************************************/
   bool getWireTimeoutFlag();
 
+  /***************************************************************************//**
+   * Starts a leader transfer in the background and returns immediately
+   * Writes the provided bytes to the follower, then reads from it after a repeated
+   * start - either part can be empty. The transfer is run from the I2C interrupt,
+   * the buffers have to stay valid until it finishes.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] address The address of the I2C follower
+   * @param[in] tx_data The data to be sent, can be nullptr if 'tx_size' is zero
+   * @param[in] tx_size The number of bytes to be sent
+   * @param[out] rx_data Buffer for the received data, can be nullptr if 'rx_size' is zero
+   * @param[in] rx_size The number of bytes to be received
+   * @param[in] callback Called from interrupt context with the WireStatus of the
+   *                     finished transfer, can be nullptr
+   *
+   * @return true if the transfer was started, false if another one is in progress
+   ******************************************************************************/
+  bool transferAsync(uint8_t address,
+                     const uint8_t* tx_data,
+                     size_t tx_size,
+                     uint8_t* rx_data,
+                     size_t rx_size,
+                     void (*callback)(uint8_t status) = nullptr);
+
+  /***************************************************************************//**
+   * Waits for the background transfer to finish
+   * The task is blocked while waiting. A stalled transfer is aborted in the
+   * background when the wire timeout expires, see 'setWireTimeout()'.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @return Returns a WireStatus indicating the result of the transfer
+   ******************************************************************************/
+  uint8_t waitTransfer();
+
+  /***************************************************************************//**
+   * Checks whether a background transfer is in progress
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @return true if a transfer is in progress, false otherwise
+   ******************************************************************************/
+  bool isTransferInProgress();
+
+  /***************************************************************************//**
+   * Adds a transaction list to the queue and returns immediately
+   * The steps of the queued lists are run back to back from the I2C and sleeptimer
+   * interrupts - each one with its own follower address. Every step gets its own
+   * status and a failed step doesn't stop the following ones. A step stalling longer
+   * than the wire timeout is aborted with TIMEOUT. The transaction structure, the
+   * steps and their buffers have to stay valid until it's finished.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] transaction Pointer to the transaction list to be queued
+   *
+   * @return true if the transaction list was queued, false if the parameters are invalid
+   *         or the transaction list is already queued
+   ******************************************************************************/
+  bool queueTransaction(wire_transaction_t* transaction);
+
+  /***************************************************************************//**
+   * Waits for a queued transaction list to finish
+   * The task yields while waiting. Use a zero timeout to check the status only.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] transaction Pointer to the queued transaction list
+   * @param[in] timeout_ms Maximum time to wait in milliseconds
+   *
+   * @return true if all the steps finished successfully, false on timeout or failure
+   ******************************************************************************/
+  bool waitTransaction(wire_transaction_t* transaction, uint32_t timeout_ms = 0xFFFFFFFFu);
+
+  /***************************************************************************//**
+   * Releases a stuck bus
+   * The pins are taken over from the peripheral - SCL is toggled until a follower
+   * stuck in the middle of a byte releases SDA (up to nine clocks), then a STOP
+   * condition is sent and the peripheral is initialized again. Done automatically
+   * after a timeout or bus error if 'reset_on_timeout' is set with 'setWireTimeout()'.
+   * Refused while a transfer or a transaction list is in progress.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @return true if both SDA and SCL are released, false if a device still holds
+   *         the bus, a transfer is in progress or not in leader mode
+   ******************************************************************************/
+  bool recoverBus();
+
+  /***************************************************************************//**
+   * Returns how many times the bus was recovered
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @return the number of bus recoveries since the start or the last 'resetStats()'
+   ******************************************************************************/
+  uint32_t getBusRecoveryCount();
+
+  /***************************************************************************//**
+   * Finds the followers on the bus
+   * Each address is probed with an address-only write and counts as present if the
+   * follower acknowledges it. The probes don't show up in the statistics.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[out] addresses Array for the addresses of the found followers, can be
+   *                       nullptr if 'max_count' is zero
+   * @param[in] max_count The size of the array
+   * @param[in] first_address The first address to probe
+   * @param[in] last_address The last address to probe
+   *
+   * @return the number of followers found - can be more than 'max_count'
+   ******************************************************************************/
+  size_t scan(uint8_t* addresses, size_t max_count, uint8_t first_address = 0x08, uint8_t last_address = 0x77);
+
+  /***************************************************************************//**
+   * Sets how many times a blocking transfer is repeated after a bus error or lost
+   * arbitration - NACKs and timeouts are not repeated. The default is zero.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] retries The number of repetitions
+   ******************************************************************************/
+  void setRetryCount(uint8_t retries);
+
+  /***************************************************************************//**
+   * Gets the transfer statistics of a follower
+   * The statistics are collected for the first 'WIRE_STATS_DEVICE_COUNT' followers
+   * accessed by any of the leader transfers.
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] address The address of the follower
+   * @param[out] stats The statistics of the follower
+   *
+   * @return true if there are statistics for the follower, false otherwise
+   ******************************************************************************/
+  bool getDeviceStats(uint8_t address, wire_device_stats_t* stats);
+
+  /***************************************************************************//**
+   * Gets the transfer statistics of the followers one by one
+   * Silabs specific, non-standard Arduino call.
+   * (leader mode only)
+   *
+   * @param[in] index The index of the statistics entry (0 - 'getDeviceStatsCount()')
+   * @param[out] stats The statistics of the follower
+   *
+   * @return true if the entry exists, false otherwise
+   ******************************************************************************/
+  bool getDeviceStatsByIndex(size_t index, wire_device_stats_t* stats);
+
+  /***************************************************************************//**
+   * Returns the number of followers with transfer statistics
+   * Silabs specific, non-standard Arduino call.
+   *
+   * @return the number of followers with statistics
+   ******************************************************************************/
+  size_t getDeviceStatsCount();
+
+  /***************************************************************************//**
+   * Clears the transfer statistics and the bus recovery count
+   * Silabs specific, non-standard Arduino call.
+   ******************************************************************************/
+  void resetStats();
+
   /***************************************************************************//**
    * Interrupt handler for the I2C peripheral
    * Meant to be called by the I2C ISR and not externally by users.
-   * (follower mode only)
+   * (leader/follower mode)
    ******************************************************************************/
   void _wire_irq_handler();
 
@@ -266,7 +707,7 @@ private:
    * @param[in] resultLen The number of the bytes requested from the I2C follower
    * @param[in] i2c_address The address of the I2C follower to communicate with
    *
-   * @return Returns zero on OK, non-zero otherwise
+   * @return Returns a WireStatus - zero on OK, non-zero otherwise
    ******************************************************************************/
   int32_t i2c_leader_read(uint8_t *cmd, size_t cmdLen, uint8_t *result, size_t resultLen, uint16_t i2c_address);
 
@@ -279,17 +720,111 @@ private:
    * @param[in] dataLen The number of the bytes to be sent to the I2C follower
    * @param[in] i2c_address The address of the I2C follower to communicate with
    *
-   * @return Returns zero on OK, non-zero otherwise
+   * @return Returns a WireStatus - zero on OK, non-zero otherwise
    ******************************************************************************/
   int32_t i2c_leader_write(uint8_t *cmd, size_t cmdLen, uint8_t *data, size_t dataLen, uint16_t i2c_address);
 
+  uint8_t i2c_leader_transfer(uint16_t i2c_address, uint16_t flags, uint8_t* data0, size_t len0, uint8_t* data1, size_t len1);
+  bool start_transfer(uint16_t i2c_address, uint16_t flags, uint8_t* data0, size_t len0, uint8_t* data1, size_t len1, void (*callback)(uint8_t status));
+  void leader_irq_handler();
+  void finish_transfer(I2C_TransferReturn_TypeDef result);
+  void abort_transfer();
+  void recover_bus();
+  void irq_enable(bool enable);
+  I2C_TransferReturn_TypeDef begin_transfer(uint16_t i2c_address, uint16_t flags, uint8_t* data0, size_t len0, uint8_t* data1, size_t len1);
+  uint32_t transfer_timeout(size_t size);
+  bool transfer_timer_start(uint32_t timeout_us);
+  static void transfer_timer_callback(sl_sleeptimer_timer_handle_t* handle, void* data);
+
+  void job_start_next();
+  bool job_run_steps();
+  void job_complete();
+  void job_step_finished(uint8_t status);
+  void job_transfer_finished(I2C_TransferReturn_TypeDef result);
+  void jobs_cancel();
+
+  void dma_init();
+  void dma_deinit();
+  bool dma_transfer_init();
+  void dma_start_address(bool read);
+  uint8_t dma_add_data_descriptors(uint8_t index, uint8_t* data, size_t size, bool tx);
+  void dma_start_data_tx();
+  void dma_start_data_rx();
+  void dma_send_stop();
+  I2C_TransferReturn_TypeDef dma_irq_handler();
+  void transfer_stop_hw();
+  void set_fast_slewrate(bool enable);
+
+  void register_map_irq_handler();
+  void register_map_write_finished();
+
+  bool wait_scl_released();
+  wire_device_stats_t* stats_find(uint8_t address);
+  void stats_record(I2C_TransferReturn_TypeDef result);
+
   bool timeout_flag;
   bool reset_on_timeout;
-
-  static const uint32_t tx_buffer_size = 64u;
-  static const uint32_t rx_buffer_size = 64u;
-  uint8_t tx_buffer[tx_buffer_size];
-  uint8_t rx_buffer[rx_buffer_size];
+  uint32_t timeout_us;
+
+  // Leader transfer run from the I2C interrupt
+  I2C_TransferSeq_TypeDef transfer_seq;
+  volatile bool transfer_active;
+  volatile I2C_TransferReturn_TypeDef transfer_result;
+  void (*transfer_callback)(uint8_t status);
+  SemaphoreHandle_t transfer_done_sem;
+  StaticSemaphore_t transfer_done_sem_buf;
+  // Aborts stalled transfers and ends the delay steps of transaction lists
+  sl_sleeptimer_timer_handle_t transfer_timer;
+  uint32_t bus_clock;
+
+  // Transaction lists run from the I2C and sleeptimer interrupts
+  wire_transaction_t* volatile job_queue_head;
+  wire_transaction_t* job_queue_tail;
+  wire_transaction_t* volatile job_current;
+
+  // DMA transfers - the data is moved by a single descriptor chain per direction
+  enum dma_state_t {
+    DMA_IDLE,
+    DMA_ADDRESS_TX,
+    DMA_DATA_TX,
+    DMA_ADDRESS_RX,
+    DMA_DATA_RX,
+    DMA_STOP
+  };
+  static const uint8_t dma_descriptor_count = 8u;
+  unsigned int dma_channel;
+  bool dma_available;
+  size_t dma_threshold;
+  volatile dma_state_t dma_state;
+  I2C_TransferReturn_TypeDef dma_result;
+  LDMA_TransferCfg_t dma_tx_config;
+  LDMA_TransferCfg_t dma_rx_config;
+  LDMA_Descriptor_t dma_descriptors[dma_descriptor_count];
+  bool fast_slewrate_set;
+  uint32_t scl_port_slewrate;
+  uint32_t sda_port_slewrate;
+
+  // Bus health
+  static const uint32_t recovery_half_period_us = 5u;
+  static const uint32_t recovery_scl_timeout_us = 1000u;
+  wire_device_stats_t device_stats[WIRE_STATS_DEVICE_COUNT];
+  uint8_t device_stats_count;
+  volatile uint32_t bus_recovery_count;
+  uint8_t retry_count;
+  uint32_t transfer_start_us;
+  bool transfer_untracked;
+  bool scan_in_progress;
+
+  static const size_t default_buffer_size = WIRE_BUFFER_SIZE;
+  // A single I2C transfer is limited to 65535 bytes
+  static const size_t max_buffer_size = UINT16_MAX;
+  uint8_t tx_buffer_default[default_buffer_size];
+  uint8_t rx_buffer_default[default_buffer_size];
+  uint8_t* tx_buffer;
+  uint8_t* rx_buffer;
+  size_t tx_buffer_size;
+  size_t rx_buffer_size;
+  bool buffers_allocated;
 
   uint16_t follower_address;
   bool transmission_in_progress;
@@ -302,6 +837,18 @@ private:
   bool follower_transaction_in_progress;
   RingBufferN<64> follower_mode_rx_buffer;
 
+  // Register map follower served from the I2C interrupt
+  volatile uint8_t* register_map;
+  size_t register_map_size;
+  uint8_t register_address_size;
+  size_t register_writable_start;
+  size_t register_writable_count;
+  size_t register_pointer;
+  uint8_t register_address_bytes_received;
+  size_t register_write_start;
+  size_t register_write_count;
+  void (*register_write_cb)(size_t start, size_t count);
+
   void (*user_onreceive_cb)(int);
   void (*user_onrequest_cb)(void);
 
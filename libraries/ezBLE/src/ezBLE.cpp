@@ -196,12 +196,38 @@ size_t ezBLEclass::write(const uint8_t* data, size_t size)
 
 void ezBLEclass::printf(const char* fmt, ...)
 {
-  char message[this->printf_buffer_size];
+  // Format straight into the Tx buffer and send it in as few transfers as possible
+  printf_writer writer(*this);
   va_list args;
   va_start(args, fmt);
-  vsnprintf(message, sizeof(message), fmt, args);
+  silabs_vprintf(writer, fmt, args);
   va_end(args);
-  this->write((uint8_t*)message, strlen(message));
+  (void)this->transfer_outgoing_data();
+}
+
+size_t ezBLEclass::printf_writer::write(uint8_t data)
+{
+  return this->write(&data, 1);
+}
+
+size_t ezBLEclass::printf_writer::write(const uint8_t* data, size_t size)
+{
+  size_t stored = 0;
+  while (stored < size) {
+    xSemaphoreTake(this->ezble.tx_buf_mutex, portMAX_DELAY);
+    while (stored < size && !this->ezble.tx_buf.isFull()) {
+      this->ezble.tx_buf.store_char(data[stored]);
+      stored++;
+    }
+    xSemaphoreGive(this->ezble.tx_buf_mutex);
+
+    // If the buffer got full try to transmit the buffered data to free up space
+    if (stored < size && (int)this->ezble.transfer_outgoing_data() <= 0) {
+      this->ezble.ezble_log("Tx buffer overflow!");
+      break;
+    }
+  }
+  return stored;
 }
 
 void ezBLEclass::onReceive(void (*user_onreceive_callback)(int))
@@ -296,6 +322,51 @@ int ezBLEclass::read(void)
   return data;
 }
 
+size_t ezBLEclass::read(uint8_t* buffer, size_t size)
+{
+  if (buffer == nullptr) {
+    return 0u;
+  }
+  size_t count = 0u;
+  xSemaphoreTake(this->rx_buf_mutex, portMAX_DELAY);
+  while (count < size && this->rx_buf.available()) {
+    buffer[count++] = (uint8_t)this->rx_buf.read_char();
+  }
+  xSemaphoreGive(this->rx_buf_mutex);
+  return count;
+}
+
+size_t ezBLEclass::readBytes(char* buffer, size_t length)
+{
+  return this->readBytes((uint8_t*)buffer, length);
+}
+
+size_t ezBLEclass::readBytes(uint8_t* buffer, size_t length)
+{
+  if (buffer == nullptr) {
+    return 0u;
+  }
+  // Take everything from the buffer at once and only wait when it runs dry
+  size_t count = 0u;
+  unsigned long start_millis = millis();
+  while (count < length) {
+    size_t read = this->read(buffer + count, length - count);
+    count += read;
+    if (count >= length) {
+      break;
+    }
+    if (read == 0u) {
+      if (millis() - start_millis >= this->getTimeout()) {
+        break;
+      }
+      yield();
+    } else {
+      start_millis = millis();
+    }
+  }
+  return count;
+}
+
 int ezBLEclass::available()
 {
   return this->rx_buf.available();
@@ -667,13 +738,12 @@ void ezBLEclass::ezble_log(const char* fmt, ...)
 {
   #if (EZBLE_ENABLE_DEBUG_LOGGING) == 1
 
-  char message[this->printf_buffer_size];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(message, sizeof(message), fmt, args);
-  va_end(args);
   Serial.print("[ezBLE] ");
-  Serial.println(message);
+  silabs_vprintf(Serial, fmt, args);
+  Serial.println();
+  va_end(args);
 
   #else // EZBLE_ENABLE_DEBUG_LOGGING
 
@@ -79,6 +79,9 @@ public:
   virtual size_t write(uint8_t data);
   virtual size_t write(const uint8_t* data, size_t size);
   virtual int read();
+  size_t read(uint8_t* buffer, size_t size);
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length);
   virtual int available();
   virtual int peek();
 
@@ -124,6 +127,18 @@ private:
   void set_state(ezble_state_t state_new);
   void ezble_log(const char* fmt, ...);
 
+  // Collects the output of 'printf()' in the Tx buffer - the data is transferred once formatting has finished
+  class printf_writer : public Print {
+public:
+    printf_writer(ezBLEclass& ezble) : ezble(ezble)
+    {
+    }
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t size);
+private:
+    ezBLEclass& ezble;
+  };
+
   bool gattdb_initialized;
   uint8_t connection_handle;
   uint8_t advertising_set_handle;
@@ -142,7 +157,6 @@ private:
   void (*user_onconnect_callback)(void);
   void (*user_ondisconnect_callback)(void);
 
-  static const uint8_t printf_buffer_size = 64u;
   static const uint16_t max_ble_transfer_size = 250u;
   static const size_t data_buffer_size = 512u;
 
@@ -111,6 +111,33 @@ boards_with_dac = [
     ["lyra24p20", "ble_silabs"],
 ]
 
+boards_with_serial1 = [
+    ["nano_matter", "none"],
+    ["nano_matter", "ble_arduino"],
+    ["nano_matter", "ble_silabs"],
+    ["nano_matter", "matter"],
+    ["thingplusmatter", "none"],
+    ["thingplusmatter", "ble_arduino"],
+    ["thingplusmatter", "ble_silabs"],
+    ["thingplusmatter", "matter"],
+    ["xg24explorerkit", "none"],
+    ["xg24explorerkit", "ble_arduino"],
+    ["xg24explorerkit", "ble_silabs"],
+    ["xg24explorerkit", "matter"],
+    ["xg27devkit", "none"],
+    ["xg27devkit", "ble_arduino"],
+    ["xg27devkit", "ble_silabs"],
+    ["bgm220explorerkit", "none"],
+    ["bgm220explorerkit", "ble_silabs"],
+    ["lyra24p20", "none"],
+    ["lyra24p20", "ble_arduino"],
+    ["lyra24p20", "ble_silabs"],
+    ["xiao_mg24", "none"],
+    ["xiao_mg24", "ble_arduino"],
+    ["xiao_mg24", "ble_silabs"],
+    ["xiao_mg24", "matter"],
+]
+
 all_matter = [
     ["nano_matter", "matter"],
     ["thingplusmatter", "matter"],
@@ -160,6 +187,7 @@ testlist_quick = {
 
 testlist_common = {
     # Silicon Labs example library
+    "../../libraries/SiliconLabs/examples/adc_window_monitor/adc_window_monitor.ino":                                  all_variants,
     "../../libraries/SiliconLabs/examples/ble_blinky/ble_blinky.ino":                                                  all_ble_silabs,
     "../../libraries/SiliconLabs/examples/ble_health_thermometer/ble_health_thermometer.ino":                          all_ble_silabs,
     "../../libraries/SiliconLabs/examples/ble_health_thermometer_client/ble_health_thermometer_client.ino":            all_ble_silabs,
@@ -174,7 +202,18 @@ testlist_common = {
     "../../libraries/SiliconLabs/examples/ble_thingplus_battery_gauge/ble_thingplus_battery_gauge.ino":                thingplusmatter_ble_silabs,
     "../../libraries/SiliconLabs/examples/ble_xg27_devkit_sensors/ble_xg27_devkit_sensors.ino":                        (xg27devkit_ble_silabs, True),
     "../../libraries/SiliconLabs/examples/dac_sawtooth/dac_sawtooth.ino":                                              boards_with_dac,
+    "../../libraries/SiliconLabs/examples/dac_waveform_dma/dac_waveform_dma.ino":                                      boards_with_dac,
+    "../../libraries/SiliconLabs/examples/framed_transport_benchmark/framed_transport_benchmark.ino":                  boards_with_serial1,
     "../../libraries/SiliconLabs/examples/hwinfo/hwinfo.ino":                                                          all_variants,
+    "../../libraries/SiliconLabs/examples/i2c_bus_health/i2c_bus_health.ino":                                          all_variants,
+    "../../libraries/SiliconLabs/examples/i2c_register_follower/i2c_register_follower.ino":                            all_variants,
+    "../../libraries/SiliconLabs/examples/i2c_throughput_benchmark/i2c_throughput_benchmark.ino":                      all_variants,
+    "../../libraries/SiliconLabs/examples/i2c_transaction_list/i2c_transaction_list.ino":                              all_variants,
+    "../../libraries/SiliconLabs/examples/pwm_sequence_breathing/pwm_sequence_breathing.ino":                          all_variants,
+    "../../libraries/SiliconLabs/examples/pwm_smooth_fade/pwm_smooth_fade.ino":                                        all_variants,
+    "../../libraries/SiliconLabs/examples/serial_throughput_benchmark/serial_throughput_benchmark.ino":                boards_with_serial1,
+    "../../libraries/SiliconLabs/examples/spi_follower/spi_follower.ino":                                              all_variants,
+    "../../libraries/SiliconLabs/examples/spi_transfer_benchmark/spi_transfer_benchmark.ino":                          all_variants,
     "../../libraries/SiliconLabs/examples/xg27devkit_sensors/xg27devkit_sensors.ino":                                  (xg27devkit_ble_silabs, True),
     "../../libraries/SiliconLabs/examples/thingplusmatter_debug_unix/thingplusmatter_debug_unix.ino":                  all_ble_silabs,
     "../../libraries/SiliconLabs/examples/thingplusmatter_debug_win/thingplusmatter_debug_win.ino":                    all_ble_silabs,
@@ -194,6 +233,8 @@ testlist_common = {
     "../../libraries/OneWire/examples/DS2408_Switch/DS2408_Switch.ino":                                                all_variants,
     # Si7210Hall
     "../../libraries/Si7210_hall/examples/Si7210_hall_measure/Si7210_hall_measure.ino":                                all_variants,
+    # SpiNorFlash
+    "../../libraries/SpiNorFlash/examples/spi_nor_flash_benchmark/spi_nor_flash_benchmark.ino":                        all_variants,
     # SilabsMicrophoneAnalog
     "../../libraries/SilabsMicrophoneAnalog/examples/MicrophoneVolume/MicrophoneVolume.ino":                           all_variants,
     # SilabsMicrophonePDM
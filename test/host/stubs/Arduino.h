@@ -0,0 +1,23 @@
+// Host stand-in for the parts of the Arduino API used by the libraries under test
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t pin_size_t;
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(pin_size_t pin, int mode);
+void digitalWrite(pin_size_t pin, int value);
+
+#endif // HOST_ARDUINO_H
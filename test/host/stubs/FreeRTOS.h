@@ -0,0 +1,29 @@
+// Host stand-in for FreeRTOS - tasks run as threads, see freertos_host.cpp
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define portMAX_DELAY      0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define configASSERT(x)    assert(x)
+
+void host_critical_enter();
+void host_critical_exit();
+#define taskENTER_CRITICAL() host_critical_enter()
+#define taskEXIT_CRITICAL()  host_critical_exit()
+
+#endif // HOST_FREERTOS_H
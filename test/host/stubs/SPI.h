@@ -0,0 +1,34 @@
+// Host stand-in for the SPI library - only declares what the libraries under test reference,
+// the tests talk to mock buses instead
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock, uint8_t bit_order, uint8_t data_mode) : clock(clock), bit_order(bit_order), data_mode(data_mode)
+  {
+    ;
+  }
+
+private:
+  uint32_t clock;
+  uint8_t bit_order;
+  uint8_t data_mode;
+};
+
+class SilabsSPI {
+public:
+  void begin();
+  void beginTransaction(SPISettings settings);
+  void endTransaction();
+  void transfer(void* buf, size_t count, bool poll);
+  void receive(void* buf, size_t count, bool poll);
+};
+
+#endif // HOST_SPI_H
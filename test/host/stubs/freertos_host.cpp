@@ -0,0 +1,254 @@
+// Host implementation of the FreeRTOS and Arduino stand-ins
+// Tasks run as threads and critical sections take one global lock. Priorities are ignored,
+// so the tests can't depend on the scheduling order of the tasks.
+
+#include "Arduino.h"
+#include "SPI.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "queue.h"
+#include "task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::recursive_mutex critical_lock;
+static const auto start_time = std::chrono::steady_clock::now();
+
+struct host_semaphore {
+  std::mutex lock;
+  std::condition_variable changed;
+  bool available;
+};
+
+struct host_queue {
+  std::mutex lock;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t> > items;
+  size_t length;
+  size_t item_size;
+};
+
+struct host_task {
+  std::thread thread;
+  std::mutex lock;
+  std::condition_variable changed;
+  bool suspended;
+  bool deleted;
+};
+
+static thread_local host_task* current_task = nullptr;
+
+// Waits for 'condition' with the FreeRTOS timeout semantics - returns false on timeout
+template <typename Condition>
+static bool wait_for(std::condition_variable& changed, std::unique_lock<std::mutex>& lock, TickType_t ticks, Condition condition)
+{
+  if (ticks == portMAX_DELAY) {
+    changed.wait(lock, condition);
+    return true;
+  }
+  return changed.wait_for(lock, std::chrono::milliseconds(ticks), condition);
+}
+
+uint32_t millis()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void delay(uint32_t ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void pinMode(pin_size_t pin, int mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(pin_size_t pin, int value)
+{
+  (void)pin;
+  (void)value;
+}
+
+void SilabsSPI::begin()
+{
+  ;
+}
+
+void SilabsSPI::beginTransaction(SPISettings settings)
+{
+  (void)settings;
+}
+
+void SilabsSPI::endTransaction()
+{
+  ;
+}
+
+void SilabsSPI::transfer(void* buf, size_t count, bool poll)
+{
+  (void)buf;
+  (void)count;
+  (void)poll;
+}
+
+void SilabsSPI::receive(void* buf, size_t count, bool poll)
+{
+  memset(buf, 0xFF, count);
+  (void)poll;
+}
+
+void host_critical_enter()
+{
+  critical_lock.lock();
+}
+
+void host_critical_exit()
+{
+  critical_lock.unlock();
+}
+
+static SemaphoreHandle_t create_semaphore(StaticSemaphore_t* buffer, bool available)
+{
+  buffer->semaphore = new host_semaphore();
+  buffer->semaphore->available = available;
+  return buffer->semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer)
+{
+  return create_semaphore(buffer, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer)
+{
+  return create_semaphore(buffer, false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+  std::unique_lock<std::mutex> lock(semaphore->lock);
+  if (!wait_for(semaphore->changed, lock, ticks_to_wait, [semaphore] { return semaphore->available; })) {
+    return pdFALSE;
+  }
+  semaphore->available = false;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+  std::lock_guard<std::mutex> lock(semaphore->lock);
+  if (semaphore->available) {
+    return pdFALSE;
+  }
+  semaphore->available = true;
+  semaphore->changed.notify_all();
+  return pdTRUE;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t* storage, StaticQueue_t* buffer)
+{
+  (void)storage;
+  buffer->queue = new host_queue();
+  buffer->queue->length = length;
+  buffer->queue->item_size = item_size;
+  return buffer->queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+  std::unique_lock<std::mutex> lock(queue->lock);
+  if (!wait_for(queue->changed, lock, ticks_to_wait, [queue] { return queue->items.size() < queue->length; })) {
+    return pdFALSE;
+  }
+  const uint8_t* data = (const uint8_t*)item;
+  queue->items.emplace_back(data, data + queue->item_size);
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+  std::unique_lock<std::mutex> lock(queue->lock);
+  if (!wait_for(queue->changed, lock, ticks_to_wait, [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->item_size);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+  std::lock_guard<std::mutex> lock(queue->lock);
+  queue->items.clear();
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char* name, uint32_t stack_depth, void* param,
+                               UBaseType_t priority, StackType_t* stack, StaticTask_t* buffer)
+{
+  (void)name;
+  (void)stack_depth;
+  (void)priority;
+  (void)stack;
+  host_task* task = new host_task();
+  task->suspended = false;
+  task->deleted = false;
+  buffer->task = task;
+  task->thread = std::thread([task, function, param] {
+    current_task = task;
+    function(param);
+  });
+  return task;
+}
+
+void vTaskSuspend(TaskHandle_t task)
+{
+  // Only suspending the calling task is supported - it stays parked until it's deleted
+  assert(task == nullptr && current_task != nullptr);
+  task = current_task;
+  std::unique_lock<std::mutex> lock(task->lock);
+  task->suspended = true;
+  task->changed.notify_all();
+  task->changed.wait(lock, [task] { return task->deleted; });
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  assert(task != nullptr && task != current_task);
+  {
+    std::unique_lock<std::mutex> lock(task->lock);
+    // A task deleted in the middle of its work would never get here
+    bool parked = task->changed.wait_for(lock, std::chrono::seconds(1), [task] { return task->suspended; });
+    assert(parked);
+    (void)parked;
+    task->deleted = true;
+    task->changed.notify_all();
+  }
+  task->thread.join();
+  delete task;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  delay(ticks);
+}
+
+void taskYIELD()
+{
+  std::this_thread::yield();
+}
@@ -0,0 +1,17 @@
+#ifndef HOST_QUEUE_H
+#define HOST_QUEUE_H
+
+#include "FreeRTOS.h"
+
+struct host_queue;
+typedef host_queue* QueueHandle_t;
+typedef struct {
+  host_queue* queue;
+} StaticQueue_t;
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t* storage, StaticQueue_t* buffer);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+#endif // HOST_QUEUE_H
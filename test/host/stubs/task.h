@@ -0,0 +1,21 @@
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+struct host_task;
+typedef host_task* TaskHandle_t;
+typedef struct {
+  host_task* task;
+} StaticTask_t;
+typedef void (*TaskFunction_t)(void* param);
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char* name, uint32_t stack_depth, void* param,
+                               UBaseType_t priority, StackType_t* stack, StaticTask_t* buffer);
+// Deleting another task is only allowed while it's suspended - the threads can't be stopped anywhere else
+void vTaskDelete(TaskHandle_t task);
+void vTaskSuspend(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void taskYIELD();
+
+#endif // HOST_TASK_H
@@ -0,0 +1,54 @@
+# Little helper script to build and run the host tests of the libraries
+# The tests are built with the system compiler against the stand-ins in 'stubs' - no board or core installation is needed
+# Usage: python3 test_host.py [compiler]
+
+import os
+import subprocess
+import sys
+import tempfile
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+repo_dir = os.path.join(script_dir, "..", "..")
+
+# Test source: library sources it drives
+testlist = {
+    "testcases/test_spi_nor_flash.cpp": [
+        "libraries/SpiNorFlash/src/SpiNorFlash.cpp",
+        "libraries/SpiNorFlash/src/SpiNorFlashMock.cpp",
+    ],
+}
+
+
+def run_test(compiler, test, sources, build_dir):
+    include_dirs = [os.path.join(script_dir, "stubs")]
+    include_dirs += sorted({os.path.dirname(os.path.join(repo_dir, source)) for source in sources})
+    executable = os.path.join(build_dir, os.path.splitext(os.path.basename(test))[0])
+    command = [compiler, "-std=c++17", "-Wall", "-Wextra", "-g", "-pthread"]
+    command += ["-I" + include_dir for include_dir in include_dirs]
+    command += [os.path.join(script_dir, test), os.path.join(script_dir, "stubs", "freertos_host.cpp")]
+    command += [os.path.join(repo_dir, source) for source in sources]
+    command += ["-o", executable]
+    if subprocess.run(command).returncode != 0:
+        print(f"Build failed: {test}")
+        return False
+    if subprocess.run([executable]).returncode != 0:
+        print(f"Test failed: {test}")
+        return False
+    return True
+
+
+def main():
+    compiler = sys.argv[1] if len(sys.argv) > 1 else "g++"
+    failed = []
+    with tempfile.TemporaryDirectory() as build_dir:
+        for test, sources in testlist.items():
+            if not run_test(compiler, test, sources, build_dir):
+                failed.append(test)
+    print(f"{len(testlist) - len(failed)}/{len(testlist)} host tests passed")
+    for test in failed:
+        print(f" - {test}")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
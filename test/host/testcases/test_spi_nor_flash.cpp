@@ -0,0 +1,180 @@
+// Host test of the SpiNorFlash driver running on top of the SpiNorFlashMock memory
+// Covers the page splitting of programs, erases, the read cache and stopping and restarting the background task.
+
+#include "SpiNorFlash.h"
+#include <stdio.h>
+
+static uint32_t failed_checks = 0u;
+
+#define CHECK(condition)                                                    \
+  do {                                                                      \
+    if (!(condition)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);         \
+      failed_checks++;                                                      \
+    }                                                                       \
+  } while (0)
+
+static const size_t mock_size = 65536u;
+static uint8_t mock_storage[mock_size];
+static uint8_t pattern[1024];
+static uint8_t buffer[1024];
+
+static bool is_erased(const uint8_t* data, size_t size)
+{
+  for (size_t i = 0u; i < size; i++) {
+    if (data[i] != 0xFFu) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_probe(SpiNorFlash& flash)
+{
+  CHECK(flash.getJedecId() == 0xEF4010u);
+  CHECK(flash.getCapacity() == mock_size);
+}
+
+static void test_program_across_pages(SpiNorFlash& flash, SpiNorFlashMock& mock)
+{
+  // Starts in the middle of a page and spans five pages
+  const uint32_t address = 0x1000u + 200u;
+  CHECK(flash.program(address, pattern, sizeof(pattern)));
+  CHECK(flash.waitIdle(1000u));
+  CHECK(!flash.isBusy());
+  CHECK(memcmp(mock_storage + address, pattern, sizeof(pattern)) == 0);
+  CHECK(is_erased(mock_storage + 0x1000u, 200u));
+  memset(buffer, 0, sizeof(buffer));
+  CHECK(flash.read(address, buffer, sizeof(buffer)));
+  CHECK(memcmp(buffer, pattern, sizeof(buffer)) == 0);
+  CHECK(mock.getRejectedCommandCount() == 0u);
+  CHECK(flash.getFailedOperationCount() == 0u);
+}
+
+static void test_program_clears_bits(SpiNorFlash& flash)
+{
+  const uint32_t address = 0x3000u;
+  const uint8_t first = 0xF0u;
+  const uint8_t second = 0x3Cu;
+  CHECK(flash.program(address, &first, 1u));
+  CHECK(flash.program(address, &second, 1u));
+  uint8_t value = 0u;
+  CHECK(flash.read(address, &value, 1u));
+  CHECK(value == (first & second));
+}
+
+static void test_erase_sector(SpiNorFlash& flash)
+{
+  const uint8_t data[4] = { 0x11u, 0x22u, 0x33u, 0x44u };
+  CHECK(flash.program(0x4000u, data, sizeof(data)));
+  CHECK(flash.program(0x5000u, data, sizeof(data)));
+  // Any address within the sector erases the whole sector
+  CHECK(flash.eraseSector(0x4FFFu));
+  CHECK(flash.waitIdle(1000u));
+  CHECK(is_erased(mock_storage + 0x4000u, SPI_NOR_FLASH_SECTOR_SIZE));
+  CHECK(memcmp(mock_storage + 0x5000u, data, sizeof(data)) == 0);
+}
+
+static void test_read_cache(SpiNorFlash& flash)
+{
+  const uint32_t address = 0x6000u;
+  CHECK(flash.eraseSector(address));
+  uint8_t value = 0u;
+  CHECK(flash.read(address, &value, 1u));
+  uint32_t hits = flash.getCacheHitCount();
+  uint32_t misses = flash.getCacheMissCount();
+  CHECK(flash.read(address + 1u, &value, 1u));
+  CHECK(flash.getCacheHitCount() == hits + 1u);
+  CHECK(flash.getCacheMissCount() == misses);
+
+  // Programming has to invalidate the cached line
+  const uint8_t data = 0x5Au;
+  CHECK(flash.program(address + 1u, &data, 1u));
+  CHECK(flash.read(address + 1u, &value, 1u));
+  CHECK(value == data);
+
+  // A read spanning two lines loads both
+  misses = flash.getCacheMissCount();
+  uint8_t span[8];
+  CHECK(flash.read(address + 0x100u + SPI_NOR_FLASH_CACHE_LINE_SIZE - 4u, span, sizeof(span)));
+  CHECK(flash.getCacheMissCount() == misses + 2u);
+
+  // Reads longer than a line bypass the cache
+  hits = flash.getCacheHitCount();
+  misses = flash.getCacheMissCount();
+  CHECK(flash.read(address, buffer, SPI_NOR_FLASH_CACHE_LINE_SIZE + 1u));
+  CHECK(flash.getCacheHitCount() == hits);
+  CHECK(flash.getCacheMissCount() == misses);
+}
+
+static void test_range_checks(SpiNorFlash& flash)
+{
+  CHECK(!flash.read(mock_size, buffer, 1u));
+  CHECK(!flash.read(mock_size - 1u, buffer, 2u));
+  CHECK(!flash.program(mock_size - 1u, pattern, 2u));
+  CHECK(!flash.eraseSector(mock_size));
+  CHECK(flash.read(mock_size - 1u, buffer, 1u));
+}
+
+static void test_erase_chip(SpiNorFlash& flash)
+{
+  // The busy flag of a chip erase is polled every 100 ms
+  CHECK(flash.eraseChip());
+  CHECK(flash.waitIdle(5000u));
+  CHECK(is_erased(mock_storage, mock_size));
+  CHECK(flash.read(0x1000u, buffer, sizeof(buffer)));
+  CHECK(is_erased(buffer, sizeof(buffer)));
+}
+
+static void test_end_restart(SpiNorFlash& flash, SpiNorFlashMock& mock)
+{
+  // 'end()' has to finish the queued operations before the task is stopped
+  const uint32_t address = 0x8000u;
+  CHECK(flash.eraseSector(address));
+  CHECK(flash.program(address, pattern, sizeof(pattern)));
+  flash.end();
+  CHECK(!flash.isBusy());
+  CHECK(memcmp(mock_storage + address, pattern, sizeof(pattern)) == 0);
+  CHECK(!flash.program(address, pattern, 1u));
+  CHECK(!flash.read(address, buffer, 1u));
+
+  // The task is created again in the same static buffers - the mock erases its array on begin
+  CHECK(flash.begin());
+  CHECK(is_erased(mock_storage, mock_size));
+  CHECK(flash.program(address, pattern, sizeof(pattern)));
+  CHECK(flash.read(address, buffer, sizeof(buffer)));
+  CHECK(memcmp(buffer, pattern, sizeof(buffer)) == 0);
+  CHECK(mock.getRejectedCommandCount() == 0u);
+  flash.end();
+  flash.end();
+}
+
+int main()
+{
+  for (size_t i = 0u; i < sizeof(pattern); i++) {
+    pattern[i] = (uint8_t)(i * 7u + 3u);
+  }
+
+  SpiNorFlashMock mock(mock_storage, mock_size);
+  // Several busy status reads after each write so the driver has to poll
+  mock.setBusyPolls(3u, 20u);
+  SpiNorFlash flash(mock);
+  CHECK(flash.begin());
+
+  test_probe(flash);
+  test_program_across_pages(flash, mock);
+  test_program_clears_bits(flash);
+  test_erase_sector(flash);
+  test_read_cache(flash);
+  test_range_checks(flash);
+  test_erase_chip(flash);
+  test_end_restart(flash, mock);
+
+  CHECK(flash.getFailedOperationCount() == 0u);
+  if (failed_checks > 0u) {
+    printf("test_spi_nor_flash: %u checks failed\n", (unsigned)failed_checks);
+    return 1;
+  }
+  printf("test_spi_nor_flash: passed\n");
+  return 0;
+}
@@ -39,6 +39,14 @@ extern "C" {
 
 #define SL_SERIAL_PERIPHERAL SL_IOSTREAM_EUSART_VCOM_PERIPHERAL
 
+// Hardware flow control pins of Serial
+#if defined(SL_IOSTREAM_EUSART_VCOM_CTS_PORT) && defined(SL_IOSTREAM_EUSART_VCOM_RTS_PORT)
+#define SL_SERIAL_CTS_PORT SL_IOSTREAM_EUSART_VCOM_CTS_PORT
+#define SL_SERIAL_CTS_PIN SL_IOSTREAM_EUSART_VCOM_CTS_PIN
+#define SL_SERIAL_RTS_PORT SL_IOSTREAM_EUSART_VCOM_RTS_PORT
+#define SL_SERIAL_RTS_PIN SL_IOSTREAM_EUSART_VCOM_RTS_PIN
+#endif
+
 extern sl_iostream_t* sl_serial_stream_handle;
 extern sl_iostream_uart_t* sl_serial_instance_handle;
 void sl_serial_set_baud_rate(uint32_t baudrate);